@@ -0,0 +1,80 @@
+#ifndef _ASSETPACK_H
+#define _ASSETPACK_H
+
+#include<_common.h>
+#include<_textureloader.h>
+#include<stdint.h>
+
+#define PACK_MAGIC 0x4B504141   // "AAPK"
+#define PACK_VERSION 1
+#define PACK_ALIGN 256          // every blob starts on this, so levels can be read or copied from the mapping as they are
+#define PACK_NAME 96
+#define PACK_LEVELS 16
+
+// Everything the game loads at startup baked into one file by assetbake -pack:
+// each image already decoded, converted to the format the game asks for and
+// mipmapped (a baked .dds keeps its blocks), its sprite trim next to it, and the
+// text files (font tables, level map) as they are. The header points at an index
+// at the end of the file. At runtime the whole file is mapped once and textures
+// are uploaded straight from the mapping, so nothing is decompressed or opened
+// per asset. The pack isn't checked against the images; rebake after changing one.
+struct packHeader
+{
+    uint32_t magic, version;
+    uint32_t count;             // index entries
+    uint32_t pad;
+    uint64_t indexOffset;       // from the file start
+};
+
+struct packEntry
+{
+    char name[PACK_NAME];       // _textureRegistry::normalize'd path
+    uint32_t kind;              // _assetPack::TEXTURE or RAW
+    int32_t requested;          // what the game asks for, entries only match the same request
+    int32_t mipmaps;
+    int32_t framesX, framesY;   // trim grid, 0 without a trim
+    int32_t format;             // what the levels hold, TEX_*
+    int32_t width, height, levels;
+    int64_t rgbaBytes;
+    uint64_t offset, size;      // blob, from the file start
+    uint64_t levelOffset[PACK_LEVELS]; // from the blob start
+    uint64_t levelSize[PACK_LEVELS];
+    int32_t levelW[PACK_LEVELS], levelH[PACK_LEVELS];
+    uint64_t paletteOffset;     // 256 rgba entries, from the file start, 0 without
+    uint64_t trimOffset;        // framesX*framesY trimRects, from the file start, 0 without
+    double fullArea, trimmedArea;
+};
+
+class _assetPack
+{
+    public:
+        _assetPack();
+        virtual ~_assetPack();
+
+        enum {TEXTURE, RAW};
+
+        const unsigned char *base;  // the mapping, null when no pack is open
+        uint64_t size;
+        uint32_t count;
+        const packEntry *entries;
+
+        bool open(const char *);    // maps the file, false if it's missing or not a pack of this version
+        void close();
+
+        // file, requested format, mipmaps, trim (its grid has to match, filled from the pack);
+        // null for an entry whose blob, levels, palette or trim reach past the mapping
+        const packEntry *find(const char *, int, bool, const _spriteTrim *);
+        // level table of a texture entry into packed (no data copied), base set to the levels in the mapping;
+        // false when there's no entry or the driver can't take its format
+        bool texture(const char *, int, bool, _spriteTrim *, packedTexture &, const unsigned char *&);
+        bool file(const char *, const char *&, size_t &); // bytes of a RAW entry
+
+    protected:
+
+    private:
+        HANDLE fileHandle, mapping;
+
+        bool valid(const packEntry &); // every range in the entry inside the mapping
+};
+
+#endif // _ASSETPACK_H
@@ -0,0 +1,53 @@
+#ifndef _ASSETVARIANTS_H
+#define _ASSETVARIANTS_H
+
+#include<_common.h>
+#include<_textureloader.h>
+#include<_uploadqueue.h>
+#include<vector>
+#include<string>
+#include<map>
+
+// Scaled copies of an image listed in a manifest next to it (images/help.variants,
+// written by assetbake -variants). One "width height file" line per copy, the
+// source image included, files relative to the manifest.
+struct textureVariant
+{
+    int width, height;
+    std::string path;
+};
+
+class _assetVariants
+{
+    public:
+        _assetVariants(_uploadQueue *);
+        virtual ~_assetVariants();
+
+        std::string pick(const char *, int, int);  // source image, target size -> smallest variant covering it
+        void load(const char *, int, int, GLuint *, int); // source, target size, texture set once uploaded, upload format
+        void track(const char *, const std::string &, GLuint *, int); // source, variant loaded now, texture, upload format
+        void resize(int, int);                     // swap tracked textures whose best variant changed
+
+        int swaps;                                 // variant swaps uploaded so far
+
+    protected:
+
+    private:
+        struct tracked
+        {
+            std::string source;
+            std::string current; // variant the texture holds or is being swapped to
+            GLuint *tex;
+            int format;
+            int generation;      // bumped per queued swap, stale uploads are dropped
+        };
+
+        _uploadQueue *uploads;
+        std::vector<tracked *> textures;
+        std::map<std::string, std::vector<textureVariant> > manifests; // source image -> variants, read once
+
+        const std::vector<textureVariant> &variants(const char *);
+        void swap(tracked *);                      // upload t->current, replace the texture when it lands
+};
+
+#endif // _ASSETVARIANTS_H
@@ -3,6 +3,8 @@
 
 #include<_bullets.h>
 #include<_timer.h>
+#include<_streambuffer.h>
+#include<_scenegraph.h>
 #include<_textureloader.h>
 
 class _bullets
@@ -24,6 +26,10 @@ class _bullets
         int actionTrigger;
         int t=0; //
         float xMin,xMax,yMin,yMax;
+        _spriteTrim *trim = nullptr; // visible bounds of the image, owned by the scene
+        _streamBuffer *stream = nullptr; // where the quad's vertices go, set by the scene before drawing
+        _sceneGraph *graph = nullptr;    // cached world matrix, the scene keeps node in sync with bPos/bRot/bScale
+        int node = -1;
 
         void bInit(vec3);
         void bReset(vec3);
@@ -0,0 +1,65 @@
+#ifndef _CAPTURE_H
+#define _CAPTURE_H
+
+#include<_common.h>
+#include<_glext.h>
+#include<_glcaps.h>
+#include<_jobqueue.h>
+#include<string>
+
+#define CAPTURE_SLOTS 4 // frames read back but not yet written
+#define CAPTURE_DELAY 2 // frames between the read and the map when there are no fences
+
+// Screenshots and continuous capture of the back buffer. glReadPixels goes
+// into a ring of pixel pack buffers, each one is mapped a frame or more later
+// when its fence has passed, and a worker writes the mapped bgra rows out as
+// an uncompressed tga (same byte order and row order as gl, so no conversion).
+// The buffer is unmapped back on the main thread once the file is written.
+class _capture
+{
+    public:
+        _capture(_jobQueue *);
+        virtual ~_capture();
+
+        bool recording;
+        long long frames;   // frames handed to the worker this take
+        long long dropped;  // frames skipped because every slot was still busy
+        double renderMs;    // time spent in frame() this take
+
+        void initCapture();         // after _glCaps::probe
+        void screenshot();          // next frame goes to screenshot_NNN.tga
+        void toggleRecording();     // every frame goes to capture_NNN_NNNNN.tga
+        void frame(int, int);       // end of frame, before the swap: window size
+
+        static bool writeTGA(const std::string &, int, int, const unsigned char *); // bgra, bottom row first
+
+    protected:
+
+    private:
+        enum {FREE, READING, WRITING};
+
+        struct slot
+        {
+            GLuint pbo;
+            GLsync fence;
+            int state;
+            int width, height;
+            long sequence;          // issue order, slots are handed over oldest first
+            long issuedFrame;
+            std::string fileName;
+        };
+
+        _jobQueue *jobs;
+        slot slots[CAPTURE_SLOTS];
+        long frameCount;
+        long sequence;
+        int shots, take;
+        bool shotPending;
+
+        void collect();                       // hand finished reads to the worker
+        bool issue(int, int, const std::string &); // read the back buffer into a free slot, false if none is free
+        void release(slot *);                 // main thread, after the file is written
+
+};
+
+#endif // _CAPTURE_H
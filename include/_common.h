@@ -8,6 +8,7 @@
 #include<time.h>
 #include<math.h>
 #include<time.h>
+#include<_gltrace.h> // gl calls go through the trace, it costs a flag test unless -gltrace is on
 
 #define PI 3.14159
 #define GRAVITY 9.81
@@ -0,0 +1,40 @@
+#ifndef _DXT_H
+#define _DXT_H
+
+#include<vector>
+#include<stddef.h>
+
+// Block compressed textures (S3TC BC1/BC3, BPTC BC7) stored as .dds files.
+// Shared by the game loader and the offline assetbake tool, so no GL in here.
+class _dxt
+{
+    public:
+        enum {NONE, BC1, BC3, BC7};
+
+        struct level
+        {
+            int width, height;
+            size_t offset, size; // into data
+        };
+
+        struct image
+        {
+            int format;
+            int width, height;
+            std::vector<level> levels;       // mip 0 first
+            std::vector<unsigned char> data; // every level's blocks back to back
+        };
+
+        static size_t levelSize(int, int, int); // format, width, height
+        static bool loadDDS(const char *, image &);
+        static bool saveDDS(const char *, const image &);
+
+        // rgba in, blocks out (4x4 texels per block, edges are clamped)
+        static void encodeBC1(const unsigned char *, int, int, unsigned char *);
+        static void encodeBC3(const unsigned char *, int, int, unsigned char *);
+
+        // blocks of one level back to rgba, BC7 has no software decoder and returns false
+        static bool decode(const image &, int, unsigned char *);
+};
+
+#endif // _DXT_H
@@ -0,0 +1,43 @@
+#ifndef _DYNRES_H
+#define _DYNRES_H
+
+#include<_common.h>
+#include<_glext.h>
+
+// Renders the game scene into an offscreen target whose size follows the
+// measured render work per frame, then stretches it over the window.
+class _dynRes
+{
+    public:
+        _dynRes();
+        virtual ~_dynRes();
+
+        bool enabled;        // false renders straight to the window
+        float scale;         // fraction of the window size being rendered
+        float minScale, maxScale, step;
+        double budgetMs;     // render work per frame we try to stay under
+        double avgMs;        // smoothed work time
+
+        int texW, texH;      // allocated target size (the window size)
+        int rtW, rtH;        // part of the target in use this frame
+
+        GLuint fbo, colorTex, depthRb;
+
+        void frameTime(double);     // feed the last frame's work (cpu to the swap, or gpu), adjusts scale
+        bool begin(int, int);       // window size, binds the target if possible and scissors to the part in use
+        void end(int, int);         // back to the window, scissor state as begin() found it
+        void present(int, int);     // upscaled quad over the window, call in ortho
+
+    protected:
+
+    private:
+        double lastChange;          // time of the last scale change, stops it hunting
+        bool active;                // begin() bound the target
+        GLboolean scissorWas;       // scissor test and box before begin()
+        GLint scissorBox[4];
+
+        bool allocTarget(int, int);
+        void freeTarget();
+};
+
+#endif // _DYNRES_H
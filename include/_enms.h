@@ -2,8 +2,10 @@
 #define _ENMS_H
 
 #include<_common.h>
-#include<_textureloader.h>
+#include<_textureregistry.h>
 #include<_timer.h>
+#include<_streambuffer.h>
+#include<_scenegraph.h>
 
 class _enms
 {
@@ -12,7 +14,7 @@ class _enms
         virtual ~_enms();
 
         _timer *myTimer = new _timer();
-        _textureLoader *myTex = new _textureLoader();
+        GLuint tex = 0;  // from initEnms, shared through the registry
         float xMax, xMin, yMax, yMin;
         float speed;
 
@@ -22,6 +24,10 @@ class _enms
         vec3 rot; // for rotations
         int frames;
         int actionTrigger;
+        _spriteTrim *trim = nullptr; // visible bounds per frame, owned by the scene
+        _streamBuffer *stream = nullptr; // where the quad's vertices go, set by the scene before drawing
+        _sceneGraph *graph = nullptr;    // cached world matrix, the scene keeps node in sync with pos/rot/scale
+        int node = -1;
 
         enum{STAND,LEFTWALK,RIGHTWALK,ROTATELEFT, ROTATERIGHT};
 
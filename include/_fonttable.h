@@ -0,0 +1,66 @@
+#ifndef _FONTTABLE_H
+#define _FONTTABLE_H
+
+#include<_common.h>
+#include<stdint.h>
+#include<istream>
+#include<string>
+
+#define FONT_GLYPHS 256         // one slot per 8 bit character code
+#define FONTB_MAGIC 0x42544E46  // "FNTB"
+#define FONTB_VERSION 1
+
+// Structure to hold character data from .fnt file
+struct CharData {
+    int id = 0;
+    float x = 0, y = 0;
+    float width = 0, height = 0;
+    float xoffset = 0, yoffset = 0;
+    float xadvance = 0;
+    // Add page, chnl if needed
+};
+
+// what a compiled .fntb starts with, the glyph array follows exactly as it sits in _fontTable
+struct fontBinHeader
+{
+    uint32_t magic, version;
+    uint32_t glyphs;            // FONT_GLYPHS, and sizeof(CharData) must match too
+    uint32_t glyphSize;
+    int32_t count;
+    float lineHeight, base, scaleW, scaleH;
+    uint32_t pad;
+    uint64_t sourceSize, sourceTime; // the .fnt it was compiled from
+};
+
+// A bmfont glyph table as a flat array indexed by character code. The text
+// .fnt is parsed only when there is no compiled .fntb next to it, or the one
+// there was compiled from a different .fnt (size or write time changed); the
+// parse then writes a new .fntb, so later starts load the table with a
+// single read. assetbake -font compiles them ahead of time.
+class _fontTable
+{
+    public:
+        _fontTable();
+        virtual ~_fontTable();
+
+        CharData glyphs[FONT_GLYPHS]; // id 0 where the font has no glyph
+        int count;
+        float lineHeight, base, scaleW, scaleH;
+
+        const CharData *glyph(unsigned char) const; // null when the font doesn't have it
+        bool load(const char *);      // .fnt path, the .fntb next to it is read or (re)written; false if neither can be read
+        bool parse(std::istream &);   // bmfont text format, the slow path; false when glyphs or the texture size are missing
+        bool fromBinary(const void *, size_t, uint64_t, uint64_t); // .fntb bytes, the source's size and time it must match (0, 0 takes any)
+        bool readBinary(const char *, uint64_t, uint64_t);
+        bool writeBinary(const char *, uint64_t, uint64_t) const;
+
+        static bool sourceStamp(const char *, uint64_t &, uint64_t &); // size and write time, without opening the file
+        static std::string binaryName(const char *); // images/x.fnt -> images/x.fntb
+
+    protected:
+
+    private:
+        void clear();
+};
+
+#endif // _FONTTABLE_H
@@ -0,0 +1,53 @@
+#ifndef _GLCAPS_H
+#define _GLCAPS_H
+
+#include<_common.h>
+#include<_glext.h>
+
+// Which implementation each renderer feature uses on this context. probe()
+// picks the first supported path from each feature's preference list, the
+// last entry of every list is plain GL 1.1 so there is always a fallback.
+class _glCaps
+{
+    public:
+        enum feature {SPRITES, TEXT, PARTICLES, TEXTURES, OFFSCREEN, GPU_TIMING, CAPTURE, TILES, UPLOADS, FEATURE_COUNT};
+
+        enum path
+        {
+            PATH_IMMEDIATE,      // glBegin/glEnd
+            PATH_CLIENT_ARRAYS,  // vertex arrays from client memory, 1.1
+            PATH_VBO,            // buffer object refilled each frame
+            PATH_PERSISTENT,     // persistently mapped ring buffer with fences
+            PATH_UNCOMPRESSED,   // textures as 8 bit texels
+            PATH_S3TC,           // bc1/bc3 blocks
+            PATH_BPTC,           // bc7 blocks on top of s3tc
+            PATH_NATIVE,         // straight into the window, no offscreen target
+            PATH_FBO,            // framebuffer object
+            PATH_NONE,           // feature not available at all
+            PATH_ELAPSED,        // GL_TIME_ELAPSED queries
+            PATH_TIMESTAMP,      // glQueryCounter timestamps
+            PATH_READBACK,       // glReadPixels straight into client memory, stalls
+            PATH_PBO,            // glReadPixels into pixel buffers, mapped frames later
+            PATH_DISPLAY_LIST,   // geometry compiled once into a display list, 1.1
+            PATH_CLIENT_MEMORY,  // glTexImage2D straight from client memory, the driver copies before returning
+            PATH_COUNT
+        };
+
+        static const char *featureNames[FEATURE_COUNT];
+        static const char *pathNames[PATH_COUNT];
+
+        static int paths[FEATURE_COUNT];   // what each feature runs on right now
+
+        static void probe();                // after _glext::init, fills paths and logs them
+        static bool supported(int);         // can this context run the path at all
+        static bool force(int, int);        // feature, path, for benchmarks; false if unsupported
+        static int next(int);               // next supported path of a feature, wraps around
+        static const char *pathName(int);   // name of the feature's current path
+        static void log();
+
+    protected:
+
+    private:
+};
+
+#endif // _GLCAPS_H
@@ -0,0 +1,89 @@
+#ifndef _GLEXT_H
+#define _GLEXT_H
+
+#include<_common.h>
+#include<GL/glext.h>
+
+// opengl32.lib only exports GL 1.1, everything newer has to be fetched
+// from the driver with wglGetProcAddress once a context is current.
+class _glext
+{
+    public:
+        static bool init();                     // call after wglMakeCurrent
+        static bool hasExtension(const char *); // exact token match in GL_EXTENSIONS
+
+        static int major, minor;                // context version
+
+        // framebuffer objects (ARB or EXT, same enums and signatures)
+        static bool hasFBO;
+        static PFNGLGENFRAMEBUFFERSEXTPROC        GenFramebuffers;
+        static PFNGLDELETEFRAMEBUFFERSEXTPROC     DeleteFramebuffers;
+        static PFNGLBINDFRAMEBUFFEREXTPROC        BindFramebuffer;
+        static PFNGLFRAMEBUFFERTEXTURE2DEXTPROC   FramebufferTexture2D;
+        static PFNGLGENRENDERBUFFERSEXTPROC       GenRenderbuffers;
+        static PFNGLDELETERENDERBUFFERSEXTPROC    DeleteRenderbuffers;
+        static PFNGLBINDRENDERBUFFEREXTPROC       BindRenderbuffer;
+        static PFNGLRENDERBUFFERSTORAGEEXTPROC    RenderbufferStorage;
+        static PFNGLFRAMEBUFFERRENDERBUFFEREXTPROC FramebufferRenderbuffer;
+        static PFNGLCHECKFRAMEBUFFERSTATUSEXTPROC CheckFramebufferStatus;
+
+        // timer queries, timestamps need ARB_timer_query, EXT_timer_query only has elapsed time
+        static bool hasTimeElapsed;
+        static bool hasTimestamp;
+        static PFNGLGENQUERIESPROC              GenQueries;
+        static PFNGLDELETEQUERIESPROC           DeleteQueries;
+        static PFNGLBEGINQUERYPROC              BeginQuery;
+        static PFNGLENDQUERYPROC                EndQuery;
+        static PFNGLGETQUERYOBJECTIVPROC        GetQueryObjectiv;
+        static PFNGLGETQUERYOBJECTUI64VEXTPROC  GetQueryObjectui64v;
+        static PFNGLQUERYCOUNTERPROC            QueryCounter;
+
+        // 8 bit color index textures with a per texture palette
+        static bool hasPalettedTexture;
+        static PFNGLCOLORTABLEEXTPROC           ColorTable;
+
+        // block compressed uploads, bc1/bc3 from S3TC and bc7 from BPTC
+        static bool hasS3TC;
+        static bool hasBPTC;
+        static PFNGLCOMPRESSEDTEXIMAGE2DPROC    CompressedTexImage2D;
+
+        // buffer objects (1.5 core or ARB_vertex_buffer_object)
+        static bool hasVBO;
+        static PFNGLGENBUFFERSPROC              GenBuffers;
+        static PFNGLDELETEBUFFERSPROC           DeleteBuffers;
+        static PFNGLBINDBUFFERPROC              BindBuffer;
+        static PFNGLBUFFERDATAPROC              BufferData;
+        static PFNGLBUFFERSUBDATAPROC           BufferSubData;
+        static PFNGLUNMAPBUFFERPROC             UnmapBuffer;
+        static PFNGLMAPBUFFERPROC               MapBuffer;
+
+        // pixel pack/unpack targets for buffers (2.1 / ARB_pixel_buffer_object)
+        static bool hasPBO;
+
+        // mapped ranges (3.0 / ARB_map_buffer_range) and immutable storage (4.4 / ARB_buffer_storage)
+        static bool hasMapBufferRange;
+        static bool hasBufferStorage;
+        static PFNGLMAPBUFFERRANGEPROC          MapBufferRange;
+        static PFNGLBUFFERSTORAGEPROC           BufferStorage;
+
+        // fences (3.2 / ARB_sync)
+        static bool hasSync;
+        static PFNGLFENCESYNCPROC               FenceSync;
+        static PFNGLCLIENTWAITSYNCPROC          ClientWaitSync;
+        static PFNGLDELETESYNCPROC              DeleteSync;
+
+        // instanced draws (3.1 / ARB_draw_instanced)
+        static bool hasInstancing;
+        static PFNGLDRAWARRAYSINSTANCEDPROC     DrawArraysInstanced;
+
+        // separate alpha blend factors (1.4 / EXT_blend_func_separate)
+        static bool hasBlendSeparate;
+        static PFNGLBLENDFUNCSEPARATEPROC       BlendFuncSeparate;
+
+    protected:
+
+    private:
+        static PROC load(const char *, const char *); // core name first, then the extension name
+};
+
+#endif // _GLEXT_H
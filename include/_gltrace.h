@@ -0,0 +1,206 @@
+#ifndef _GLTRACE_H
+#define _GLTRACE_H
+
+#include<windows.h>
+#include<gl/gl.h>
+#include<GL/glu.h>
+#include<stdio.h>
+#include<vector>
+
+#define GLTRACE_MAGIC 0x52544c47 // "GLTR"
+#define GLTRACE_VERSION 2 // 2 added the scissor, readback and finish ops, 1 still replays
+
+// Records the GL calls the game makes into a binary trace (-gltrace on the
+// command line writes trace.gltrace) for tools/glreplay to run without the game.
+// From startup every call that creates or fills an object is written, so the
+// trace always holds the textures, buffers and lists a frame uses; f12 then
+// starts and stops writing whole frames: state, binds, matrices and draws, with
+// the vertices of client arrays and of mapped buffers copied in at each draw.
+// Readbacks and glFinish go in too, without their pixels, so a replayed frame
+// waits where the game's did.
+// The 1.1 entry points are swapped for the traced_ wrappers below by macro,
+// the _glext pointers by hook() once they are loaded.
+//
+// Every record is an op byte then its arguments, little endian as they are in
+// memory; blobs are a 32 bit size then the bytes. Object names are the ones
+// the game got back, the replay maps them to its own.
+class _glTrace
+{
+    public:
+        enum
+        {
+            // objects, written whenever a trace is open; tex/buffer/fbo names are explicit
+            GEN_TEXTURES = 1, DELETE_TEXTURES, TEX_IMAGE_2D, TEX_SUB_IMAGE_2D, TEX_PARAMETER_I,
+            COMPRESSED_TEX_IMAGE_2D, COLOR_TABLE, PIXEL_STORE_I,
+            GEN_BUFFERS, DELETE_BUFFERS, BUFFER_DATA, BUFFER_SUB_DATA, BUFFER_STORAGE,
+            GEN_FRAMEBUFFERS, DELETE_FRAMEBUFFERS, FRAMEBUFFER_TEXTURE_2D,
+            GEN_RENDERBUFFERS, DELETE_RENDERBUFFERS, RENDERBUFFER_STORAGE, FRAMEBUFFER_RENDERBUFFER,
+            GEN_LISTS, DELETE_LISTS, NEW_LIST, END_LIST,
+
+            // frames, written between f12 presses and while a list is compiled
+            FRAME_STATE = 40, FRAME_END, GROUP_BEGIN, GROUP_END,
+            ENABLE, DISABLE, BLEND_FUNC, DEPTH_FUNC, DEPTH_MASK, STENCIL_FUNC, STENCIL_OP,
+            CLEAR, CLEAR_COLOR, CLEAR_DEPTH, CLEAR_STENCIL, VIEWPORT,
+            MATRIX_MODE, LOAD_IDENTITY, PUSH_MATRIX, POP_MATRIX, TRANSLATE_F, ROTATE_F, SCALE_F,
+            MULT_MATRIX_F, PERSPECTIVE, ORTHO_2D,
+            PUSH_ATTRIB, POP_ATTRIB, PUSH_CLIENT_ATTRIB, POP_CLIENT_ATTRIB,
+            MATERIAL_FV, LIGHT_FV,
+            BIND_TEXTURE, BIND_BUFFER, BIND_FRAMEBUFFER, BIND_RENDERBUFFER,
+            ENABLE_CLIENT_STATE, VERTEX_POINTER, TEX_COORD_POINTER, COLOR_POINTER,
+            CLIENT_ARRAY, DRAW_ARRAYS, CALL_LIST,
+            BEGIN, END, VERTEX_2F, VERTEX_3F, TEX_COORD_2F, COLOR_3F, COLOR_4F,
+            SCISSOR, READ_PIXELS, GET_TEX_IMAGE, FINISH, // the readbacks and finish are replayed for their stalls
+            OP_COUNT
+        };
+
+        static bool open(const char *);    // before the context exists; objects are written from then on
+        static void hook();                // after _glext::init, routes the extension pointers through the wrappers
+        static void close();
+        static void toggle();              // f12, frames start or stop at the next frame end
+        static void frame();               // end of drawScene
+        static void group(const char *);   // name of the calls that follow, nullptr ends the group
+
+        static FILE *file;
+        static bool capturing;             // writing frame calls
+        static int listDepth;              // inside glNewList, everything goes in
+        static int frames;                 // frames written so far
+
+        static bool objects() { return file!=nullptr; }
+        static bool frameCalls() { return file && (capturing || listDepth); }
+
+        // writers, for the wrappers
+        static void op(int);
+        static void put(const void *, size_t);
+        static void putBlob(const void *, size_t);
+        template<class T> static void put(T v) { put(&v,sizeof(T)); }
+
+    protected:
+
+    private:
+        static bool wantToggle;
+        static std::vector<unsigned char> out;
+        static void flush();
+        static void writeState();          // state set before the first traced frame
+};
+
+// gl 1.1 through the trace
+void traced_glBindTexture(GLenum, GLuint);
+void traced_glGenTextures(GLsizei, GLuint *);
+void traced_glDeleteTextures(GLsizei, const GLuint *);
+void traced_glTexImage2D(GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const GLvoid *);
+void traced_glTexSubImage2D(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const GLvoid *);
+void traced_glTexParameteri(GLenum, GLenum, GLint);
+void traced_glPixelStorei(GLenum, GLint);
+GLuint traced_glGenLists(GLsizei);
+void traced_glDeleteLists(GLuint, GLsizei);
+void traced_glNewList(GLuint, GLenum);
+void traced_glEndList();
+void traced_glCallList(GLuint);
+void traced_glEnable(GLenum);
+void traced_glDisable(GLenum);
+void traced_glBlendFunc(GLenum, GLenum);
+void traced_glDepthFunc(GLenum);
+void traced_glDepthMask(GLboolean);
+void traced_glStencilFunc(GLenum, GLint, GLuint);
+void traced_glStencilOp(GLenum, GLenum, GLenum);
+void traced_glClear(GLbitfield);
+void traced_glClearColor(GLclampf, GLclampf, GLclampf, GLclampf);
+void traced_glClearDepth(GLclampd);
+void traced_glClearStencil(GLint);
+void traced_glViewport(GLint, GLint, GLsizei, GLsizei);
+void traced_glMatrixMode(GLenum);
+void traced_glLoadIdentity();
+void traced_glPushMatrix();
+void traced_glPopMatrix();
+void traced_glTranslatef(GLfloat, GLfloat, GLfloat);
+void traced_glRotatef(GLfloat, GLfloat, GLfloat, GLfloat);
+void traced_glScalef(GLfloat, GLfloat, GLfloat);
+void traced_glMultMatrixf(const GLfloat *);
+void traced_gluPerspective(GLdouble, GLdouble, GLdouble, GLdouble);
+void traced_gluOrtho2D(GLdouble, GLdouble, GLdouble, GLdouble);
+void traced_glPushAttrib(GLbitfield);
+void traced_glPopAttrib();
+void traced_glPushClientAttrib(GLbitfield);
+void traced_glPopClientAttrib();
+void traced_glMaterialfv(GLenum, GLenum, const GLfloat *);
+void traced_glLightfv(GLenum, GLenum, const GLfloat *);
+void traced_glEnableClientState(GLenum);
+void traced_glVertexPointer(GLint, GLenum, GLsizei, const GLvoid *);
+void traced_glTexCoordPointer(GLint, GLenum, GLsizei, const GLvoid *);
+void traced_glColorPointer(GLint, GLenum, GLsizei, const GLvoid *);
+void traced_glDrawArrays(GLenum, GLint, GLsizei);
+void traced_glBegin(GLenum);
+void traced_glEnd();
+void traced_glVertex2f(GLfloat, GLfloat);
+void traced_glVertex3f(GLfloat, GLfloat, GLfloat);
+void traced_glTexCoord2f(GLfloat, GLfloat);
+void traced_glColor3f(GLfloat, GLfloat, GLfloat);
+void traced_glColor3fv(const GLfloat *);
+void traced_glColor4f(GLfloat, GLfloat, GLfloat, GLfloat);
+void traced_glScissor(GLint, GLint, GLsizei, GLsizei);
+void traced_glReadPixels(GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, GLvoid *);
+void traced_glGetTexImage(GLenum, GLint, GLenum, GLenum, GLvoid *);
+void traced_glFinish();
+
+// the replay tool and the wrappers themselves call the driver directly
+#ifndef GLTRACE_NO_MACROS
+#define glBindTexture traced_glBindTexture
+#define glGenTextures traced_glGenTextures
+#define glDeleteTextures traced_glDeleteTextures
+#define glTexImage2D traced_glTexImage2D
+#define glTexSubImage2D traced_glTexSubImage2D
+#define glTexParameteri traced_glTexParameteri
+#define glPixelStorei traced_glPixelStorei
+#define glGenLists traced_glGenLists
+#define glDeleteLists traced_glDeleteLists
+#define glNewList traced_glNewList
+#define glEndList traced_glEndList
+#define glCallList traced_glCallList
+#define glEnable traced_glEnable
+#define glDisable traced_glDisable
+#define glBlendFunc traced_glBlendFunc
+#define glDepthFunc traced_glDepthFunc
+#define glDepthMask traced_glDepthMask
+#define glStencilFunc traced_glStencilFunc
+#define glStencilOp traced_glStencilOp
+#define glClear traced_glClear
+#define glClearColor traced_glClearColor
+#define glClearDepth traced_glClearDepth
+#define glClearStencil traced_glClearStencil
+#define glViewport traced_glViewport
+#define glMatrixMode traced_glMatrixMode
+#define glLoadIdentity traced_glLoadIdentity
+#define glPushMatrix traced_glPushMatrix
+#define glPopMatrix traced_glPopMatrix
+#define glTranslatef traced_glTranslatef
+#define glRotatef traced_glRotatef
+#define glScalef traced_glScalef
+#define glMultMatrixf traced_glMultMatrixf
+#define gluPerspective traced_gluPerspective
+#define gluOrtho2D traced_gluOrtho2D
+#define glPushAttrib traced_glPushAttrib
+#define glPopAttrib traced_glPopAttrib
+#define glPushClientAttrib traced_glPushClientAttrib
+#define glPopClientAttrib traced_glPopClientAttrib
+#define glMaterialfv traced_glMaterialfv
+#define glLightfv traced_glLightfv
+#define glEnableClientState traced_glEnableClientState
+#define glVertexPointer traced_glVertexPointer
+#define glTexCoordPointer traced_glTexCoordPointer
+#define glColorPointer traced_glColorPointer
+#define glDrawArrays traced_glDrawArrays
+#define glBegin traced_glBegin
+#define glEnd traced_glEnd
+#define glVertex2f traced_glVertex2f
+#define glVertex3f traced_glVertex3f
+#define glTexCoord2f traced_glTexCoord2f
+#define glColor3f traced_glColor3f
+#define glColor3fv traced_glColor3fv
+#define glColor4f traced_glColor4f
+#define glScissor traced_glScissor
+#define glReadPixels traced_glReadPixels
+#define glGetTexImage traced_glGetTexImage
+#define glFinish traced_glFinish
+#endif
+
+#endif // _GLTRACE_H
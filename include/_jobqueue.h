@@ -0,0 +1,47 @@
+#ifndef _JOBQUEUE_H
+#define _JOBQUEUE_H
+
+#include<_common.h>
+#include<deque>
+#include<vector>
+#include<functional>
+
+// Worker threads for work that must stay off the render thread (decoding,
+// encoding, file io). GL is only current on the main thread, so each job
+// can hand a second function back that poll() runs there once it's done.
+class _jobQueue
+{
+    public:
+        _jobQueue(int); // worker threads, at least one
+        virtual ~_jobQueue();
+
+        void push(std::function<void()>, std::function<void()> = nullptr); // work on a worker, done on the main thread
+        int poll();     // runs finished jobs' done functions, returns how many ran
+        void wait();    // blocks until every queued job has run, then polls
+        static int cores(); // logical processors, a worker each keeps every one busy
+
+        int threads;
+        volatile LONG pending; // queued or running, not yet polled
+
+    protected:
+
+    private:
+        struct job
+        {
+            std::function<void()> work;
+            std::function<void()> done;
+        };
+
+        std::deque<job> queued;
+        std::deque<job> finished;
+        CRITICAL_SECTION lock;
+        HANDLE wake;        // semaphore, one count per queued job
+        HANDLE idle;        // manual reset event, set when nothing is queued or running
+        volatile LONG busy; // queued plus running
+        volatile LONG quit;
+        std::vector<HANDLE> handles;
+
+        static DWORD WINAPI workerMain(LPVOID);
+};
+
+#endif // _JOBQUEUE_H
@@ -0,0 +1,57 @@
+#ifndef _LIGHTMAP_H
+#define _LIGHTMAP_H
+
+#include<_common.h>
+#include<_glext.h>
+#include<_streambuffer.h>
+
+#define MAX_LIGHTS 1024     // per frame lights plus fading flashes
+#define LIGHT_DOWNSCALE 4   // light buffer is the window size over this
+
+struct light2D
+{
+    vec3 pos;       // world position, drawn under the game projection
+    float radius;   // world units
+    float r, g, b;
+    float life;     // seconds left for flashes, 0 for lights that last one frame
+    float invLife;
+};
+
+// Point lights for the 2D scene. Every light is one additive quad with a
+// radial falloff into a low resolution buffer cleared to the ambient level,
+// then the buffer is multiplied over the world (x2, so 0.5 leaves a pixel
+// unchanged and lights can brighten). Cost follows the area the lights cover,
+// not lights times sprites, and all of them go out in a single draw.
+class _lightMap
+{
+    public:
+        _lightMap();
+        virtual ~_lightMap();
+
+        bool enabled;
+        float ambient;          // light buffer clear level, 0.5 is unlit
+        int count;              // lights submitted for this frame
+        _streamBuffer *stream;
+
+        int texW, texH;
+        GLuint fbo, lightTex, falloffTex;
+
+        void initLights();                               // falloff texture, after _glCaps::probe
+        void add(vec3, float, float, float, float);      // position, radius, color; this frame only
+        void flash(vec3, float, float, float, float, float); // same plus seconds to fade over
+        void update(float);                              // ages the flashes
+        bool accumulate(int, int);   // window size; draws the lights, call under the game projection before the world
+        void apply(int, int);        // multiplies the buffer over the current target, call in ortho
+
+    protected:
+
+    private:
+        light2D lights[MAX_LIGHTS];
+        bool ready;                  // accumulate() filled the buffer this frame
+
+        void endFrame();             // drops the one-frame lights, drawn or not
+        bool allocTarget(int, int);
+        void freeTarget();
+};
+
+#endif // _LIGHTMAP_H
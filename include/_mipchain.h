@@ -0,0 +1,37 @@
+#ifndef _MIPCHAIN_H
+#define _MIPCHAIN_H
+
+#include<vector>
+
+// Box filtered mip levels for sprite sheets. Each frame of the sheet is
+// filtered on its own so no level mixes texels from neighbouring frames,
+// which means the chain stops once a frame can't be halved evenly. A single
+// image (a 1x1 grid) has nothing to keep apart and halves down to 1x1,
+// rounding odd sizes down the way gl sizes the levels. The frames
+// still touch, so bilinear filtering reads across their edges when sampling;
+// _spriteTrim::inset keeps the drawn quads far enough inside each frame.
+// No GL in here, the assetbake tool uses it as well.
+class _mipChain
+{
+    public:
+        // bytes per texel, byte index of alpha (-1 for none), frame columns and rows.
+        // point sampling keeps palette indices valid instead of averaging them.
+        _mipChain(int, int, int, int, bool = false);
+        virtual ~_mipChain();
+
+        int bpp, alpha;
+        int framesX, framesY;
+        bool point;
+
+        std::vector< std::vector<unsigned char> > levels; // level 1 onwards, level 0 stays with the caller
+        std::vector<int> widths, heights;                  // matching sizes
+
+        int build(const unsigned char *, int, int); // pixels, width, height, returns levels built
+
+    protected:
+
+    private:
+        void halve(const unsigned char *, int, int, unsigned char *); // one level down, frame by frame
+};
+
+#endif // _MIPCHAIN_H
@@ -2,7 +2,7 @@
 #define _MODEL_H
 
 #include<_common.h>
-#include<_textureloader.h>
+#include<_textureregistry.h>
 
 class _model
 {
@@ -15,7 +15,7 @@ class _model
         vec3 scale;    // resize the model
         void initModel(char *); // get image name
         void drawModel();
-        _textureLoader *mytex= new _textureLoader();
+        GLuint tex = 0; // from initModel, shared through the registry
     protected:
 
     private:
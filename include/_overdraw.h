@@ -0,0 +1,36 @@
+#ifndef _OVERDRAW_H
+#define _OVERDRAW_H
+
+#include<_common.h>
+#include<_streambuffer.h>
+#include<vector>
+
+#define OVERDRAW_LEVELS 8 // heatmap colors, the last one means "this many or more"
+
+// Debug view that counts how many times each pixel gets written with a
+// stencil increment, then paints the counts as a heatmap.
+class _overdraw
+{
+    public:
+        _overdraw();
+        virtual ~_overdraw();
+
+        bool enabled;
+        bool supported;     // the pixel format came with stencil bits
+        float avgOverdraw;  // writes per pixel, last frame
+        int maxOverdraw;
+        _streamBuffer *stream; // heatmap quad goes through the frame's vertex ring
+
+        void initOverdraw();        // checks the stencil buffer
+        void begin();               // start counting, call right after the frame clear
+        void end(int, int);         // stop counting and read the counts back
+        void drawHeatmap(int, int); // paint the counts, call in ortho
+
+    protected:
+
+    private:
+        std::vector<unsigned char> counts; // stencil readback
+        double lastLog;
+};
+
+#endif // _OVERDRAW_H
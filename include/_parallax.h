@@ -4,6 +4,8 @@
 #include<_common.h>
 // #include<_textureloader.h> // No longer needed here if removed below
 #include<_timer.h>
+#include<_streambuffer.h>
+#include<_virtualtexture.h>
 #include<string> // Include string for the scroll function parameter
 
 using namespace std; // Add if 'string' is not recognized otherwise
@@ -27,6 +29,8 @@ class _parallax
 
         float xMax,xMin,yMax,yMin;
         float speed;
+        _streamBuffer *stream = nullptr; // set by the scene
+        _virtualTexture *tiles = nullptr; // set by the scene when the image was cut into tiles, drawn instead of textureID
 
     protected:
 
@@ -0,0 +1,60 @@
+#ifndef _PARTICLES_H
+#define _PARTICLES_H
+
+#include<_common.h>
+#include<_timer.h>
+#include<_streambuffer.h>
+
+#define MAX_PARTICLES 2048 // fixed pool size, keep it a multiple of 4 for the SSE kernel
+
+class _particles
+{
+    public:
+        _particles();
+        virtual ~_particles();
+
+        // structure of arrays, live particles are packed in [0, count)
+        // (aligned when the allocator allows it, the kernel uses unaligned loads either way)
+        alignas(16) float posX[MAX_PARTICLES];
+        alignas(16) float posY[MAX_PARTICLES];
+        alignas(16) float velX[MAX_PARTICLES];
+        alignas(16) float velY[MAX_PARTICLES];
+        alignas(16) float life[MAX_PARTICLES];    // seconds left
+        alignas(16) float invLife[MAX_PARTICLES]; // 1 / starting life, used to fade
+        alignas(16) float colR[MAX_PARTICLES];
+        alignas(16) float colG[MAX_PARTICLES];
+        alignas(16) float colB[MAX_PARTICLES];
+        alignas(16) float colA[MAX_PARTICLES];
+
+        int count;        // number of live particles
+        float pSize;      // half size of a particle quad
+        float pZ;         // depth the particles are drawn at
+        float drag;       // velocity damping per second
+        GLuint particleTex; // soft round sprite generated in initParticles
+        GLuint vbo, uvVbo;  // positions+colors refilled per frame, uvs fixed (buffer path only)
+        _streamBuffer *stream; // persistent ring, written directly on that path
+
+        // counters for the benchmark report
+        long long simulated;
+        long long drawn;
+        double simMs;
+        double drawMs;
+
+        void initParticles();
+        void emit(vec3, int, float, float, float); // burst at position, count, color
+        void update(float);                        // seconds since last update
+        void drawParticles();
+        static void benchmark(int, _streamBuffer *); // frames to run, ring; on a pool of its own, reports per ms rates
+
+    protected:
+
+    private:
+        // one interleaved vertex stream so the whole pool is a single glDrawArrays
+        float verts[MAX_PARTICLES*4*3];
+        float uvs[MAX_PARTICLES*4*2];
+        float cols[MAX_PARTICLES*4*4];
+
+        void kill(int); // swap the last live particle into the slot
+};
+
+#endif // _PARTICLES_H
@@ -4,6 +4,8 @@
 #include<_common.h>
 #include<_textureloader.h>
 #include<_timer.h>
+#include<_streambuffer.h>
+#include<_scenegraph.h>
 
 class _player
 {
@@ -29,6 +31,10 @@ class _player
         vec3 vert[4];  // to draw QUAD to place player image
 
         int actionTrigger; // to select actions
+        _spriteTrim *trim = nullptr; // visible bounds per frame, owned by the scene
+        _streamBuffer *stream = nullptr; // where the quad's vertices go, set by the scene before drawing
+        _sceneGraph *graph = nullptr;    // cached world matrix, the scene keeps node in sync with plPos/plScl
+        int node = -1;
 
 
     protected:
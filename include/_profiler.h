@@ -0,0 +1,66 @@
+#ifndef _PROFILER_H
+#define _PROFILER_H
+
+#include<_common.h>
+#include<_glext.h>
+
+#define PROF_FRAMES 4       // frames between issuing a gpu query and reading it back
+#define PROF_EVENTS 16384   // timeline ring size
+
+// CPU and GPU time per render pass. GPU queries are read back PROF_FRAMES
+// later so asking for the result never waits on the driver.
+class _profiler
+{
+    public:
+        _profiler();
+        virtual ~_profiler();
+
+        enum {FRAME, BACKGROUND, PLAYER, ENEMIES, BULLETS, PARTICLES, PRESENT, TEXT, PASS_COUNT};
+        static const char *passNames[PASS_COUNT];
+
+        bool gpuEnabled;            // queries were created and the driver has timers
+        bool timestamps;            // glQueryCounter per pass edge, else one elapsed query per pass
+        double cpuMs[PASS_COUNT];   // smoothed times per pass
+        double gpuMs[PASS_COUNT];
+
+        void initProfiler();        // needs a current context
+        void beginFrame();
+        void endFrame();
+        void beginPass(int);
+        void endPass(int);
+
+        void report();                        // cpu and gpu table on the console
+        bool exportTimeline(const char *);    // chrome://tracing json
+
+    protected:
+
+    private:
+        struct event
+        {
+            long frame;
+            int pass;
+            int gpu;          // 0 cpu track, 1 gpu track
+            double start, ms; // ms since the profiler started
+        };
+
+        GLuint queries[PROF_FRAMES][PASS_COUNT][2]; // begin/end timestamps, or one elapsed query
+        bool issued[PROF_FRAMES][PASS_COUNT];
+        double issuedCpu[PROF_FRAMES][PASS_COUNT];  // cpu start of the pass, anchors the gpu track
+        long slotFrame[PROF_FRAMES];
+
+        int slot;               // query set used this frame
+        long frame;
+        bool elapsedOpen;       // GL_TIME_ELAPSED queries can't nest
+        double startMs;         // profiler creation, timeline zero
+        double passStart[PASS_COUNT];
+        GLuint64 gpuBase;       // first gpu timestamp
+        double gpuBaseCpu;      // cpu time it is mapped to
+
+        event events[PROF_EVENTS];
+        int eventHead, eventCount;
+
+        void collect(int);      // read back a finished query set
+        void addEvent(long, int, int, double, double);
+};
+
+#endif // _PROFILER_H
@@ -0,0 +1,75 @@
+#ifndef _RENDERSTATS_H
+#define _RENDERSTATS_H
+
+#include<_common.h>
+#include<_profiler.h>
+#include<stdio.h>
+#include<map>
+
+#define RSTATS_STATES 5     // GameState values, landing to paused
+
+// Draw calls, binds, state changes, vertices and texels uploaded per frame.
+// Counted in the traced_ gl wrappers every call already goes through, so no
+// draw path has to remember to report; the profiler pass open at the time
+// says which path it was (background, player, enemies, bullets, text), calls
+// outside a pass land on "frame". Frames are summed per GameState, and
+// -stats <file> streams every frame as csv, or json lines for a .json name,
+// for regression dashboards.
+class _renderStats
+{
+    public:
+        enum {DRAWS, BINDS, STATES, VERTICES, TEXELS, COUNTER_COUNT};
+        static const char *counterNames[COUNTER_COUNT];
+        static const char *stateNames[RSTATS_STATES];
+
+        static bool open(const char *);     // per-frame stream, csv or .json
+        static void close();                // writes the stream out, per-state table on the console
+        static void frame(int);             // end of drawScene, the GameState it drew
+        static void report();
+
+        static void beginPass(int p) { pass = p; }
+        static void endPass() { pass = _profiler::FRAME; }
+
+        // display lists are charged when they are called, not when they are built
+        static void beginList(GLuint, bool);
+        static void endList();
+        static void callList(GLuint);
+        static void deleteLists(GLuint, GLsizei);
+
+        static void add(int c, long long n = 1)
+        {
+            if(compiling) addToList(c,n);
+            else counts[pass][c] += n;
+        }
+
+        static long long counts[_profiler::PASS_COUNT][COUNTER_COUNT]; // this frame so far
+        static long long last[COUNTER_COUNT];                         // last frame's totals
+
+        struct stateTotals
+        {
+            long long frames;
+            long long sum[COUNTER_COUNT];
+            long long peak[COUNTER_COUNT];
+        };
+        static stateTotals states[RSTATS_STATES];
+
+    protected:
+
+    private:
+        struct listCost
+        {
+            long long c[COUNTER_COUNT];
+        };
+
+        static int pass;
+        static GLuint compiling;            // list being built, 0 when none
+        static bool executing;              // GL_COMPILE_AND_EXECUTE also counts now
+        static std::map<GLuint, listCost> lists;
+        static FILE *file;
+        static bool json;
+        static long long frameCount;
+
+        static void addToList(int, long long);
+};
+
+#endif // _RENDERSTATS_H
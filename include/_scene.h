@@ -9,6 +9,7 @@
 
 
 #include "_textureLoader.h"
+#include "_textureregistry.h"
 #include "_common.h" // Assuming vec2, vec3 are here
 #include "_timer.h"
 #include "_player.h"
@@ -16,7 +17,27 @@
 #include "_bullets.h"
 #include "_parallax.h"
 #include "_inputs.h"
-// #include "_collisioncheck.h" 
+#include "_particles.h"
+#include "_collisionckeck.h"
+#include "_glext.h"
+#include "_glcaps.h"
+#include "_dynres.h"
+#include "_profiler.h"
+#include "_overdraw.h"
+#include "_jobqueue.h"
+#include "_assetvariants.h"
+#include "_uploadqueue.h"
+#include "_assetpack.h"
+#include "_fonttable.h"
+#include "_streambuffer.h"
+#include "_capture.h"
+#include "_softrastergl.h"
+#include "_lightmap.h"
+#include "_scenegraph.h"
+#include "_tilemap.h"
+#include "_virtualtexture.h"
+#include "_renderstats.h"
+#include "_uilayer.h"
 // #include "_sounds.h"      
 // #include "_lightsetting.h" 
 
@@ -31,16 +52,6 @@ enum GameState {
     // Add other states like GAME_OVER if needed
 };
 
-// Structure to hold character data from .fnt file
-struct CharData {
-    int id = 0;
-    float x = 0, y = 0;
-    float width = 0, height = 0;
-    float xoffset = 0, yoffset = 0;
-    float xadvance = 0;
-    // Add page, chnl if needed
-};
-
 
 class _scene
 {
@@ -53,6 +64,7 @@ class _scene
         void reSize(GLint, GLint); // Handle window resize
         GLuint menuBackgroundTextureID;
         int winMsg(HWND, UINT, WPARAM, LPARAM); // Handle window messages 
+        void loadBenchmark();  // startup decode time on 1, 2, 4 ... workers, to the console
 
      
         void updateGame(float deltaTime);
@@ -71,17 +83,21 @@ class _scene
         GLuint playerTextureID;
         GLuint enemyTextureID;
         GLuint bulletTextureID;
+        int bulletMipLevels;        // levels the loader built for the bullet sheet
         GLuint backgroundTextureID;
+        GLuint wallTextureID;       // tile image of the level
         GLuint helpTextureID;
 
         // --- Font Rendering Data ---
-        std::map<int, CharData> fontDataMap; // Map character IDs to their data
+        _fontTable fontTable;                // glyphs by character code, from the compiled .fntb when it's current
         float fontTextureWidth = 0;
         float fontTextureHeight = 0;
         float fontLineHeight = 0;
         float fontBaseHeight = 0;
-        bool loadFontData(const char* filename); // Helper to load .fnt
+        bool loadFontData(const char* filename); // Helper to load .fnt, through its compiled .fntb
         void drawText(std::string text, float screenX, float screenY, float r, float g, float b);
+        void textQuads(const std::string &text, float screenX, float screenY);
+        float textWidth(const std::string &text);
 
         // --- Projection Helpers ---
         void setOrthoProjection(int width, int height);
@@ -94,7 +110,38 @@ class _scene
         _timer* gameTimer = nullptr;        // A timer for game updates/animations 
         // _lightsetting* lights = nullptr; // 
         // _sounds* soundManager = nullptr; // 
-        // _collisioncheck* collisionChecker = nullptr; // Example
+        _collisionCkeck* collisionChecker = nullptr; // bullet vs enemy hits
+        _particles* particles = nullptr;    // sparks for bullet hits and enemy deaths
+        int score = 0;                      // enemies destroyed this game
+        _dynRes* dynRes = nullptr;          // scaled offscreen target for the game scene
+        _uiLayer* hud = nullptr;            // score and resolution lines, cached in a texture
+        _profiler* profiler = nullptr;      // cpu/gpu time per render pass
+        _overdraw* overdraw = nullptr;      // f5 heatmap of writes per pixel
+        _jobQueue* jobs = nullptr;          // background work, finished jobs are polled each frame
+        _uploadQueue* uploads = nullptr;    // texture uploads through fenced pixel buffers
+        _assetPack* pack = nullptr;         // images/assets.pak mapped, baked assets skip decoding
+        _assetVariants* variants = nullptr; // resolution variants of the full-screen images
+        _streamBuffer* stream = nullptr;    // per-frame vertex ring shared by every immediate-style draw
+        _capture* capture = nullptr;        // f8 screenshot, f9 record, read back without stalling
+        _softRasterGL* softRaster = nullptr; // cpu renderer fed from the stream, f11 renders one frame with it
+        _lightMap* lights = nullptr;        // 2d point lights, accumulated at low resolution and multiplied over the world
+        _sceneGraph* graph = nullptr;       // world matrices of the player, enemies and bullets
+        int muzzleNode = -1;                // child of the player node, bullets leave from here
+        _tilemap* tilemap = nullptr;        // level walls, drawn as cached chunks between the background and the sprites
+        _virtualTexture* backgroundTiles = nullptr; // prlx.jpg streamed in tiles, null when it was never cut into them
+        bool softFrame = false;
+        int softFrames = 0;
+
+        // visible bounds per animation frame, built when the sheets are decoded
+        _spriteTrim* playerTrim = nullptr;
+        _spriteTrim* enemyTrim = nullptr;
+        _spriteTrim* bulletTrim = nullptr;
+
+        void drawHUD();                     // score and resolution, always at native size
+        void samplingBenchmark();           // base level vs mipmapped minification, to the console
+        std::vector<textureRequest> startupTextures(_spriteTrim*, _spriteTrim*, _spriteTrim*, bool); // player, enemy, bullet trims, whole background
+        void drawScreenQuad(float, float, float, float); // x, y, w, h in ortho pixels, uvs 0..1, through the stream
+        void syncGraph();                   // copies entity transforms into the graph and updates dirty nodes
 
         // Collections for multiple enemies/bullets
         std::vector<_enms*> enemies;
@@ -0,0 +1,44 @@
+#ifndef _SCENEGRAPH_H
+#define _SCENEGRAPH_H
+
+#include<_common.h>
+
+#define MAX_NODES 256 // player, enemies, the bullet pool and their attachments
+
+// Transform hierarchy in flat arrays. A node's parent is always created
+// before it, so one pass in index order sees every parent before its
+// children. Setting a local transform only marks the node dirty; update()
+// rebuilds the local matrix of dirty nodes and the world matrix of every
+// node under one, and renderers load the cached world matrix.
+class _sceneGraph
+{
+    public:
+        _sceneGraph();
+        virtual ~_sceneGraph();
+
+        int count;
+        int parent[MAX_NODES];          // -1 for roots
+        vec3 pos[MAX_NODES];
+        vec3 rot[MAX_NODES];            // degrees, applied x then y then z like the glRotatef calls
+        vec3 scale[MAX_NODES];
+        float world[MAX_NODES][16];     // column major, ready for glMultMatrixf
+
+        long long rebuilt;              // world matrices recomputed by the last update
+
+        int create(int = -1);           // parent node; returns the node or -1 when full
+        void setLocal(int, vec3, vec3, vec3); // position, rotation, scale; dirty only if something changed
+        void setPosition(int, vec3);
+        void update();                  // recompute dirty subtrees
+        vec3 worldPosition(int);        // translation of the cached world matrix
+
+    protected:
+
+    private:
+        float local[MAX_NODES][16];
+        bool dirty[MAX_NODES];          // local transform changed since the last update
+        bool moved[MAX_NODES];          // world matrix recomputed in the current update
+
+        void buildLocal(int);
+};
+
+#endif // _SCENEGRAPH_H
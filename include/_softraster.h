@@ -0,0 +1,90 @@
+#ifndef _SOFTRASTER_H
+#define _SOFTRASTER_H
+
+#include<_streamvertex.h>
+#include<vector>
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+#include<atomic>
+
+#define SOFT_TILE 64 // tile edge in pixels, one job per tile
+
+// texels as bgra8, same layout as the target
+struct softTexture
+{
+    int width, height;
+    bool clamp;             // GL_CLAMP* instead of GL_REPEAT
+    std::vector<unsigned int> texels;
+};
+
+// one quad already in target pixels, bottom-up like gl; drawn as (0,1,2) + (0,2,3)
+struct softQuad
+{
+    float x[4], y[4];
+    float u[4], v[4];
+    float col[4][4];        // b, g, r, a per vertex
+    const softTexture *tex; // nullptr draws the color alone
+    int blend;
+};
+
+// CPU renderer for the quads the game submits through _streamBuffer. Quads are
+// binned into SOFT_TILE tiles and the tiles are handed out to a pool of
+// std::threads, each rasterized in submission order, so the output is the same
+// whatever the thread count. Nothing here includes GL or windows.h: it needs no
+// context and tools/softbench builds it with plain g++ on a machine without a
+// gpu. _softRasterGL (_softrastergl.h) is the adapter that turns a stream draw
+// plus the current GL state into drawQuads. There is no stencil: every pixel
+// counts its writes in overdraw instead (what the overdraw view counts in the
+// stencil).
+class _softRaster
+{
+    public:
+        _softRaster(int = 0); // threads, the caller of finish() included; 0 for one per core
+        virtual ~_softRaster();
+
+        enum {BLEND_NONE, BLEND_ALPHA, BLEND_ADD, BLEND_PREMULTIPLIED};
+
+        int width, height;
+        std::vector<unsigned int> color;  // bgra8 rows, bottom row first
+        int threads;
+        bool active;                      // between begin and finish
+        double binMs, rasterMs;           // last finish()
+        long long quads;
+        std::vector<unsigned char> overdraw; // writes per pixel, saturating at 255
+        float avgOverdraw;                // last finish()
+        int maxOverdraw;
+
+        virtual void begin(int, int, float, float, float); // target size, clear color
+        void submit(const softQuad &);
+        // GL_QUADS vertices (streamVertex or streamColorVertex, told apart by the stride), count,
+        // clip matrix (projection*modelview, column major), color for vertices without one, texture, blend
+        void drawQuads(const void *, int, int, const float *, const float *, const softTexture *, int);
+        void finish();                              // rasterizes everything submitted
+
+        static double nowMs(); // steady clock, what the timings above are measured with
+
+    protected:
+
+    private:
+        std::vector<softQuad> submitted;
+        std::vector<std::vector<int> > bins; // quad indices per tile, in submission order
+        int tilesX, tilesY;
+        unsigned int clearColor;
+
+        // threads-1 workers, woken once per finish(); the caller drains tiles alongside them
+        std::vector<std::thread> pool;
+        std::mutex lock;
+        std::condition_variable wake, done;
+        int generation;                   // bumped per finish(), a worker runs each one once
+        int running;                      // workers still draining this generation
+        bool quit;
+        std::vector<int> work;            // tiles with quads in them
+        std::atomic<int> nextTile;        // into work
+
+        void workerMain();
+        void drainTiles();
+        void rasterTile(int, int);
+};
+
+#endif // _SOFTRASTER_H
@@ -0,0 +1,31 @@
+#ifndef _SOFTRASTERGL_H
+#define _SOFTRASTERGL_H
+
+#include<_common.h>
+#include<_softraster.h>
+#include<_streambuffer.h>
+#include<map>
+
+// The GL side of the cpu renderer: _streamBuffer::draw hands its spans to
+// fromGL(), which reads the matrices, color, bound texture and blend state a
+// draw would use and passes the quads on to drawQuads. Textures are read back
+// once per frame. Stencil tested draws are skipped, overdraw already has the
+// counts the overdraw view tests for.
+class _softRasterGL : public _softRaster
+{
+    public:
+        _softRasterGL(int = 0); // as _softRaster
+        virtual ~_softRasterGL();
+
+        void begin(int, int, float, float, float); // also forgets last frame's textures
+        void fromGL(const streamSpan &, GLenum, GLsizei); // GL_QUADS spans only
+
+    protected:
+
+    private:
+        std::map<GLuint, softTexture> textures; // read back from GL once per frame
+
+        const softTexture *texture(GLuint);
+};
+
+#endif // _SOFTRASTERGL_H
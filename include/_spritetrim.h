@@ -0,0 +1,34 @@
+#ifndef _SPRITETRIM_H
+#define _SPRITETRIM_H
+
+#include<_common.h>
+#include<vector>
+
+// Tight bounds of the visible texels in each frame of a sprite sheet,
+// as fractions of the frame (x from the left, y from the top).
+struct trimRect
+{
+    float x0, y0, x1, y1;
+};
+
+class _spriteTrim
+{
+    public:
+        _spriteTrim(int, int); // frame columns, rows
+        virtual ~_spriteTrim();
+
+        int framesX, framesY;
+        std::vector<trimRect> rects; // row major, one per frame
+        double fullArea;             // texels covered by untrimmed quads
+        double trimmedArea;          // texels covered by trimmed quads
+
+        void build(const unsigned char *, int, int, int); // pixels, width, height, channels
+        void inset(int, int, int);   // mip levels, sheet width, height: pulls frame edges in by half a texel of the last level; a single frame is left alone
+        const trimRect &frame(float, float) const;   // frame under the sprite's xMin, yMin
+
+    protected:
+
+    private:
+};
+
+#endif // _SPRITETRIM_H
@@ -0,0 +1,61 @@
+#ifndef _STREAMBUFFER_H
+#define _STREAMBUFFER_H
+
+#include<_common.h>
+#include<_glext.h>
+#include<_glcaps.h>
+#include<_streamvertex.h>
+#include<vector>
+
+class _softRasterGL;
+
+#define STREAM_REGIONS 3                // frames the gpu may lag behind before we wait
+#define STREAM_REGION_BYTES (1024*1024) // vertex data per frame
+
+// a piece of this frame's vertex memory, write it front to back and don't read it back
+struct streamSpan
+{
+    void *ptr;
+    GLint first;  // vertex index to draw from
+    int path;     // _glCaps path the span was made for
+    int stride;
+};
+
+// Per-frame vertex data written straight into a persistently mapped, coherent
+// buffer (ARB_buffer_storage) split into STREAM_REGIONS regions. Each frame
+// takes the next region after waiting on the fence placed when the gpu was
+// given it last time, so there is no glBufferData orphaning and no driver copy.
+// Features on another path get the same api backed by client memory.
+class _streamBuffer
+{
+    public:
+        _streamBuffer();
+        virtual ~_streamBuffer();
+
+        bool persistent;    // the mapped buffer exists
+        long long waits;    // frames that found their region still in use
+        double waitMs;      // time spent in those waits
+        long long overflows;
+        _softRasterGL *soft; // also hands quads to the cpu renderer while set
+
+        void initStream();  // after _glCaps::probe
+        void beginFrame();  // takes the next region, waiting for the gpu if it has to
+        void endFrame();    // fences the region just used
+
+        streamSpan alloc(int, int, int);                  // feature, vertices, stride; ptr is null when the frame is full
+        void draw(const streamSpan &, GLenum, GLsizei);   // mode, vertex count; layout picked from the stride
+
+    protected:
+
+    private:
+        GLuint buffer;
+        unsigned char *mapped;           // whole buffer, STREAM_REGIONS regions
+        GLsync fences[STREAM_REGIONS];
+        int region;
+        size_t cursor;                   // next free byte in the current region
+
+        std::vector<unsigned char> client; // one region's worth for the non buffer paths
+        size_t clientCursor;
+};
+
+#endif // _STREAMBUFFER_H
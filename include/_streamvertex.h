@@ -0,0 +1,24 @@
+#ifndef _STREAMVERTEX_H
+#define _STREAMVERTEX_H
+
+// vertex layouts the stream draws, color comes from glColor when there is none.
+// no GL in here, the cpu renderer takes the same vertices without a context.
+struct streamVertex
+{
+    float x, y, z;
+    float u, v;
+};
+
+struct streamColorVertex
+{
+    float x, y, z;
+    float u, v;
+    float r, g, b, a;
+};
+
+inline void streamPut(streamVertex *v, float x, float y, float z, float u, float t)
+{
+    v->x = x; v->y = y; v->z = z; v->u = u; v->v = t;
+}
+
+#endif // _STREAMVERTEX_H
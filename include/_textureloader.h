@@ -3,6 +3,52 @@
 
 #include<_common.h>
 #include<SOIL.h>
+#include<_spritetrim.h>
+#include<_dxt.h>
+#include<_mipchain.h>
+#include<_jobqueue.h>
+#include<vector>
+#include<string>
+
+// what a file decodes to before anything touches GL, so decoding can run on a worker
+struct decodedTexture
+{
+    std::string fileName;
+    int width, height, channels;
+    std::vector<unsigned char> pixels; // channels per texel, empty when dds holds blocks
+    _dxt::image dds;                   // blocks the driver takes as they are
+    bool hasBlocks;
+    std::string log;                   // decode's messages, a line each; printed by the caller, not the worker
+};
+
+// the cpu half of an upload: format picked and every level laid out the way
+// the driver takes it, so it can be copied anywhere (a pixel buffer) and
+// handed to submit() from there
+struct packedTexture
+{
+    std::string fileName;              // what was asked for, the registry keys the texture by it
+    std::string loadedFrom;            // the baked .dds the levels came from, empty otherwise; messages only
+    int format;                        // TEX_*, a block format for a baked .dds
+    int width, height;
+    std::vector<unsigned char> data;   // every level back to back
+    std::vector<size_t> offsets, sizes; // per level, into data
+    std::vector<int> widths, heights;
+    std::vector<unsigned char> palette; // 256 rgba entries for TEX_PALETTE8
+    long long rgbaBytes;               // what the levels would take as rgba8
+    std::string log;                   // decode's and pack's messages, a line each; printed on the GL thread
+};
+
+// one file of a batch that is decoded and packed on the job queue's workers
+struct textureRequest
+{
+    std::string fileName;
+    _spriteTrim *trim;                 // built from the decoded pixels, one per request
+    int format;
+    bool mipmaps;
+    packedTexture packed;
+    const unsigned char *base;         // levels already in memory (a mapped pack), null to decode into packed.data
+    bool ok;
+};
 
 class _textureLoader
 {
@@ -10,16 +56,44 @@ class _textureLoader
         _textureLoader();
         virtual ~_textureLoader();
 
+        // upload formats, a requested format that would lose data falls back to the cheapest lossless one.
+        // the block compressed ones only come from a baked .dds next to the image.
+        enum {TEX_AUTO, TEX_RGBA8, TEX_RGB8, TEX_LUMINANCE8, TEX_ALPHA8, TEX_LUMINANCE_ALPHA8, TEX_PALETTE8,
+              TEX_BC1, TEX_BC3, TEX_BC7, TEX_FORMAT_COUNT};
+        static const char *formatNames[TEX_FORMAT_COUNT];
+
         int width,height;   // keep image width & height
         unsigned char* image; // read image to temp location
         GLuint tex;         // Texture buffer handler
+        int format;         // format the last texture was uploaded as
+        long long gpuBytes; // size of the last texture, every mip level included
+        int mipLevels;      // levels the last texture has, 1 without mipmaps
+        GLenum minFilter;   // trilinear when there are levels to blend, plain linear otherwise
+
+        // every texture loaded so far, and what it would have cost as RGBA8
+        static long long totalBytes;
+        static long long totalRGBA8Bytes;
+        static void reportMemory();
 
-        void loadTexture(char *);
+        // optional trim is built from the decoded pixels, its frame grid also keeps mip levels from bleeding
+        void loadTexture(char *, _spriteTrim * = nullptr, int = TEX_AUTO, bool = false);
+        static bool decode(const char *, decodedTexture &); // no GL, safe on any thread
+        void upload(decodedTexture &, _spriteTrim * = nullptr, int = TEX_AUTO, bool = false); // GL thread only
+        bool pack(decodedTexture &, packedTexture &, _spriteTrim * = nullptr, int = TEX_AUTO, bool = false); // no GL, one loader per thread; takes dec's pixels
+        void submit(const packedTexture &, const unsigned char *); // GL thread, levels at base+offset, null base with an unpack buffer bound
+        static void packAll(_jobQueue *, std::vector<textureRequest> &); // requests without a base decoded and packed on the workers, returns once all are and their logs are printed
+        void upload(textureRequest &);  // GL thread, tex is 0 if the request failed
+        static void ddsPath(const char *, char *, size_t); // image path to its baked .dds sibling
+        static bool ddsCurrent(const char *, const char *); // image, its .dds: false when both exist and the image was written after it
         void textureBinder();
 
     protected:
 
     private:
+        int pickFormat(int, int, int, std::string &); // channels, requested format, palette size or -1, log
+        int buildPalette(int, unsigned char *, unsigned char *); // channels, indices out, rgba palette out
+        void uploadLevel(int, int, int, const unsigned char *); // level, width, height, texels in the picked format
+        void packBlocks(decodedTexture &, packedTexture &, _spriteTrim *); // out.log already holds dec's
 };
 
 #endif // _TEXTURELOADER_H
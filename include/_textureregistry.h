@@ -0,0 +1,45 @@
+#ifndef _TEXTUREREGISTRY_H
+#define _TEXTUREREGISTRY_H
+
+#include<_common.h>
+#include<_textureloader.h>
+#include<map>
+#include<string>
+
+// Owns every texture loaded from a file. Each one is keyed by its normalized
+// path and counted by references: acquire() decodes a file the first time
+// and hands the same texture to every later caller, release() drops a
+// reference and deletes the GL texture with the last one. Textures created
+// elsewhere (the startup batch, the upload queue) are added by
+// _textureLoader::submit with one reference held by whoever asked for them.
+class _textureRegistry
+{
+    public:
+        struct entry
+        {
+            std::string path;   // normalized
+            GLuint tex;
+            int refs;
+            long long bytes;    // every level, as _textureLoader counted it
+        };
+
+        static long long liveBytes; // textures not released yet
+        static int liveCount;
+
+        // path, then how the first load decodes it: a trim is only built by the call that decodes
+        static GLuint acquire(const char *, _spriteTrim * = nullptr, int = _textureLoader::TEX_AUTO, bool = false);
+        static void add(const std::string &, GLuint, long long); // path, texture, bytes; one reference
+        static void retain(GLuint);
+        static void release(GLuint);    // names it doesn't know are deleted outright
+        static const entry *find(GLuint);
+        static std::string normalize(const char *); // lower case, forward slashes, no . or .. segments
+        static void report();           // every live texture with its references and size
+
+    protected:
+
+    private:
+        static std::map<std::string, GLuint> byPath; // first texture loaded from a path
+        static std::map<GLuint, entry> byName;
+};
+
+#endif // _TEXTUREREGISTRY_H
@@ -0,0 +1,57 @@
+#ifndef _TILEMAP_H
+#define _TILEMAP_H
+
+#include<_common.h>
+#include<_glext.h>
+#include<_glcaps.h>
+#include<vector>
+#include<istream>
+
+#define TILE_CHUNK 16 // tiles per chunk edge
+
+// Level made of square tiles, drawn as TILE_CHUNK x TILE_CHUNK chunks whose
+// geometry is built once into a static vertex buffer (or a display list on
+// 1.1 contexts). Only chunks overlapping the view are drawn, and changing a
+// tile marks just its chunk for a rebuild the next time it is drawn.
+class _tilemap
+{
+    public:
+        _tilemap();
+        virtual ~_tilemap();
+
+        int width, height;          // in tiles
+        float tileSize;             // world units
+        float originX, originY, z;  // bottom-left corner of the level
+        float scrollX;              // world units, wraps at the level width
+        int atlasX, atlasY;         // tile images in the texture, tile id 1 is the top-left one
+
+        int chunksDrawn;            // last draw
+        int chunksBuilt;            // last draw, dirty chunks rebuilt before drawing
+
+        bool loadMap(const char *); // text rows top to bottom, '.' empty, '#' tile 1, '1'-'9' tiles 1-9, ';' comments
+        bool loadMap(std::istream &); // the same rows from anywhere, e.g. the asset pack
+        int tile(int, int);
+        void setTile(int, int, int);
+        void scroll(float);         // world units
+        void draw(GLuint, float);   // texture, half the view width at the level's depth
+
+    protected:
+
+    private:
+        struct chunk
+        {
+            GLuint id;              // buffer object or display list
+            int vertices;
+            bool dirty;
+        };
+
+        std::vector<unsigned char> tiles; // row 0 is the bottom row
+        std::vector<chunk> chunks;
+        int chunksX, chunksY;
+        int path;                   // PATH_VBO or PATH_DISPLAY_LIST, picked when the map loads
+
+        void freeChunks();
+        void buildChunk(int, int);
+};
+
+#endif // _TILEMAP_H
@@ -22,6 +22,8 @@ class _timer
           void stop();
           void reset();
 
+          static double nowMs(); // high resolution wall clock in milliseconds
+
     protected:
 
     private:
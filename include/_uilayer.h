@@ -0,0 +1,71 @@
+#ifndef _UILAYER_H
+#define _UILAYER_H
+
+#include<_common.h>
+#include<_glext.h>
+#include<_streambuffer.h>
+#include<vector>
+#include<string>
+#include<functional>
+
+#define UI_PAD 2            // pixels around a line's box, glyph offsets can poke out of it
+
+// The HUD kept in its own window-sized texture. Each line of text is a slot;
+// set() compares it with what is already in the texture and only when the
+// text, position or color changed marks the old and new boxes dirty. present()
+// re-renders the dirty boxes (scissored clear, then every line touching them)
+// and composites the whole layer with one quad, so a frame where the score did
+// not change costs one draw instead of re-tessellating and blending every
+// glyph. Text is blended into the layer with premultiplied alpha, which needs
+// separate alpha blend factors; without them or without an fbo the lines are
+// drawn straight to the window as before.
+class _uiLayer
+{
+    public:
+        _uiLayer();
+        virtual ~_uiLayer();
+
+        bool enabled;               // false draws every line every frame
+        int texW, texH;             // layer size, the window size
+        GLuint fbo, colorTex;
+        int redrawn;                // boxes re-rendered so far
+        _streamBuffer *stream;      // the layer quad goes through it, set by the scene
+
+        // set by the scene: line width in pixels, and the glyph quads of a line
+        // (color and blend state are already set, the font texture is not)
+        std::function<float(const std::string &)> measure;
+        std::function<void(const std::string &, float, float)> drawLine;
+        float lineHeight;
+
+        void set(int, const std::string &, float, float, float, float, float); // slot, text, x, y, rgb; empty text hides it
+        void invalidate();          // redraw everything next present, e.g. after the font changed
+        void present(int, int);     // window size, call in ortho
+
+    protected:
+
+    private:
+        struct box
+        {
+            int x0, y0, x1, y1;     // ortho pixels, top-left origin
+        };
+
+        struct line
+        {
+            std::string text;
+            float x, y, r, g, b;
+            box at;                 // where it was drawn
+        };
+
+        std::vector<line> lines;
+        std::vector<box> dirty;
+
+        bool usable();
+        bool allocTarget(int, int);
+        void freeTarget();
+        box bounds(const line &);
+        void markDirty(box);        // merged into a dirty box it overlaps
+        void redraw();
+        void drawDirect();
+};
+
+#endif // _UILAYER_H
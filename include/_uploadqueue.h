@@ -0,0 +1,80 @@
+#ifndef _UPLOADQUEUE_H
+#define _UPLOADQUEUE_H
+
+#include<_common.h>
+#include<_glext.h>
+#include<_glcaps.h>
+#include<_jobqueue.h>
+#include<_textureloader.h>
+#include<_assetpack.h>
+#include<deque>
+#include<string>
+#include<memory>
+#include<functional>
+
+#define UPLOAD_SLOTS 4  // textures being copied or transferred at once
+#define UPLOAD_DELAY 2  // frames between the upload and the hand over when there are no fences
+
+// Texture loads that never stall a frame. A worker decodes the file and packs
+// its levels (_textureLoader::pack), the main thread maps a free pixel unpack
+// buffer and a second job copies the levels into the mapping. Back on the main
+// thread the buffer is unmapped and glTexImage2D reads from it, which only
+// queues the transfer, and a fence goes in after it. The texture is handed to
+// the caller once that fence has passed, so nothing samples it mid-transfer.
+// Without unpack buffers the packed levels are uploaded from client memory,
+// one texture per frame.
+class _uploadQueue
+{
+    public:
+        _uploadQueue(_jobQueue *);
+        virtual ~_uploadQueue();
+
+        int uploaded;       // textures handed over so far
+        long long bytes;    // sent through the unpack buffers
+        double submitMs;    // main thread time spent starting uploads
+        _assetPack *pack = nullptr; // baked levels are copied from its mapping, nothing to decode
+
+        void initUploads(); // after _glCaps::probe
+        // file, format, mipmaps, then called on the main thread with the texture
+        // (0 if it failed to load) once it can be drawn with
+        void load(const std::string &, int, bool, std::function<void(GLuint)>);
+        void poll();        // every frame on the main thread, after _jobQueue::poll
+        int pending();      // loads not handed over yet
+
+    protected:
+
+    private:
+        enum {FREE, COPYING, UPLOADING};
+
+        struct request
+        {
+            std::shared_ptr<packedTexture> packed;
+            const unsigned char *levels; // packed->data or the pack's mapping
+            size_t size;
+            std::function<void(GLuint)> ready;
+        };
+
+        struct slot
+        {
+            GLuint pbo;
+            GLsizeiptr capacity;
+            GLsync fence;
+            int state;
+            long issuedFrame;
+            GLuint tex;         // uploading into, not handed over yet
+            request req;
+        };
+
+        _jobQueue *jobs;
+        _textureLoader *uploader;
+        slot slots[UPLOAD_SLOTS];
+        std::deque<request> waiting; // packed, no free slot yet
+        long frameCount;
+        int decoding;
+
+        void start(slot *, request &);  // map the buffer and have a worker fill it
+        void copied(slot *);            // main thread: unmap, upload from it, fence
+        GLuint direct(request &);       // upload from client memory
+};
+
+#endif // _UPLOADQUEUE_H
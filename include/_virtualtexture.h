@@ -0,0 +1,74 @@
+#ifndef _VIRTUALTEXTURE_H
+#define _VIRTUALTEXTURE_H
+
+#include<_common.h>
+#include<_jobqueue.h>
+#include<_streambuffer.h>
+#include<vector>
+#include<string>
+#include<map>
+#include<set>
+
+#define VT_PREFETCH 2   // tile columns requested ahead of the scroll
+#define VT_IN_FLIGHT 4  // tile decodes queued at once
+
+// Image too big to keep resident, cut by assetbake -tiles into a pyramid of
+// fixed-size tiles (images/prlx.tiles next to images/prlx_t<level>_<col>_<row>.tga,
+// every tile with a one texel border so filtering never reads a neighbour slot).
+// Tiles of the level closest to one texel per pixel live in the slots of one
+// cache texture sized from the window, so resident memory follows the screen
+// rather than the image. Missing tiles are decoded on a worker, the columns
+// ahead of the scroll included, and drawn from the coarsest level until they
+// arrive; the slots drawn longest ago, the ones scrolled past, are reused first.
+class _virtualTexture
+{
+    public:
+        _virtualTexture(_jobQueue *);
+        virtual ~_virtualTexture();
+
+        bool open(const char *);    // source image; false when it was never cut into tiles
+        void resize(int, int);      // window size, reallocates the cache
+        void draw(float, float, float, float, float, float, int); // quad x0 y0 x1 y1 z, horizontal offset in image widths, window height
+
+        int width, height;          // source image
+        int tileSize, levels;       // the last level fits in one tile and stays loaded
+        int level;                  // drawn last frame
+        int resident;               // tiles in the cache
+        int loaded, evicted;        // tiles uploaded and slots reused so far
+        _streamBuffer *stream;      // set by the scene
+
+    protected:
+
+    private:
+        struct slot
+        {
+            int key;                // level, column and row, -1 when free
+            long long used;         // last frame it was drawn or prefetched
+        };
+
+        _jobQueue *jobs;
+        std::string stem;           // images/prlx
+        GLuint cacheTex, coarseTex;
+        int cacheW, cacheH, slotsX;
+        int channels;
+        std::vector<slot> slots;
+        std::map<int, int> slotOf;  // key -> slot
+        std::set<int> pending;      // keys with a decode queued
+        int inFlight;
+        int generation;             // bumped when the cache is reallocated, stale decodes are dropped
+        long long frame;
+        float lastU;
+
+        std::vector<streamVertex> cached, coarse; // this frame's quads per texture
+
+        static int key(int l, int c, int r) { return (l<<24)|(r<<12)|c; }
+        std::string tileName(int, int, int);
+        int levelW(int l) { int w = width>>l; return w>0? w : 1; }
+        int levelH(int l) { int h = height>>l; return h>0? h : 1; }
+        int find(int);              // slot holding a tile or -1, marks it drawn this frame
+        void request(int, int, int);
+        void upload(int, const unsigned char *, int, int, int);
+        void flush(std::vector<streamVertex> &, GLuint);
+};
+
+#endif // _VIRTUALTEXTURE_H
@@ -12,6 +12,7 @@
 
 #include<_common.h>	// Header File For Windows
 #include<_scene.h>
+#include<string.h>
 
 using namespace std;
 
@@ -173,7 +174,7 @@ BOOL CreateGLWindow(char* title, int width, int height, int bits, bool fullscree
 		0,											// No Accumulation Buffer
 		0, 0, 0, 0,									// Accumulation Bits Ignored
 		16,											// 16Bit Z-Buffer (Depth Buffer)
-		0,											// No Stencil Buffer
+		8,											// 8Bit Stencil Buffer (Overdraw Debug View)
 		0,											// No Auxiliary Buffer
 		PFD_MAIN_PLANE,								// Main Drawing Layer
 		0,											// Reserved
@@ -275,13 +276,13 @@ LRESULT CALLBACK WndProc(	HWND	hWnd,			// Handle For This Window
 		case WM_KEYDOWN:							// Is A Key Being Held Down?
 		{
 			keys[wParam] = TRUE;					// If So, Mark It As TRUE
-			Scene->winMsg(hWnd,	uMsg,wParam,lParam);
+			if(Scene) Scene->winMsg(hWnd,	uMsg,wParam,lParam);
 			return 0;								// Jump Back
 		}
 
 		case WM_KEYUP:								// Has A Key Been Released?
 		{
-		    Scene->winMsg(hWnd,	uMsg,wParam,lParam);
+		    if(Scene) Scene->winMsg(hWnd,	uMsg,wParam,lParam);
 			keys[wParam] = FALSE;					// If So, Mark It As FALSE
 
 			return 0;								// Jump Back
@@ -289,7 +290,7 @@ LRESULT CALLBACK WndProc(	HWND	hWnd,			// Handle For This Window
 
 		case WM_SIZE:								// Resize The OpenGL Window
 		{
-            Scene->reSize(LOWORD(lParam),HIWORD(lParam));                                        // LoWord=Width, HiWord=Heigh
+            if(Scene) Scene->reSize(LOWORD(lParam),HIWORD(lParam));                                        // LoWord=Width, HiWord=Heigh
 			return 0;								// Jump Back
 		}
 
@@ -301,7 +302,7 @@ LRESULT CALLBACK WndProc(	HWND	hWnd,			// Handle For This Window
         case WM_MBUTTONUP:
         case WM_MOUSEMOVE:
         case WM_MOUSEWHEEL:
-            Scene->winMsg(hWnd,	uMsg,wParam,lParam);
+            if(Scene) Scene->winMsg(hWnd,	uMsg,wParam,lParam);
             break;
 
 	}
@@ -332,12 +333,27 @@ int WINAPI WinMain(	HINSTANCE	hInstance,			// Instance
 		fullscreen=FALSE;							// Windowed Mode
 	}
 
+	// -gltrace records the gl calls to trace.gltrace for tools/glreplay, f12 adds frames
+	if (strstr(lpCmdLine,"-gltrace")) _glTrace::open("trace.gltrace");
+
+	// -stats [file] writes draw, bind and upload counts for every frame, csv or .json
+	const char *stats = strstr(lpCmdLine,"-stats");
+	if (stats)
+	{
+		char statsFile[MAX_PATH] = "stats.csv";
+		if (sscanf(stats+6," %259s",statsFile)==1 && statsFile[0]=='-') strcpy(statsFile,"stats.csv"); // next flag, not a name
+		_renderStats::open(statsFile);
+	}
+
 	// Create Our OpenGL Window
 	if (!CreateGLWindow("Game Engine Lesson 01",fullscreenWidth,fullscreenHeight,256,fullscreen))
 	{
 		return 0;									// Quit If Window Was Not Created
 	}
 
+	// -loadbench decodes the startup images again on 1, 2, 4 ... workers and prints the times
+	if (strstr(lpCmdLine,"-loadbench")) Scene->loadBenchmark();
+
 	while(!done)									// Loop That Runs While done=FALSE
 	{
 		if (PeekMessage(&msg,NULL,0,0,PM_REMOVE))	// Is There A Message Waiting?
@@ -381,6 +397,11 @@ int WINAPI WinMain(	HINSTANCE	hInstance,			// Instance
 	}
 
 	// Shutdown
+	_glTrace::close();								// Write Out What Is Left Of The Trace
+	_renderStats::close();							// Per-State Totals On The Console
+	delete Scene;									// Releases Its Textures While The Context Is Current
+	Scene = nullptr;
+	_textureRegistry::report();						// Textures Still Alive At Exit
 	KillGLWindow();									// Kill The Window
 	return (msg.wParam);							// Exit The Program
 }
@@ -0,0 +1,171 @@
+#include "_assetpack.h"
+#include "_textureregistry.h"
+#include "_glcaps.h"
+#include <string.h>
+
+// offset+length within limit, without the sum overflowing on a garbage entry
+static bool inRange(uint64_t offset, uint64_t length, uint64_t limit)
+{
+    return offset<=limit && length<=limit-offset;
+}
+
+_assetPack::_assetPack()
+{
+    //ctor
+    base = nullptr;
+    size = 0;
+    count = 0;
+    entries = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+    mapping = NULL;
+}
+
+_assetPack::~_assetPack()
+{
+    //dtor
+    close();
+}
+
+bool _assetPack::open(const char *fileName)
+{
+    close();
+
+    fileHandle = CreateFile(fileName,GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+    if(fileHandle==INVALID_HANDLE_VALUE) return false; // no pack, everything loads from images/
+
+    LARGE_INTEGER length;
+    if(GetFileSizeEx(fileHandle,&length) && length.QuadPart>=(LONGLONG)sizeof(packHeader))
+    {
+        mapping = CreateFileMapping(fileHandle,NULL,PAGE_READONLY,0,0,NULL);
+        if(mapping) base = (const unsigned char*)MapViewOfFile(mapping,FILE_MAP_READ,0,0,0);
+    }
+    if(!base)
+    {
+        cout<<fileName<<": can't map it"<<endl;
+        close();
+        return false;
+    }
+    size = (uint64_t)length.QuadPart;
+
+    const packHeader *h = (const packHeader*)base;
+    if(h->magic!=PACK_MAGIC || h->version!=PACK_VERSION ||
+       h->indexOffset>size || (size-h->indexOffset)/sizeof(packEntry)<h->count)
+    {
+        cout<<fileName<<": not a version "<<PACK_VERSION<<" pack, rebake it with assetbake -pack"<<endl;
+        close();
+        return false;
+    }
+    count = h->count;
+    entries = (const packEntry*)(base+h->indexOffset);
+
+    cout<<fileName<<": "<<count<<" assets, "<<size/1024<<" KB mapped"<<endl;
+    return true;
+}
+
+void _assetPack::close()
+{
+    if(base) UnmapViewOfFile(base);
+    if(mapping) CloseHandle(mapping);
+    if(fileHandle!=INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+    base = nullptr;
+    mapping = NULL;
+    fileHandle = INVALID_HANDLE_VALUE;
+    size = 0;
+    count = 0;
+    entries = nullptr;
+}
+
+const packEntry *_assetPack::find(const char *fileName, int requested, bool mipmaps, const _spriteTrim *trim)
+{
+    if(!base) return nullptr;
+
+    std::string name = _textureRegistry::normalize(fileName);
+    for(uint32_t i=0; i<count; i++)
+    {
+        const packEntry &e = entries[i];
+        if(e.kind!=TEXTURE || strncmp(e.name,name.c_str(),PACK_NAME)) continue;
+        if(e.requested!=requested || (e.mipmaps!=0)!=mipmaps) continue;
+        if(trim? (e.framesX!=trim->framesX || e.framesY!=trim->framesY) : e.framesX!=0) continue;
+        if(!valid(e))
+        {
+            cout<<fileName<<": pack entry points outside the pack, loading the file instead (rebake the pack)"<<endl;
+            return nullptr;
+        }
+        return &e;
+    }
+    return nullptr;
+}
+
+bool _assetPack::valid(const packEntry &e)
+{
+    // a truncated or stale pack must not send an upload or a copy past the mapping
+    if(!inRange(e.offset,e.size,size) || e.levels<1 || e.levels>PACK_LEVELS) return false;
+    for(int i=0; i<e.levels; i++)
+        if(!inRange(e.levelOffset[i],e.levelSize[i],e.size)) return false;
+    if(e.paletteOffset && !inRange(e.paletteOffset,256*4,size)) return false;
+    if(e.trimOffset)
+    {
+        if(e.framesX<1 || e.framesY<1) return false;
+        if(!inRange(e.trimOffset,(uint64_t)e.framesX*e.framesY*sizeof(trimRect),size)) return false;
+    }
+    return true;
+}
+
+bool _assetPack::texture(const char *fileName, int requested, bool mipmaps, _spriteTrim *trim,
+                         packedTexture &out, const unsigned char *&blob)
+{
+    const packEntry *e = find(fileName,requested,mipmaps,trim);
+    if(!e) return false;
+
+    // same rules as a .dds next to the image, the source decodes instead when the driver can't take it
+    int texPath = _glCaps::paths[_glCaps::TEXTURES];
+    if((e->format==_textureLoader::TEX_BC1 || e->format==_textureLoader::TEX_BC3) && texPath==_glCaps::PATH_UNCOMPRESSED) return false;
+    if(e->format==_textureLoader::TEX_BC7 && texPath!=_glCaps::PATH_BPTC) return false;
+    if(e->format==_textureLoader::TEX_PALETTE8 && (!_glext::hasPalettedTexture || !e->paletteOffset)) return false;
+
+    out.fileName = fileName;
+    out.loadedFrom.clear();
+    out.format = e->format;
+    out.width = e->width;
+    out.height = e->height;
+    out.data.clear();
+    out.offsets.clear(); out.sizes.clear();
+    out.widths.clear(); out.heights.clear();
+    for(int i=0; i<e->levels; i++)
+    {
+        out.offsets.push_back((size_t)e->levelOffset[i]);
+        out.sizes.push_back((size_t)e->levelSize[i]);
+        out.widths.push_back(e->levelW[i]);
+        out.heights.push_back(e->levelH[i]);
+    }
+    out.palette.clear();
+    if(e->paletteOffset) out.palette.assign(base+e->paletteOffset,base+e->paletteOffset+256*4);
+    out.rgbaBytes = e->rgbaBytes;
+
+    if(trim && e->trimOffset)
+    {
+        const trimRect *r = (const trimRect*)(base+e->trimOffset);
+        trim->rects.assign(r,r+(size_t)e->framesX*e->framesY);
+        trim->fullArea = e->fullArea;
+        trim->trimmedArea = e->trimmedArea;
+    }
+
+    blob = base+e->offset;
+    return true;
+}
+
+bool _assetPack::file(const char *fileName, const char *&data, size_t &length)
+{
+    if(!base) return false;
+
+    std::string name = _textureRegistry::normalize(fileName);
+    for(uint32_t i=0; i<count; i++)
+    {
+        const packEntry &e = entries[i];
+        if(e.kind!=RAW || strncmp(e.name,name.c_str(),PACK_NAME) || !inRange(e.offset,e.size,size)) continue;
+        data = (const char*)(base+e.offset);
+        length = (size_t)e.size;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,133 @@
+#include "_assetvariants.h"
+#include "_textureregistry.h"
+#include <fstream>
+#include <sstream>
+
+_assetVariants::_assetVariants(_uploadQueue *q)
+{
+    //ctor
+    uploads = q;
+    swaps = 0;
+}
+
+_assetVariants::~_assetVariants()
+{
+    //dtor
+    for(tracked *t : textures) delete t;
+    textures.clear();
+}
+
+const std::vector<textureVariant> &_assetVariants::variants(const char *source)
+{
+    auto it = manifests.find(source);
+    if(it!=manifests.end()) return it->second;
+
+    std::vector<textureVariant> &list = manifests[source];
+
+    // images/help.png -> images/help.variants, entries are relative to images/
+    std::string src = source;
+    size_t slash = src.find_last_of("/\\");
+    size_t dot = src.find_last_of('.');
+    std::string dir = (slash==std::string::npos)? "" : src.substr(0,slash+1);
+    std::string stem = (dot==std::string::npos || (slash!=std::string::npos && dot<slash))? src : src.substr(0,dot);
+
+    std::ifstream file((stem+".variants").c_str());
+    std::string line;
+    while(std::getline(file,line))
+    {
+        if(line.empty() || line[0]=='#') continue;
+
+        std::istringstream ss(line);
+        textureVariant v;
+        std::string name;
+        if(ss>>v.width>>v.height>>name && v.width>0 && v.height>0)
+        {
+            v.path = dir+name;
+            list.push_back(v);
+        }
+    }
+    return list;
+}
+
+std::string _assetVariants::pick(const char *source, int w, int h)
+{
+    const std::vector<textureVariant> &list = variants(source);
+    if(list.empty()) return source;
+
+    // smallest copy with at least one texel per pixel, or the biggest one there is
+    const textureVariant *best = nullptr, *largest = nullptr;
+    for(const textureVariant &v : list)
+    {
+        long long area = (long long)v.width*v.height;
+        if(!largest || area>(long long)largest->width*largest->height) largest = &v;
+        if(v.width>=w && v.height>=h && (!best || area<(long long)best->width*best->height)) best = &v;
+    }
+    return best? best->path : largest->path;
+}
+
+void _assetVariants::load(const char *source, int w, int h, GLuint *tex, int format)
+{
+    // tracked even without a manifest, resize() then never finds anything better
+    tracked *t = new tracked;
+    t->source = source;
+    t->current = pick(source,w,h);
+    t->tex = tex;
+    t->format = format;
+    t->generation = 0;
+    textures.push_back(t);
+    swap(t);
+}
+
+void _assetVariants::track(const char *source, const std::string &loaded, GLuint *tex, int format)
+{
+    if(variants(source).empty()) return; // nothing to swap between
+
+    tracked *t = new tracked;
+    t->source = source;
+    t->current = loaded;
+    t->tex = tex;
+    t->format = format;
+    t->generation = 0;
+    textures.push_back(t);
+}
+
+void _assetVariants::swap(tracked *t)
+{
+    int generation = ++t->generation;
+    std::string want = t->current;
+
+    // decoded and uploaded off the frame path, swapped in once the upload has landed
+    uploads->load(want,t->format,false,[this, t, generation, want](GLuint tex)
+    {
+        if(generation!=t->generation) // resized again since, a newer upload is coming
+        {
+            _textureRegistry::release(tex);
+            return;
+        }
+        if(!tex)
+        {
+            cout<<want<<": variant failed to load, keeping the old one"<<endl;
+            return;
+        }
+
+        if(*t->tex)
+        {
+            _textureRegistry::release(*t->tex);
+            swaps++;
+        }
+        *t->tex = tex;
+    });
+}
+
+void _assetVariants::resize(int w, int h)
+{
+    for(tracked *t : textures)
+    {
+        std::string want = pick(t->source.c_str(),w,h);
+        if(want==t->current) continue;
+
+        cout<<t->source<<": "<<w<<"x"<<h<<" wants "<<want<<", loading in the background"<<endl;
+        t->current = want;
+        swap(t);
+    }
+}
@@ -69,7 +69,7 @@ void _bullets::bActions()
     {
         case IDLE: bLive=false; break; //idle
         case SHOOT: bLive=true; break; //shoot
-        case HIT: bLive=false;  // TODO : explosion and reset
+        case HIT: bLive=false; actionTrigger=IDLE; // explosion is spawned by the scene
         break; //hit
     }
 }
@@ -80,25 +80,40 @@ void _bullets::drawBullet(GLuint TX)
 
 
     if(bLive){
-       glTranslatef(bPos.x,bPos.y,bPos.z);
-       glScalef(bScale.x,bScale.y,bScale.z);
-
-       glRotatef(bRot.x,1,0,0);
-       glRotatef(bRot.y,0,1,0);
-       glRotatef(bRot.z,0,0,1);
+       if(graph && node>=0)
+       {
+         glMultMatrixf(graph->world[node]); // cached, rebuilt only when the bullet moves
+       }
+       else
+       {
+         glTranslatef(bPos.x,bPos.y,bPos.z);
+         glScalef(bScale.x,bScale.y,bScale.z);
+
+         glRotatef(bRot.x,1,0,0);
+         glRotatef(bRot.y,0,1,0);
+         glRotatef(bRot.z,0,0,1);
+       }
 
        glBindTexture(GL_TEXTURE_2D,TX);
 
-       glBegin(GL_QUADS);
-         glTexCoord2f(xMin,yMax);
-         glVertex3f(-1,-1,0);
-         glTexCoord2f(xMax,yMax);
-         glVertex3f( 1,-1,0);
-         glTexCoord2f(xMax,yMin);
-         glVertex3f( 1,1,0);
-         glTexCoord2f(xMin,yMin);
-         glVertex3f(-1,1,0);
-       glEnd();
+       // trimmed to the visible texels of the image
+       trimRect r = {0,0,1,1};
+       if(trim) r = trim->frame(xMin,yMin);
+       float u0 = xMin+r.x0*(xMax-xMin), u1 = xMin+r.x1*(xMax-xMin);
+       float v0 = yMin+r.y0*(yMax-yMin), v1 = yMin+r.y1*(yMax-yMin);
+       float x0 = -1+2*r.x0, x1 = -1+2*r.x1;
+       float y0 =  1-2*r.y0, y1 =  1-2*r.y1;
+
+       streamSpan s = stream->alloc(_glCaps::SPRITES,4,sizeof(streamVertex));
+       if(s.ptr)
+       {
+         streamVertex *q = (streamVertex*)s.ptr;
+         streamPut(&q[0],x0,y1,0,u0,v1);
+         streamPut(&q[1],x1,y1,0,u1,v1);
+         streamPut(&q[2],x1,y0,0,u1,v0);
+         streamPut(&q[3],x0,y0,0,u0,v0);
+         stream->draw(s,GL_QUADS,4);
+       }
     }
     glPopMatrix();
 }
@@ -0,0 +1,211 @@
+#include "_capture.h"
+#include "_timer.h"
+#include <stdio.h>
+#include <memory>
+#include <vector>
+
+_capture::_capture(_jobQueue *q)
+{
+    //ctor
+    jobs = q;
+    recording = false;
+    frames = dropped = 0;
+    renderMs = 0;
+
+    for(int i=0; i<CAPTURE_SLOTS; i++)
+    {
+        slots[i].pbo = 0;
+        slots[i].fence = 0;
+        slots[i].state = FREE;
+        slots[i].width = slots[i].height = 0;
+        slots[i].sequence = 0;
+        slots[i].issuedFrame = 0;
+    }
+    frameCount = 0;
+    sequence = 0;
+    shots = take = 0;
+    shotPending = false;
+}
+
+_capture::~_capture()
+{
+    //dtor
+    // the job queue is gone by now, so nothing is still writing from a mapping
+    for(int i=0; i<CAPTURE_SLOTS; i++)
+    {
+        if(slots[i].fence) _glext::DeleteSync(slots[i].fence);
+        if(slots[i].pbo) _glext::DeleteBuffers(1,&slots[i].pbo); // unmaps it too
+    }
+}
+
+void _capture::initCapture()
+{
+    if(_glCaps::paths[_glCaps::CAPTURE]!=_glCaps::PATH_PBO) return;
+
+    for(int i=0; i<CAPTURE_SLOTS; i++) _glext::GenBuffers(1,&slots[i].pbo);
+}
+
+void _capture::screenshot()
+{
+    shotPending = true;
+}
+
+void _capture::toggleRecording()
+{
+    recording = !recording;
+    if(recording)
+    {
+        take++;
+        frames = dropped = 0;
+        renderMs = 0;
+        cout<<"capture: recording take "<<take<<" ("<<_glCaps::pathName(_glCaps::CAPTURE)<<")"<<endl;
+        return;
+    }
+
+    cout<<"capture: take "<<take<<", "<<frames<<" frames, "<<dropped<<" dropped, "
+        <<(frames? renderMs/frames : 0)<<" ms per frame on the render thread"<<endl;
+    printf("capture: ffmpeg -framerate 60 -i capture_%03d_%%05d.tga capture_%03d.mp4\n",take,take);
+    fflush(stdout);
+}
+
+bool _capture::writeTGA(const std::string &fileName, int w, int h, const unsigned char *bgra)
+{
+    // uncompressed true color, bottom-up rows like glReadPixels, no alpha bits so the cleared alpha is ignored
+    unsigned char header[18] = {0};
+    header[2] = 2;
+    header[12] = w & 0xFF; header[13] = (w>>8) & 0xFF;
+    header[14] = h & 0xFF; header[15] = (h>>8) & 0xFF;
+    header[16] = 32;
+
+    FILE *f = fopen(fileName.c_str(),"wb");
+    if(!f) return false;
+    bool ok = fwrite(header,1,sizeof(header),f)==sizeof(header)
+           && fwrite(bgra,4,(size_t)w*h,f)==(size_t)w*h;
+    fclose(f);
+    return ok;
+}
+
+void _capture::release(slot *s)
+{
+    _glext::BindBuffer(GL_PIXEL_PACK_BUFFER,s->pbo);
+    _glext::UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    _glext::BindBuffer(GL_PIXEL_PACK_BUFFER,0);
+    s->state = FREE;
+}
+
+void _capture::collect()
+{
+    // oldest first, so frames of a take reach the worker in order
+    for(;;)
+    {
+        slot *s = nullptr;
+        for(int i=0; i<CAPTURE_SLOTS; i++)
+            if(slots[i].state==READING && (!s || slots[i].sequence<s->sequence)) s = &slots[i];
+        if(!s) return;
+
+        if(s->fence)
+        {
+            GLenum r = _glext::ClientWaitSync(s->fence,0,0);
+            if(r!=GL_ALREADY_SIGNALED && r!=GL_CONDITION_SATISFIED) return;
+            _glext::DeleteSync(s->fence);
+            s->fence = 0;
+        }
+        else if(frameCount-s->issuedFrame < CAPTURE_DELAY) return;
+
+        GLsizeiptr size = (GLsizeiptr)s->width*s->height*4;
+        _glext::BindBuffer(GL_PIXEL_PACK_BUFFER,s->pbo);
+        const unsigned char *pixels = (const unsigned char*)(_glext::hasMapBufferRange?
+            _glext::MapBufferRange(GL_PIXEL_PACK_BUFFER,0,size,GL_MAP_READ_BIT) :
+            _glext::MapBuffer(GL_PIXEL_PACK_BUFFER,GL_READ_ONLY));
+        _glext::BindBuffer(GL_PIXEL_PACK_BUFFER,0);
+
+        if(!pixels)
+        {
+            cout<<"capture: could not map "<<s->fileName<<endl;
+            s->state = FREE;
+            continue;
+        }
+
+        // the mapping stays valid until release(), the worker only reads it
+        s->state = WRITING;
+        std::string name = s->fileName;
+        int w = s->width, h = s->height;
+        jobs->push([name, w, h, pixels]() {
+                        if(!writeTGA(name,w,h,pixels)) cout<<"capture: could not write "<<name<<endl;
+                    },
+                    [this, s]() { release(s); });
+    }
+}
+
+bool _capture::issue(int w, int h, const std::string &fileName)
+{
+    if(_glCaps::paths[_glCaps::CAPTURE]!=_glCaps::PATH_PBO)
+    {
+        // no pack buffers, read straight back and eat the stall
+        std::shared_ptr<std::vector<unsigned char> > pixels(new std::vector<unsigned char>((size_t)w*h*4));
+        glPixelStorei(GL_PACK_ALIGNMENT,4);
+        glReadPixels(0,0,w,h,GL_BGRA,GL_UNSIGNED_BYTE,&(*pixels)[0]);
+        jobs->push([fileName, w, h, pixels]() {
+                       if(!writeTGA(fileName,w,h,&(*pixels)[0])) cout<<"capture: could not write "<<fileName<<endl;
+                   });
+        return true;
+    }
+
+    slot *s = nullptr;
+    for(int i=0; i<CAPTURE_SLOTS && !s; i++)
+        if(slots[i].state==FREE) s = &slots[i];
+    if(!s) return false; // the worker is behind, the disk usually
+
+    _glext::BindBuffer(GL_PIXEL_PACK_BUFFER,s->pbo);
+    if(s->width!=w || s->height!=h)
+    {
+        _glext::BufferData(GL_PIXEL_PACK_BUFFER,(GLsizeiptr)w*h*4,nullptr,GL_STREAM_READ);
+        s->width = w;
+        s->height = h;
+    }
+    // bgra is what the back buffer holds, so the copy is a plain dma into the buffer
+    glPixelStorei(GL_PACK_ALIGNMENT,4);
+    glReadPixels(0,0,w,h,GL_BGRA,GL_UNSIGNED_BYTE,0);
+    _glext::BindBuffer(GL_PIXEL_PACK_BUFFER,0);
+
+    if(_glext::hasSync) s->fence = _glext::FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+    s->state = READING;
+    s->sequence = sequence++;
+    s->issuedFrame = frameCount;
+    s->fileName = fileName;
+    return true;
+}
+
+void _capture::frame(int w, int h)
+{
+    frameCount++;
+
+    bool busy = false;
+    for(int i=0; i<CAPTURE_SLOTS; i++)
+        if(slots[i].state==READING) busy = true;
+    if(!recording && !shotPending && !busy) return;
+    if(w<=0 || h<=0) return;
+
+    double start = _timer::nowMs();
+    collect();
+
+    char name[64];
+    if(shotPending)
+    {
+        sprintf(name,"screenshot_%03d.tga",shots+1);
+        if(issue(w,h,name))
+        {
+            shots++;
+            shotPending = false;
+            cout<<"capture: "<<name<<endl;
+        }
+    }
+    if(recording)
+    {
+        sprintf(name,"capture_%03d_%05lld.tga",take,frames+1);
+        if(issue(w,h,name)) frames++;
+        else                dropped++;
+    }
+
+    if(recording) renderMs += _timer::nowMs()-start;
+}
@@ -0,0 +1,388 @@
+#include "_dxt.h"
+#include <stdio.h>
+#include <string.h>
+
+// dds header fields used here, everything else is written as zero
+enum
+{
+    DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PIXELFORMAT = 0x1000,
+    DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000,
+    DDPF_FOURCC = 0x4,
+    DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000,
+    DXGI_BC1_UNORM = 71, DXGI_BC3_UNORM = 77, DXGI_BC7_UNORM = 98, DXGI_BC7_UNORM_SRGB = 99
+};
+
+static const unsigned int FOURCC_DXT1 = 0x31545844; // "DXT1"
+static const unsigned int FOURCC_DXT5 = 0x35545844; // "DXT5"
+static const unsigned int FOURCC_DX10 = 0x30315844; // "DX10"
+
+static unsigned int readU32(const unsigned char *p)
+{
+    return p[0] | (p[1]<<8) | (p[2]<<16) | ((unsigned int)p[3]<<24);
+}
+
+static void writeU32(unsigned char *p, unsigned int v)
+{
+    p[0] = v&0xff; p[1] = (v>>8)&0xff; p[2] = (v>>16)&0xff; p[3] = (v>>24)&0xff;
+}
+
+size_t _dxt::levelSize(int format, int w, int h)
+{
+    size_t blocks = (size_t)((w+3)/4) * ((h+3)/4);
+    return blocks * (format==BC1? 8 : 16);
+}
+
+bool _dxt::loadDDS(const char *fileName, image &img)
+{
+    FILE *fp = fopen(fileName,"rb");
+    if(!fp) return false;
+
+    fseek(fp,0,SEEK_END);
+    long fileSize = ftell(fp);
+    fseek(fp,0,SEEK_SET);
+
+    std::vector<unsigned char> file(fileSize>0? fileSize : 0);
+    bool ok = fileSize>=128 && fread(&file[0],1,fileSize,fp)==(size_t)fileSize;
+    fclose(fp);
+    if(!ok || memcmp(&file[0],"DDS ",4)!=0 || readU32(&file[4])!=124) return false;
+
+    const unsigned char *hdr = &file[4];
+    int height  = (int)readU32(hdr+8);
+    int width   = (int)readU32(hdr+12);
+    int mips    = (readU32(hdr+4)&DDSD_MIPMAPCOUNT)? (int)readU32(hdr+24) : 1;
+    const unsigned char *pf = hdr+72;
+    if(!(readU32(pf+4)&DDPF_FOURCC)) return false; // uncompressed dds isn't worth a path of its own
+
+    size_t offset = 128;
+    unsigned int fourCC = readU32(pf+8);
+    if(fourCC==FOURCC_DXT1) img.format = BC1;
+    else if(fourCC==FOURCC_DXT5) img.format = BC3;
+    else if(fourCC==FOURCC_DX10 && fileSize>=148)
+    {
+        unsigned int dxgi = readU32(&file[128]);
+        offset = 148;
+        if(dxgi==DXGI_BC1_UNORM) img.format = BC1;
+        else if(dxgi==DXGI_BC3_UNORM) img.format = BC3;
+        else if(dxgi==DXGI_BC7_UNORM || dxgi==DXGI_BC7_UNORM_SRGB) img.format = BC7;
+        else return false;
+    }
+    else return false;
+
+    if(width<=0 || height<=0) return false;
+    if(mips<1) mips = 1;
+
+    img.width = width;
+    img.height = height;
+    img.levels.clear();
+
+    size_t pos = 0;
+    int w = width, h = height;
+    for(int i=0; i<mips; i++)
+    {
+        level lv = {w, h, pos, levelSize(img.format,w,h)};
+        if(offset+pos+lv.size>(size_t)fileSize) break; // truncated chain, keep the levels that are there
+        img.levels.push_back(lv);
+        pos += lv.size;
+
+        if(w==1 && h==1) break;
+        w = w>1? w/2 : 1;
+        h = h>1? h/2 : 1;
+    }
+    if(img.levels.empty()) return false;
+
+    img.data.assign(file.begin()+offset, file.begin()+offset+pos);
+    return true;
+}
+
+bool _dxt::saveDDS(const char *fileName, const image &img)
+{
+    if(img.levels.empty() || img.format==NONE) return false;
+
+    unsigned char hdr[148] = {0};
+    memcpy(hdr,"DDS ",4);
+
+    unsigned char *h = hdr+4;
+    unsigned int flags = DDSD_CAPS|DDSD_HEIGHT|DDSD_WIDTH|DDSD_PIXELFORMAT|DDSD_LINEARSIZE;
+    unsigned int caps = DDSCAPS_TEXTURE;
+    if(img.levels.size()>1)
+    {
+        flags |= DDSD_MIPMAPCOUNT;
+        caps |= DDSCAPS_COMPLEX|DDSCAPS_MIPMAP;
+    }
+
+    writeU32(h+0,124);
+    writeU32(h+4,flags);
+    writeU32(h+8,img.height);
+    writeU32(h+12,img.width);
+    writeU32(h+16,(unsigned int)img.levels[0].size);
+    writeU32(h+24,(unsigned int)img.levels.size());
+    writeU32(h+72,32);
+    writeU32(h+76,DDPF_FOURCC);
+    writeU32(h+104,caps);
+
+    size_t hdrSize = 128;
+    if(img.format==BC1) writeU32(h+80,FOURCC_DXT1);
+    else if(img.format==BC3) writeU32(h+80,FOURCC_DXT5);
+    else
+    {
+        // bc7 only exists in the dx10 extension header
+        writeU32(h+80,FOURCC_DX10);
+        writeU32(hdr+128,DXGI_BC7_UNORM);
+        writeU32(hdr+132,3); // texture2d
+        writeU32(hdr+140,1); // array size
+        hdrSize = 148;
+    }
+
+    FILE *fp = fopen(fileName,"wb");
+    if(!fp) return false;
+
+    bool ok = fwrite(hdr,1,hdrSize,fp)==hdrSize;
+    if(ok && !img.data.empty()) ok = fwrite(&img.data[0],1,img.data.size(),fp)==img.data.size();
+    fclose(fp);
+    return ok;
+}
+
+// ---- encoder ----
+
+// 4x4 texels starting at bx,by, rows past the edge repeat the last texel
+static void fetchBlock(const unsigned char *rgba, int w, int h, int bx, int by, unsigned char *block)
+{
+    for(int y=0; y<4; y++)
+        for(int x=0; x<4; x++)
+        {
+            int sx = bx+x<w? bx+x : w-1;
+            int sy = by+y<h? by+y : h-1;
+            memcpy(block+(y*4+x)*4, rgba+((size_t)sy*w+sx)*4, 4);
+        }
+}
+
+static unsigned short pack565(const unsigned char *c)
+{
+    return (unsigned short)(((c[0]*31+127)/255)<<11 | ((c[1]*63+127)/255)<<5 | ((c[2]*31+127)/255));
+}
+
+static void unpack565(unsigned short v, unsigned char *c)
+{
+    int r = (v>>11)&31, g = (v>>5)&63, b = v&31;
+    c[0] = (unsigned char)((r<<3)|(r>>2));
+    c[1] = (unsigned char)((g<<2)|(g>>4));
+    c[2] = (unsigned char)((b<<3)|(b>>2));
+}
+
+// endpoints from the extremes along the block's principal axis, then nearest palette entry per texel
+static void encodeColor(const unsigned char *block, unsigned char *out)
+{
+    float mean[3] = {0,0,0};
+    for(int i=0; i<16; i++)
+        for(int c=0; c<3; c++) mean[c] += block[i*4+c];
+    for(int c=0; c<3; c++) mean[c] /= 16.0f;
+
+    float cov[6] = {0,0,0,0,0,0}; // rr rg rb gg gb bb
+    for(int i=0; i<16; i++)
+    {
+        float r = block[i*4]-mean[0], g = block[i*4+1]-mean[1], b = block[i*4+2]-mean[2];
+        cov[0] += r*r; cov[1] += r*g; cov[2] += r*b;
+        cov[3] += g*g; cov[4] += g*b; cov[5] += b*b;
+    }
+
+    // a few power iterations are plenty for a 3x3 matrix
+    float axis[3] = {1,1,1};
+    for(int it=0; it<4; it++)
+    {
+        float x = cov[0]*axis[0] + cov[1]*axis[1] + cov[2]*axis[2];
+        float y = cov[1]*axis[0] + cov[3]*axis[1] + cov[4]*axis[2];
+        float z = cov[2]*axis[0] + cov[4]*axis[1] + cov[5]*axis[2];
+        float m = x>y? x : y;
+        if(z>m) m = z;
+        if(-x>m) m = -x;
+        if(-y>m) m = -y;
+        if(-z>m) m = -z;
+        if(m<1e-6f) break; // flat block, any axis will do
+        axis[0] = x/m; axis[1] = y/m; axis[2] = z/m;
+    }
+
+    int lo = 0, hi = 0;
+    float minP = 1e30f, maxP = -1e30f;
+    for(int i=0; i<16; i++)
+    {
+        float p = block[i*4]*axis[0] + block[i*4+1]*axis[1] + block[i*4+2]*axis[2];
+        if(p<minP) { minP = p; lo = i; }
+        if(p>maxP) { maxP = p; hi = i; }
+    }
+
+    unsigned short c0 = pack565(block+hi*4);
+    unsigned short c1 = pack565(block+lo*4);
+    if(c0<c1) { unsigned short t = c0; c0 = c1; c1 = t; } // c0>c1 selects four color mode
+
+    out[0] = c0&0xff; out[1] = c0>>8;
+    out[2] = c1&0xff; out[3] = c1>>8;
+
+    unsigned int bits = 0;
+    if(c0!=c1)
+    {
+        unsigned char pal[4][3];
+        unpack565(c0,pal[0]);
+        unpack565(c1,pal[1]);
+        for(int c=0; c<3; c++)
+        {
+            pal[2][c] = (unsigned char)((2*pal[0][c]+pal[1][c])/3);
+            pal[3][c] = (unsigned char)((pal[0][c]+2*pal[1][c])/3);
+        }
+
+        for(int i=0; i<16; i++)
+        {
+            int best = 0, bestD = 1<<30;
+            for(int k=0; k<4; k++)
+            {
+                int dr = block[i*4]-pal[k][0], dg = block[i*4+1]-pal[k][1], db = block[i*4+2]-pal[k][2];
+                int d = dr*dr + dg*dg + db*db;
+                if(d<bestD) { bestD = d; best = k; }
+            }
+            bits |= (unsigned int)best<<(i*2);
+        }
+    }
+    writeU32(out+4,bits);
+}
+
+static void encodeAlpha(const unsigned char *block, unsigned char *out)
+{
+    int a0 = 0, a1 = 255;
+    for(int i=0; i<16; i++)
+    {
+        int a = block[i*4+3];
+        if(a>a0) a0 = a;
+        if(a<a1) a1 = a;
+    }
+    out[0] = (unsigned char)a0;
+    out[1] = (unsigned char)a1;
+
+    unsigned long long bits = 0;
+    if(a0!=a1)
+    {
+        // a0>a1 selects the eight value ramp
+        int pal[8] = {a0, a1};
+        for(int k=1; k<7; k++) pal[k+1] = ((7-k)*a0 + k*a1)/7;
+
+        for(int i=0; i<16; i++)
+        {
+            int best = 0, bestD = 1<<30;
+            for(int k=0; k<8; k++)
+            {
+                int d = block[i*4+3]-pal[k];
+                if(d<0) d = -d;
+                if(d<bestD) { bestD = d; best = k; }
+            }
+            bits |= (unsigned long long)best<<(i*3);
+        }
+    }
+    for(int i=0; i<6; i++) out[2+i] = (unsigned char)(bits>>(i*8));
+}
+
+void _dxt::encodeBC1(const unsigned char *rgba, int w, int h, unsigned char *out)
+{
+    unsigned char block[64];
+    for(int by=0; by<h; by+=4)
+        for(int bx=0; bx<w; bx+=4)
+        {
+            fetchBlock(rgba,w,h,bx,by,block);
+            encodeColor(block,out);
+            out += 8;
+        }
+}
+
+void _dxt::encodeBC3(const unsigned char *rgba, int w, int h, unsigned char *out)
+{
+    unsigned char block[64];
+    for(int by=0; by<h; by+=4)
+        for(int bx=0; bx<w; bx+=4)
+        {
+            fetchBlock(rgba,w,h,bx,by,block);
+            encodeAlpha(block,out);
+            encodeColor(block,out+8);
+            out += 16;
+        }
+}
+
+// ---- decoder ----
+
+static void decodeColor(const unsigned char *in, bool fourColor, unsigned char *block)
+{
+    unsigned short c0 = in[0] | (in[1]<<8);
+    unsigned short c1 = in[2] | (in[3]<<8);
+
+    unsigned char pal[4][4];
+    unpack565(c0,pal[0]);
+    unpack565(c1,pal[1]);
+    pal[0][3] = pal[1][3] = pal[2][3] = pal[3][3] = 255;
+
+    if(fourColor || c0>c1)
+        for(int c=0; c<3; c++)
+        {
+            pal[2][c] = (unsigned char)((2*pal[0][c]+pal[1][c])/3);
+            pal[3][c] = (unsigned char)((pal[0][c]+2*pal[1][c])/3);
+        }
+    else
+    {
+        // bc1 three color mode, the last entry is transparent black
+        for(int c=0; c<3; c++)
+        {
+            pal[2][c] = (unsigned char)((pal[0][c]+pal[1][c])/2);
+            pal[3][c] = 0;
+        }
+        pal[3][3] = 0;
+    }
+
+    unsigned int bits = readU32(in+4);
+    for(int i=0; i<16; i++)
+        memcpy(block+i*4, pal[(bits>>(i*2))&3], 4);
+}
+
+static void decodeAlpha(const unsigned char *in, unsigned char *block)
+{
+    int a0 = in[0], a1 = in[1];
+    int pal[8] = {a0, a1};
+    if(a0>a1)
+        for(int k=1; k<7; k++) pal[k+1] = ((7-k)*a0 + k*a1)/7;
+    else
+    {
+        for(int k=1; k<5; k++) pal[k+1] = ((5-k)*a0 + k*a1)/5;
+        pal[6] = 0;
+        pal[7] = 255;
+    }
+
+    unsigned long long bits = 0;
+    for(int i=0; i<6; i++) bits |= (unsigned long long)in[2+i]<<(i*8);
+    for(int i=0; i<16; i++)
+        block[i*4+3] = (unsigned char)pal[(bits>>(i*3))&7];
+}
+
+bool _dxt::decode(const image &img, int lv, unsigned char *rgba)
+{
+    if(lv<0 || lv>=(int)img.levels.size()) return false;
+    if(img.format!=BC1 && img.format!=BC3) return false;
+
+    const level &l = img.levels[lv];
+    const unsigned char *in = &img.data[l.offset];
+    unsigned char block[64];
+
+    for(int by=0; by<l.height; by+=4)
+        for(int bx=0; bx<l.width; bx+=4)
+        {
+            if(img.format==BC1)
+            {
+                decodeColor(in,false,block);
+                in += 8;
+            }
+            else
+            {
+                decodeColor(in+8,true,block);
+                decodeAlpha(in,block);
+                in += 16;
+            }
+
+            for(int y=0; y<4 && by+y<l.height; y++)
+                for(int x=0; x<4 && bx+x<l.width; x++)
+                    memcpy(rgba+((size_t)(by+y)*l.width+bx+x)*4, block+(y*4+x)*4, 4);
+        }
+    return true;
+}
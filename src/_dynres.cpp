@@ -0,0 +1,167 @@
+#include "_dynres.h"
+#include "_timer.h"
+#include "_glcaps.h"
+
+_dynRes::_dynRes()
+{
+    //ctor
+    enabled = true;
+    scale = 1.0;
+    minScale = 0.5;
+    maxScale = 1.0;
+    step = 0.05;
+    budgetMs = 1000.0/60.0;
+    avgMs = budgetMs;
+
+    texW = texH = 0;
+    rtW = rtH = 0;
+    fbo = colorTex = depthRb = 0;
+
+    lastChange = 0;
+    active = false;
+    scissorWas = GL_FALSE;
+    scissorBox[0] = scissorBox[1] = scissorBox[2] = scissorBox[3] = 0;
+}
+
+_dynRes::~_dynRes()
+{
+    //dtor
+    freeTarget();
+}
+
+void _dynRes::frameTime(double ms)
+{
+    // ignore hitches like window drags so one bad frame doesn't drop the resolution
+    if(ms > 250.0) return;
+
+    avgMs = avgMs*0.9 + ms*0.1;
+
+    double now = _timer::nowMs();
+    if(now-lastChange < 250.0) return;
+
+    // wide gap between the two thresholds so work hovering around the budget stays put
+    if(avgMs > budgetMs*1.05 && scale > minScale)
+    {
+        scale -= step;
+        if(scale < minScale) scale = minScale;
+        lastChange = now;
+    }
+    else if(avgMs < budgetMs*0.85 && scale < maxScale)
+    {
+        scale += step;
+        if(scale > maxScale) scale = maxScale;
+        lastChange = now;
+    }
+}
+
+bool _dynRes::allocTarget(int w, int h)
+{
+    freeTarget();
+
+    // the target is window sized once, lower scales just use a corner of it
+    glGenTextures(1,&colorTex);
+    glBindTexture(GL_TEXTURE_2D,colorTex);
+    glTexImage2D(GL_TEXTURE_2D,0,GL_RGB8,w,h,0,GL_RGB,GL_UNSIGNED_BYTE,NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D,0);
+
+    _glext::GenRenderbuffers(1,&depthRb);
+    _glext::BindRenderbuffer(GL_RENDERBUFFER_EXT,depthRb);
+    _glext::RenderbufferStorage(GL_RENDERBUFFER_EXT,GL_DEPTH_COMPONENT24,w,h);
+    _glext::BindRenderbuffer(GL_RENDERBUFFER_EXT,0);
+
+    _glext::GenFramebuffers(1,&fbo);
+    _glext::BindFramebuffer(GL_FRAMEBUFFER_EXT,fbo);
+    _glext::FramebufferTexture2D(GL_FRAMEBUFFER_EXT,GL_COLOR_ATTACHMENT0_EXT,GL_TEXTURE_2D,colorTex,0);
+    _glext::FramebufferRenderbuffer(GL_FRAMEBUFFER_EXT,GL_DEPTH_ATTACHMENT_EXT,GL_RENDERBUFFER_EXT,depthRb);
+    GLenum status = _glext::CheckFramebufferStatus(GL_FRAMEBUFFER_EXT);
+    _glext::BindFramebuffer(GL_FRAMEBUFFER_EXT,0);
+
+    if(status != GL_FRAMEBUFFER_COMPLETE_EXT)
+    {
+        cout<<"dynamic resolution: framebuffer incomplete, rendering at native size"<<endl;
+        freeTarget();
+        enabled = false;
+        return false;
+    }
+
+    texW = w;
+    texH = h;
+    return true;
+}
+
+void _dynRes::freeTarget()
+{
+    if(fbo)      _glext::DeleteFramebuffers(1,&fbo);
+    if(depthRb)  _glext::DeleteRenderbuffers(1,&depthRb);
+    if(colorTex) glDeleteTextures(1,&colorTex);
+    fbo = depthRb = colorTex = 0;
+    texW = texH = 0;
+}
+
+bool _dynRes::begin(int w, int h)
+{
+    active = false;
+    if(!enabled || _glCaps::paths[_glCaps::OFFSCREEN]!=_glCaps::PATH_FBO || w<=0 || h<=0) return false;
+
+    if((w!=texW || h!=texH) && !allocTarget(w,h)) return false;
+
+    rtW = (int)(w*scale);
+    rtH = (int)(h*scale);
+    if(rtW<1) rtW = 1;
+    if(rtH<1) rtH = 1;
+
+    _glext::BindFramebuffer(GL_FRAMEBUFFER_EXT,fbo);
+    glViewport(0,0,rtW,rtH); // same aspect as the window so the projection is unchanged
+
+    // the viewport doesn't limit glClear, without the scissor the clear fills the whole window sized target
+    scissorWas = glIsEnabled(GL_SCISSOR_TEST);
+    glGetIntegerv(GL_SCISSOR_BOX,scissorBox);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(0,0,rtW,rtH);
+    active = true;
+    return true;
+}
+
+void _dynRes::end(int w, int h)
+{
+    if(!active) return;
+
+    _glext::BindFramebuffer(GL_FRAMEBUFFER_EXT,0);
+    glViewport(0,0,w,h);
+
+    glScissor(scissorBox[0],scissorBox[1],scissorBox[2],scissorBox[3]);
+    if(!scissorWas) glDisable(GL_SCISSOR_TEST);
+}
+
+void _dynRes::present(int w, int h)
+{
+    if(!active) return;
+    active = false;
+
+    float u = (float)rtW/texW;
+    float v = (float)rtH/texH;
+
+    glPushAttrib(GL_ENABLE_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glEnable(GL_TEXTURE_2D);
+
+    glColor3f(1.0,1.0,1.0);
+    glBindTexture(GL_TEXTURE_2D,colorTex);
+
+    // ortho is top-left origin, the render target is bottom-left
+    glBegin(GL_QUADS);
+        glTexCoord2f(0,v); glVertex2f(0,0);
+        glTexCoord2f(u,v); glVertex2f(w,0);
+        glTexCoord2f(u,0); glVertex2f(w,h);
+        glTexCoord2f(0,0); glVertex2f(0,h);
+    glEnd();
+
+    glBindTexture(GL_TEXTURE_2D,0);
+    glPopAttrib();
+}
@@ -22,11 +22,12 @@ _enms::_enms()
 _enms::~_enms()
 {
     //dtor
+    _textureRegistry::release(tex);
 }
 void _enms::initEnms(char* fileName)
 {
-    myTex->loadTexture(fileName);
-              // load static variable
+    _textureRegistry::release(tex);
+    tex = _textureRegistry::acquire(fileName); // decoded once, every enemy shares it
 }
 
 
@@ -40,28 +41,39 @@ void _enms::drawEnms(GLuint tx)
     //  glBindTexture(GL_TEXTURE_2D, myTx);
 
       glPushMatrix();
-        glTranslatef(pos.x,pos.y,-2);
-        glRotatef(rot.x,1,0,0);
-        glRotatef(rot.y,0,1,0);
-        glRotatef(rot.z,0,0,1);
-
-        glScalef(scale.x,scale.y,1.0);
-
-         glBegin(GL_POLYGON);
-
-          glTexCoord2f(xMin,yMin);
-          glVertex3f(1.0,1.0,0);
-
-          glTexCoord2f(xMax,yMin);
-          glVertex3f(-1.0,1.0,0);
-
-          glTexCoord2f(xMax,yMax);
-          glVertex3f(-1.0,-1.0,0);
+        if(graph && node>=0)
+        {
+          glMultMatrixf(graph->world[node]); // cached, rebuilt only when the enemy moves
+        }
+        else
+        {
+          // translate, scale, rotate like the bullets, the order the scene graph builds
+          glTranslatef(pos.x,pos.y,-2);
+          glScalef(scale.x,scale.y,1.0);
 
-          glTexCoord2f(xMin,yMax);
-          glVertex3f(1.0,-1.0,0);
+          glRotatef(rot.x,1,0,0);
+          glRotatef(rot.y,0,1,0);
+          glRotatef(rot.z,0,0,1);
+        }
 
-         glEnd();
+         // trimmed to the visible texels, the sheet is mirrored so x runs from +1 to -1
+         trimRect r = {0,0,1,1};
+         if(trim) r = trim->frame(xMin,yMin);
+         float u0 = xMin+r.x0*(xMax-xMin), u1 = xMin+r.x1*(xMax-xMin);
+         float v0 = yMin+r.y0*(yMax-yMin), v1 = yMin+r.y1*(yMax-yMin);
+         float x0 = 1.0-2.0*r.x0, x1 = 1.0-2.0*r.x1;
+         float y0 = 1.0-2.0*r.y0, y1 = 1.0-2.0*r.y1;
+
+         streamSpan s = stream->alloc(_glCaps::SPRITES,4,sizeof(streamVertex));
+         if(s.ptr)
+         {
+          streamVertex *q = (streamVertex*)s.ptr;
+          streamPut(&q[0],x0,y0,0,u0,v0);
+          streamPut(&q[1],x1,y0,0,u1,v0);
+          streamPut(&q[2],x1,y1,0,u1,v1);
+          streamPut(&q[3],x0,y1,0,u0,v1);
+          stream->draw(s,GL_QUADS,4);
+         }
 
       glPopMatrix();
    }
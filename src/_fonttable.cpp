@@ -0,0 +1,174 @@
+#include "_fonttable.h"
+#include <fstream>
+#include <sstream>
+#include <string.h>
+#include <stdio.h>
+
+_fontTable::_fontTable()
+{
+    //ctor
+    clear();
+}
+
+_fontTable::~_fontTable()
+{
+    //dtor
+}
+
+void _fontTable::clear()
+{
+    for(int i=0; i<FONT_GLYPHS; i++) glyphs[i] = CharData();
+    count = 0;
+    lineHeight = base = scaleW = scaleH = 0;
+}
+
+const CharData *_fontTable::glyph(unsigned char c) const
+{
+    return glyphs[c].id? &glyphs[c] : nullptr;
+}
+
+std::string _fontTable::binaryName(const char *fntName)
+{
+    return std::string(fntName)+"b";
+}
+
+bool _fontTable::sourceStamp(const char *fileName, uint64_t &size, uint64_t &time)
+{
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if(!GetFileAttributesEx(fileName,GetFileExInfoStandard,&info)) return false;
+    size = ((uint64_t)info.nFileSizeHigh<<32) | info.nFileSizeLow;
+    time = ((uint64_t)info.ftLastWriteTime.dwHighDateTime<<32) | info.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
+
+bool _fontTable::parse(std::istream &file)
+{
+    clear();
+
+    std::string line, key;
+    while(std::getline(file,line))
+    {
+        std::stringstream ss(line);
+        key.clear();
+        ss>>key;
+        if(key!="common" && key!="char") continue;
+
+        CharData cd;
+        std::string valuePair;
+        while(ss>>valuePair)
+        {
+            size_t equalsPos = valuePair.find('=');
+            if(equalsPos==std::string::npos) continue;
+            std::string k = valuePair.substr(0,equalsPos);
+            std::string v = valuePair.substr(equalsPos+1);
+            try
+            {
+                if(key=="common")
+                {
+                    if(k=="base") base = std::stof(v);
+                    else if(k=="lineHeight") lineHeight = std::stof(v);
+                    else if(k=="scaleW") scaleW = std::stof(v); // texture size
+                    else if(k=="scaleH") scaleH = std::stof(v);
+                }
+                else
+                {
+                    if(k=="id") cd.id = std::stoi(v);
+                    else if(k=="x") cd.x = std::stof(v);           // top-left in the texture
+                    else if(k=="y") cd.y = std::stof(v);
+                    else if(k=="width") cd.width = std::stof(v);
+                    else if(k=="height") cd.height = std::stof(v);
+                    else if(k=="xoffset") cd.xoffset = std::stof(v); // from the cursor on screen
+                    else if(k=="yoffset") cd.yoffset = std::stof(v);
+                    else if(k=="xadvance") cd.xadvance = std::stof(v);
+                }
+            }
+            catch(...) { cout<<"font parse error ("<<key<<")"<<endl; }
+        }
+
+        // codes past 8 bits never come out of a std::string, id 0 marks an empty slot
+        if(key=="char" && cd.id>0 && cd.id<FONT_GLYPHS)
+        {
+            if(!glyphs[cd.id].id) count++;
+            glyphs[cd.id] = cd;
+        }
+    }
+    return count>0 && scaleW>0 && scaleH>0;
+}
+
+bool _fontTable::fromBinary(const void *data, size_t size, uint64_t sourceSize, uint64_t sourceTime)
+{
+    if(size!=sizeof(fontBinHeader)+sizeof(glyphs)) return false;
+
+    fontBinHeader h;
+    memcpy(&h,data,sizeof(h));
+    if(h.magic!=FONTB_MAGIC || h.version!=FONTB_VERSION || h.glyphs!=FONT_GLYPHS || h.glyphSize!=sizeof(CharData)) return false;
+    if((sourceSize || sourceTime) && (h.sourceSize!=sourceSize || h.sourceTime!=sourceTime)) return false; // the .fnt changed since
+
+    memcpy(glyphs,(const unsigned char*)data+sizeof(h),sizeof(glyphs));
+    count = h.count;
+    lineHeight = h.lineHeight;
+    base = h.base;
+    scaleW = h.scaleW;
+    scaleH = h.scaleH;
+    return true;
+}
+
+bool _fontTable::readBinary(const char *fileName, uint64_t sourceSize, uint64_t sourceTime)
+{
+    // fixed size, so the whole table comes in with one read
+    struct
+    {
+        fontBinHeader h;
+        CharData g[FONT_GLYPHS];
+    } file;
+
+    FILE *fp = fopen(fileName,"rb");
+    if(!fp) return false;
+    size_t got = fread(&file,1,sizeof(file),fp);
+    fclose(fp);
+    return got==sizeof(file) && fromBinary(&file,sizeof(file),sourceSize,sourceTime);
+}
+
+bool _fontTable::writeBinary(const char *fileName, uint64_t sourceSize, uint64_t sourceTime) const
+{
+    fontBinHeader h;
+    memset(&h,0,sizeof(h));
+    h.magic = FONTB_MAGIC;
+    h.version = FONTB_VERSION;
+    h.glyphs = FONT_GLYPHS;
+    h.glyphSize = sizeof(CharData);
+    h.count = count;
+    h.lineHeight = lineHeight;
+    h.base = base;
+    h.scaleW = scaleW;
+    h.scaleH = scaleH;
+    h.sourceSize = sourceSize;
+    h.sourceTime = sourceTime;
+
+    FILE *fp = fopen(fileName,"wb");
+    if(!fp) return false;
+    bool ok = fwrite(&h,sizeof(h),1,fp)==1 && fwrite(glyphs,sizeof(glyphs),1,fp)==1;
+    fclose(fp);
+    return ok;
+}
+
+bool _fontTable::load(const char *fntName)
+{
+    std::string binName = binaryName(fntName);
+    uint64_t size = 0, time = 0;
+    bool haveSource = sourceStamp(fntName,size,time);
+
+    // without the .fnt any .fntb will do, there's nothing to be stale against
+    if(readBinary(binName.c_str(),size,time)) return true;
+
+    std::ifstream text(fntName);
+    if(!text) return false;
+
+    // a table with missing parts is still used, it just isn't cached
+    if(parse(text) && haveSource)
+    {
+        if(writeBinary(binName.c_str(),size,time)) cout<<fntName<<": "<<count<<" glyphs, compiled to "<<binName<<endl;
+        else cout<<binName<<": can't write, the text gets parsed again next start"<<endl;
+    }
+    return true;
+}
@@ -0,0 +1,120 @@
+#include "_glcaps.h"
+
+const char *_glCaps::featureNames[FEATURE_COUNT] = {"sprites","text","particles","textures","offscreen","gpu timing","capture","tiles","uploads"};
+const char *_glCaps::pathNames[PATH_COUNT] = {"immediate","client arrays","vbo","persistent ring","uncompressed","s3tc","bptc",
+                                              "native","fbo","none","elapsed queries","timestamps",
+                                              "readback","pbo ring","display lists","client memory"};
+
+int _glCaps::paths[FEATURE_COUNT] = {PATH_IMMEDIATE, PATH_IMMEDIATE, PATH_IMMEDIATE, PATH_UNCOMPRESSED, PATH_NATIVE, PATH_NONE, PATH_READBACK, PATH_DISPLAY_LIST, PATH_CLIENT_MEMORY};
+
+// fastest first, each list ends in something every 1.1 context can do
+static const int sprites[]   = {_glCaps::PATH_PERSISTENT, _glCaps::PATH_CLIENT_ARRAYS, _glCaps::PATH_IMMEDIATE};
+static const int text[]      = {_glCaps::PATH_PERSISTENT, _glCaps::PATH_CLIENT_ARRAYS, _glCaps::PATH_IMMEDIATE};
+static const int particles[] = {_glCaps::PATH_PERSISTENT, _glCaps::PATH_VBO, _glCaps::PATH_CLIENT_ARRAYS, _glCaps::PATH_IMMEDIATE};
+static const int textures[]  = {_glCaps::PATH_BPTC, _glCaps::PATH_S3TC, _glCaps::PATH_UNCOMPRESSED};
+static const int offscreen[] = {_glCaps::PATH_FBO, _glCaps::PATH_NATIVE};
+static const int timing[]    = {_glCaps::PATH_TIMESTAMP, _glCaps::PATH_ELAPSED, _glCaps::PATH_NONE};
+static const int capture[]   = {_glCaps::PATH_PBO, _glCaps::PATH_READBACK};
+static const int tiles[]     = {_glCaps::PATH_VBO, _glCaps::PATH_DISPLAY_LIST};
+static const int uploads[]   = {_glCaps::PATH_PBO, _glCaps::PATH_CLIENT_MEMORY};
+
+struct preference
+{
+    const int *list;
+    int count;
+    bool runtime; // safe to switch after startup
+};
+
+#define PREF(a, r) {a, (int)(sizeof(a)/sizeof(a[0])), r}
+static const preference prefs[_glCaps::FEATURE_COUNT] = {
+    PREF(sprites, true), PREF(text, true), PREF(particles, true),
+    PREF(textures, false), PREF(offscreen, false), PREF(timing, false), PREF(capture, false), PREF(tiles, false), PREF(uploads, false)
+};
+#undef PREF
+
+bool _glCaps::supported(int p)
+{
+    switch(p)
+    {
+        case PATH_VBO:        return _glext::hasVBO;
+        case PATH_PERSISTENT: return _glext::hasBufferStorage && _glext::hasSync;
+        case PATH_S3TC:       return _glext::hasS3TC;
+        case PATH_BPTC:       return _glext::hasBPTC && _glext::hasS3TC;
+        case PATH_FBO:        return _glext::hasFBO;
+        case PATH_ELAPSED:    return _glext::hasTimeElapsed;
+        case PATH_TIMESTAMP:  return _glext::hasTimestamp;
+        case PATH_PBO:        return _glext::hasPBO;
+        default:              return true; // plain 1.1
+    }
+}
+
+void _glCaps::probe()
+{
+    for(int f=0; f<FEATURE_COUNT; f++)
+    {
+        const preference &pr = prefs[f];
+        paths[f] = pr.list[pr.count-1];
+        for(int i=0; i<pr.count; i++)
+            if(supported(pr.list[i]))
+            {
+                paths[f] = pr.list[i];
+                break;
+            }
+    }
+    log();
+}
+
+bool _glCaps::force(int f, int p)
+{
+    if(f<0 || f>=FEATURE_COUNT || !prefs[f].runtime || !supported(p)) return false;
+
+    const preference &pr = prefs[f];
+    for(int i=0; i<pr.count; i++)
+        if(pr.list[i]==p)
+        {
+            paths[f] = p;
+            return true;
+        }
+    return false;
+}
+
+int _glCaps::next(int f)
+{
+    if(f<0 || f>=FEATURE_COUNT || !prefs[f].runtime) return paths[f];
+
+    const preference &pr = prefs[f];
+    int at = 0;
+    for(int i=0; i<pr.count; i++)
+        if(pr.list[i]==paths[f]) at = i;
+
+    for(int k=1; k<=pr.count; k++)
+    {
+        int p = pr.list[(at+k)%pr.count];
+        if(supported(p))
+        {
+            paths[f] = p;
+            break;
+        }
+    }
+    return paths[f];
+}
+
+const char *_glCaps::pathName(int f)
+{
+    return (f>=0 && f<FEATURE_COUNT)? pathNames[paths[f]] : "?";
+}
+
+void _glCaps::log()
+{
+    const char *vendor = (const char*)glGetString(GL_VENDOR);
+    const char *renderer = (const char*)glGetString(GL_RENDERER);
+
+    cout<<"gl: "<<_glext::major<<"."<<_glext::minor<<", "<<(vendor? vendor : "?")<<", "<<(renderer? renderer : "?")<<endl;
+    cout<<"gl caps: vbo "<<_glext::hasVBO<<", map range "<<_glext::hasMapBufferRange
+        <<", buffer storage "<<_glext::hasBufferStorage<<", sync "<<_glext::hasSync
+        <<", instancing "<<_glext::hasInstancing<<", s3tc "<<_glext::hasS3TC<<", bptc "<<_glext::hasBPTC
+        <<", fbo "<<_glext::hasFBO<<", pbo "<<_glext::hasPBO<<", timer "<<_glext::hasTimeElapsed<<"/"<<_glext::hasTimestamp<<endl;
+
+    for(int f=0; f<FEATURE_COUNT; f++)
+        cout<<"  "<<featureNames[f]<<": "<<pathNames[paths[f]]<<endl;
+}
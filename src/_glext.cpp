@@ -0,0 +1,195 @@
+#include "_glext.h"
+#include <string.h>
+#include <stdio.h>
+
+int _glext::major = 1;
+int _glext::minor = 1;
+
+bool _glext::hasFBO = false;
+PFNGLGENFRAMEBUFFERSEXTPROC         _glext::GenFramebuffers = nullptr;
+PFNGLDELETEFRAMEBUFFERSEXTPROC      _glext::DeleteFramebuffers = nullptr;
+PFNGLBINDFRAMEBUFFEREXTPROC         _glext::BindFramebuffer = nullptr;
+PFNGLFRAMEBUFFERTEXTURE2DEXTPROC    _glext::FramebufferTexture2D = nullptr;
+PFNGLGENRENDERBUFFERSEXTPROC        _glext::GenRenderbuffers = nullptr;
+PFNGLDELETERENDERBUFFERSEXTPROC     _glext::DeleteRenderbuffers = nullptr;
+PFNGLBINDRENDERBUFFEREXTPROC        _glext::BindRenderbuffer = nullptr;
+PFNGLRENDERBUFFERSTORAGEEXTPROC     _glext::RenderbufferStorage = nullptr;
+PFNGLFRAMEBUFFERRENDERBUFFEREXTPROC _glext::FramebufferRenderbuffer = nullptr;
+PFNGLCHECKFRAMEBUFFERSTATUSEXTPROC  _glext::CheckFramebufferStatus = nullptr;
+
+bool _glext::hasTimeElapsed = false;
+bool _glext::hasTimestamp = false;
+PFNGLGENQUERIESPROC             _glext::GenQueries = nullptr;
+PFNGLDELETEQUERIESPROC          _glext::DeleteQueries = nullptr;
+PFNGLBEGINQUERYPROC             _glext::BeginQuery = nullptr;
+PFNGLENDQUERYPROC               _glext::EndQuery = nullptr;
+PFNGLGETQUERYOBJECTIVPROC       _glext::GetQueryObjectiv = nullptr;
+PFNGLGETQUERYOBJECTUI64VEXTPROC _glext::GetQueryObjectui64v = nullptr;
+PFNGLQUERYCOUNTERPROC           _glext::QueryCounter = nullptr;
+
+bool _glext::hasPalettedTexture = false;
+PFNGLCOLORTABLEEXTPROC          _glext::ColorTable = nullptr;
+
+bool _glext::hasS3TC = false;
+bool _glext::hasBPTC = false;
+PFNGLCOMPRESSEDTEXIMAGE2DPROC   _glext::CompressedTexImage2D = nullptr;
+
+bool _glext::hasVBO = false;
+PFNGLGENBUFFERSPROC             _glext::GenBuffers = nullptr;
+PFNGLDELETEBUFFERSPROC          _glext::DeleteBuffers = nullptr;
+PFNGLBINDBUFFERPROC             _glext::BindBuffer = nullptr;
+PFNGLBUFFERDATAPROC             _glext::BufferData = nullptr;
+PFNGLBUFFERSUBDATAPROC          _glext::BufferSubData = nullptr;
+PFNGLUNMAPBUFFERPROC            _glext::UnmapBuffer = nullptr;
+PFNGLMAPBUFFERPROC              _glext::MapBuffer = nullptr;
+
+bool _glext::hasPBO = false;
+
+bool _glext::hasMapBufferRange = false;
+bool _glext::hasBufferStorage = false;
+PFNGLMAPBUFFERRANGEPROC         _glext::MapBufferRange = nullptr;
+PFNGLBUFFERSTORAGEPROC          _glext::BufferStorage = nullptr;
+
+bool _glext::hasSync = false;
+PFNGLFENCESYNCPROC              _glext::FenceSync = nullptr;
+PFNGLCLIENTWAITSYNCPROC         _glext::ClientWaitSync = nullptr;
+PFNGLDELETESYNCPROC             _glext::DeleteSync = nullptr;
+
+bool _glext::hasInstancing = false;
+PFNGLDRAWARRAYSINSTANCEDPROC    _glext::DrawArraysInstanced = nullptr;
+
+bool _glext::hasBlendSeparate = false;
+PFNGLBLENDFUNCSEPARATEPROC      _glext::BlendFuncSeparate = nullptr;
+
+PROC _glext::load(const char *core, const char *ext)
+{
+    PROC p = wglGetProcAddress(core);
+
+    // some drivers hand back small integers instead of NULL on failure
+    if((intptr_t)p >= -1 && (intptr_t)p <= 3) p = nullptr;
+    if(!p && ext) return load(ext, nullptr);
+    return p;
+}
+
+bool _glext::hasExtension(const char *name)
+{
+    const char *ext = (const char*)glGetString(GL_EXTENSIONS);
+    if(!ext || !name) return false;
+
+    size_t len = strlen(name);
+    for(const char *p = strstr(ext,name); p; p = strstr(p+len,name))
+    {
+        // must be a whole token, GL_EXT_foo should not match GL_EXT_foo_bar
+        bool startOk = (p==ext || p[-1]==' ');
+        bool endOk   = (p[len]==' ' || p[len]=='\0');
+        if(startOk && endOk) return true;
+    }
+    return false;
+}
+
+bool _glext::init()
+{
+    const char *ver = (const char*)glGetString(GL_VERSION);
+    if(!ver) return false; // no current context
+    sscanf(ver,"%d.%d",&major,&minor);
+
+    if(major>=3 || hasExtension("GL_ARB_framebuffer_object") || hasExtension("GL_EXT_framebuffer_object"))
+    {
+        GenFramebuffers        = (PFNGLGENFRAMEBUFFERSEXTPROC)load("glGenFramebuffers","glGenFramebuffersEXT");
+        DeleteFramebuffers     = (PFNGLDELETEFRAMEBUFFERSEXTPROC)load("glDeleteFramebuffers","glDeleteFramebuffersEXT");
+        BindFramebuffer        = (PFNGLBINDFRAMEBUFFEREXTPROC)load("glBindFramebuffer","glBindFramebufferEXT");
+        FramebufferTexture2D   = (PFNGLFRAMEBUFFERTEXTURE2DEXTPROC)load("glFramebufferTexture2D","glFramebufferTexture2DEXT");
+        GenRenderbuffers       = (PFNGLGENRENDERBUFFERSEXTPROC)load("glGenRenderbuffers","glGenRenderbuffersEXT");
+        DeleteRenderbuffers    = (PFNGLDELETERENDERBUFFERSEXTPROC)load("glDeleteRenderbuffers","glDeleteRenderbuffersEXT");
+        BindRenderbuffer       = (PFNGLBINDRENDERBUFFEREXTPROC)load("glBindRenderbuffer","glBindRenderbufferEXT");
+        RenderbufferStorage    = (PFNGLRENDERBUFFERSTORAGEEXTPROC)load("glRenderbufferStorage","glRenderbufferStorageEXT");
+        FramebufferRenderbuffer= (PFNGLFRAMEBUFFERRENDERBUFFEREXTPROC)load("glFramebufferRenderbuffer","glFramebufferRenderbufferEXT");
+        CheckFramebufferStatus = (PFNGLCHECKFRAMEBUFFERSTATUSEXTPROC)load("glCheckFramebufferStatus","glCheckFramebufferStatusEXT");
+
+        hasFBO = GenFramebuffers && DeleteFramebuffers && BindFramebuffer && FramebufferTexture2D &&
+                 GenRenderbuffers && DeleteRenderbuffers && BindRenderbuffer && RenderbufferStorage &&
+                 FramebufferRenderbuffer && CheckFramebufferStatus;
+    }
+
+    bool arbTimer = (major>3 || (major==3 && minor>=3)) || hasExtension("GL_ARB_timer_query");
+    if(arbTimer || hasExtension("GL_EXT_timer_query"))
+    {
+        GenQueries          = (PFNGLGENQUERIESPROC)load("glGenQueries","glGenQueriesARB");
+        DeleteQueries       = (PFNGLDELETEQUERIESPROC)load("glDeleteQueries","glDeleteQueriesARB");
+        BeginQuery          = (PFNGLBEGINQUERYPROC)load("glBeginQuery","glBeginQueryARB");
+        EndQuery            = (PFNGLENDQUERYPROC)load("glEndQuery","glEndQueryARB");
+        GetQueryObjectiv    = (PFNGLGETQUERYOBJECTIVPROC)load("glGetQueryObjectiv","glGetQueryObjectivARB");
+        GetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VEXTPROC)load("glGetQueryObjectui64v","glGetQueryObjectui64vEXT");
+        if(arbTimer) QueryCounter = (PFNGLQUERYCOUNTERPROC)load("glQueryCounter",nullptr);
+
+        hasTimeElapsed = GenQueries && DeleteQueries && BeginQuery && EndQuery &&
+                         GetQueryObjectiv && GetQueryObjectui64v;
+        hasTimestamp = hasTimeElapsed && QueryCounter;
+    }
+
+    if(hasExtension("GL_EXT_paletted_texture"))
+    {
+        ColorTable = (PFNGLCOLORTABLEEXTPROC)load("glColorTableEXT",nullptr);
+        hasPalettedTexture = ColorTable != nullptr;
+    }
+
+    // glCompressedTexImage2D is core since 1.3, s3tc itself never made it into core
+    CompressedTexImage2D = (PFNGLCOMPRESSEDTEXIMAGE2DPROC)load("glCompressedTexImage2D","glCompressedTexImage2DARB");
+    if(CompressedTexImage2D)
+    {
+        hasS3TC = hasExtension("GL_EXT_texture_compression_s3tc");
+        hasBPTC = (major>4 || (major==4 && minor>=2)) || hasExtension("GL_ARB_texture_compression_bptc");
+    }
+
+    bool gl15 = major>1 || minor>=5;
+    if(gl15 || hasExtension("GL_ARB_vertex_buffer_object"))
+    {
+        GenBuffers    = (PFNGLGENBUFFERSPROC)load("glGenBuffers","glGenBuffersARB");
+        DeleteBuffers = (PFNGLDELETEBUFFERSPROC)load("glDeleteBuffers","glDeleteBuffersARB");
+        BindBuffer    = (PFNGLBINDBUFFERPROC)load("glBindBuffer","glBindBufferARB");
+        BufferData    = (PFNGLBUFFERDATAPROC)load("glBufferData","glBufferDataARB");
+        BufferSubData = (PFNGLBUFFERSUBDATAPROC)load("glBufferSubData","glBufferSubDataARB");
+        UnmapBuffer   = (PFNGLUNMAPBUFFERPROC)load("glUnmapBuffer","glUnmapBufferARB");
+        MapBuffer     = (PFNGLMAPBUFFERPROC)load("glMapBuffer","glMapBufferARB");
+
+        hasVBO = GenBuffers && DeleteBuffers && BindBuffer && BufferData && BufferSubData && UnmapBuffer;
+    }
+
+    // same entry points, the pack target just lets glReadPixels write into a buffer
+    if(hasVBO && MapBuffer && ((major==2 && minor>=1) || major>2 || hasExtension("GL_ARB_pixel_buffer_object")))
+        hasPBO = true;
+
+    if(hasVBO && (major>=3 || hasExtension("GL_ARB_map_buffer_range")))
+    {
+        MapBufferRange = (PFNGLMAPBUFFERRANGEPROC)load("glMapBufferRange",nullptr);
+        hasMapBufferRange = MapBufferRange != nullptr;
+    }
+
+    if(hasMapBufferRange && ((major==4 && minor>=4) || major>4 || hasExtension("GL_ARB_buffer_storage")))
+    {
+        BufferStorage = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage",nullptr);
+        hasBufferStorage = BufferStorage != nullptr;
+    }
+
+    if((major==3 && minor>=2) || major>3 || hasExtension("GL_ARB_sync"))
+    {
+        FenceSync      = (PFNGLFENCESYNCPROC)load("glFenceSync",nullptr);
+        ClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)load("glClientWaitSync",nullptr);
+        DeleteSync     = (PFNGLDELETESYNCPROC)load("glDeleteSync",nullptr);
+        hasSync = FenceSync && ClientWaitSync && DeleteSync;
+    }
+
+    if((major==3 && minor>=1) || major>3 || hasExtension("GL_ARB_draw_instanced"))
+    {
+        DrawArraysInstanced = (PFNGLDRAWARRAYSINSTANCEDPROC)load("glDrawArraysInstanced","glDrawArraysInstancedARB");
+        hasInstancing = DrawArraysInstanced != nullptr;
+    }
+
+    if(major>1 || minor>=4 || hasExtension("GL_EXT_blend_func_separate"))
+    {
+        BlendFuncSeparate = (PFNGLBLENDFUNCSEPARATEPROC)load("glBlendFuncSeparate","glBlendFuncSeparateEXT");
+        hasBlendSeparate = BlendFuncSeparate != nullptr;
+    }
+
+    return true;
+}
@@ -0,0 +1,1036 @@
+#define GLTRACE_NO_MACROS // the wrappers call the real entry points
+#include "_gltrace.h"
+#include "_glext.h"
+#include "_renderstats.h"
+#include <string.h>
+#include <map>
+
+FILE *_glTrace::file = nullptr;
+bool _glTrace::capturing = false;
+int _glTrace::listDepth = 0;
+int _glTrace::frames = 0;
+bool _glTrace::wantToggle = false;
+std::vector<unsigned char> _glTrace::out;
+
+// what the driver would know, so draws can copy the vertices they read
+// and uploads know which object they went to
+struct traceArray
+{
+    bool on;
+    GLint size;
+    GLenum type;
+    GLsizei stride;
+    const GLvoid *ptr;
+    GLuint buffer;
+};
+
+struct traceClient
+{
+    traceArray arrays[3]; // vertex, tex coord, color
+    GLuint arrayBuffer;   // part of the client vertex array state, so it is pushed with it
+};
+
+struct traceMapping
+{
+    unsigned char *ptr;
+    GLintptr offset;
+    GLsizeiptr length;
+    bool write;
+};
+
+static traceClient client;
+static std::vector<traceClient> clientStack;
+static GLuint boundTexture = 0, boundPack = 0, boundUnpack = 0;
+static GLuint boundFramebuffer = 0, boundRenderbuffer = 0;
+static GLint unpackAlignment = 4;
+static std::map<GLuint, GLsizeiptr> bufferSize;
+static std::map<GLuint, traceMapping> mapped;
+static bool inGroup = false;
+
+static int typeSize(GLenum type)
+{
+    switch(type)
+    {
+        case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: return 4;
+        case GL_DOUBLE: return 8;
+        case GL_SHORT: case GL_UNSIGNED_SHORT: return 2;
+        default: return 1;
+    }
+}
+
+// bytes glTexImage2D reads with the current unpack alignment
+static size_t imageBytes(GLsizei w, GLsizei h, GLenum format, GLenum type)
+{
+    if(w<=0 || h<=0) return 0;
+
+    size_t pixel;
+    if(type==GL_UNSIGNED_SHORT_5_6_5 || type==GL_UNSIGNED_SHORT_4_4_4_4 || type==GL_UNSIGNED_SHORT_5_5_5_1) pixel = 2;
+    else if(type==GL_UNSIGNED_INT_8_8_8_8 || type==GL_UNSIGNED_INT_8_8_8_8_REV) pixel = 4;
+    else
+    {
+        int comps = (format==GL_RGBA || format==GL_BGRA)? 4 : (format==GL_RGB || format==GL_BGR)? 3 : format==GL_LUMINANCE_ALPHA? 2 : 1;
+        pixel = comps*typeSize(type);
+    }
+
+    size_t row = w*pixel, a = unpackAlignment>0? unpackAlignment : 1;
+    size_t pitch = (row+a-1)/a*a;
+    return pitch*(h-1)+row;
+}
+
+static GLuint *bufferBinding(GLenum target)
+{
+    if(target==GL_ARRAY_BUFFER) return &client.arrayBuffer;
+    if(target==GL_PIXEL_PACK_BUFFER) return &boundPack;
+    if(target==GL_PIXEL_UNPACK_BUFFER) return &boundUnpack;
+    return nullptr;
+}
+
+static GLuint boundBuffer(GLenum target)
+{
+    GLuint *b = bufferBinding(target);
+    return b? *b : 0;
+}
+
+void _glTrace::op(int code)
+{
+    if(out.size()>(1<<20)) flush();
+    out.push_back((unsigned char)code);
+}
+
+void _glTrace::put(const void *p, size_t n)
+{
+    const unsigned char *b = (const unsigned char*)p;
+    out.insert(out.end(),b,b+n);
+}
+
+void _glTrace::putBlob(const void *p, size_t n)
+{
+    if(!p) n = 0;
+    put<unsigned int>((unsigned int)n);
+    if(n) put(p,n);
+}
+
+void _glTrace::flush()
+{
+    if(file && !out.empty()) fwrite(&out[0],1,out.size(),file);
+    out.clear();
+}
+
+bool _glTrace::open(const char *fileName)
+{
+    file = fopen(fileName,"wb");
+    if(!file)
+    {
+        cout<<"gltrace: can't write "<<fileName<<endl;
+        return false;
+    }
+
+    put<unsigned int>(GLTRACE_MAGIC);
+    put<unsigned int>(GLTRACE_VERSION);
+    memset(&client,0,sizeof(client));
+    cout<<"gltrace: writing "<<fileName<<", f12 starts and stops frames"<<endl;
+    return true;
+}
+
+void _glTrace::close()
+{
+    if(!file) return;
+    flush();
+    fclose(file);
+    file = nullptr;
+    capturing = false;
+    cout<<"gltrace: closed, "<<frames<<" frames"<<endl;
+}
+
+void _glTrace::toggle()
+{
+    if(!file)
+    {
+        cout<<"gltrace: start the game with -gltrace to record"<<endl;
+        return;
+    }
+    wantToggle = true;
+}
+
+void _glTrace::frame()
+{
+    if(!file) return;
+
+    if(capturing)
+    {
+        group(nullptr);
+        op(FRAME_END);
+        frames++;
+    }
+
+    if(wantToggle)
+    {
+        wantToggle = false;
+        capturing = !capturing;
+        if(capturing) writeState();
+        cout<<"gltrace: "<<(capturing? "recording frames" : "stopped")<<", "<<frames<<" so far"<<endl;
+    }
+    flush();
+}
+
+void _glTrace::group(const char *name)
+{
+    if(!frameCalls()) return;
+
+    if(inGroup) op(GROUP_END);
+    inGroup = name!=nullptr;
+    if(!name) return;
+
+    op(GROUP_BEGIN);
+    putBlob(name,strlen(name));
+}
+
+void _glTrace::writeState()
+{
+    static const GLenum caps[] = {GL_TEXTURE_2D, GL_BLEND, GL_DEPTH_TEST, GL_LIGHTING, GL_LIGHT0, GL_COLOR_MATERIAL,
+                                  GL_CULL_FACE, GL_ALPHA_TEST, GL_STENCIL_TEST, GL_NORMALIZE, GL_SCISSOR_TEST};
+    GLint viewport[4], mode, blend[2], depthFunc;
+    GLfloat projection[16], modelview[16], clearColor[4], color[4], light[4][4];
+    GLboolean depthMask;
+
+    glGetIntegerv(GL_VIEWPORT,viewport);
+    glGetIntegerv(GL_MATRIX_MODE,&mode);
+    glGetFloatv(GL_PROJECTION_MATRIX,projection);
+    glGetFloatv(GL_MODELVIEW_MATRIX,modelview);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE,clearColor);
+    glGetFloatv(GL_CURRENT_COLOR,color);
+    glGetIntegerv(GL_BLEND_SRC,&blend[0]);
+    glGetIntegerv(GL_BLEND_DST,&blend[1]);
+    glGetIntegerv(GL_DEPTH_FUNC,&depthFunc);
+    glGetBooleanv(GL_DEPTH_WRITEMASK,&depthMask);
+    glGetLightfv(GL_LIGHT0,GL_AMBIENT,light[0]);
+    glGetLightfv(GL_LIGHT0,GL_DIFFUSE,light[1]);
+    glGetLightfv(GL_LIGHT0,GL_SPECULAR,light[2]);
+    glGetLightfv(GL_LIGHT0,GL_POSITION,light[3]); // eye space, the replay sets it under an identity modelview
+
+    op(FRAME_STATE);
+    put(viewport,sizeof(viewport));
+    put<GLint>(mode);
+    put(projection,sizeof(projection));
+    put(modelview,sizeof(modelview));
+    put(clearColor,sizeof(clearColor));
+    put(color,sizeof(color));
+    put(blend,sizeof(blend));
+    put<GLint>(depthFunc);
+    put<GLboolean>(depthMask);
+    put(light,sizeof(light));
+
+    put<unsigned char>((unsigned char)(sizeof(caps)/sizeof(caps[0])));
+    for(GLenum cap : caps)
+    {
+        put<GLenum>(cap);
+        put<GLboolean>(glIsEnabled(cap));
+    }
+
+    put<GLuint>(boundTexture);
+    put<GLuint>(client.arrayBuffer);
+    put<GLuint>(boundFramebuffer);
+
+    // its own op, so version 1 frame states still read the same
+    GLint scissor[4];
+    glGetIntegerv(GL_SCISSOR_BOX,scissor);
+    op(SCISSOR);
+    put(scissor,sizeof(scissor));
+}
+
+// gl 1.1 ---------------------------------------------------------------------
+
+void traced_glBindTexture(GLenum target, GLuint tex)
+{
+    _renderStats::add(_renderStats::BINDS);
+    if(target==GL_TEXTURE_2D) boundTexture = tex;
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::BIND_TEXTURE); _glTrace::put<GLenum>(target); _glTrace::put<GLuint>(tex); }
+    glBindTexture(target,tex);
+}
+
+void traced_glGenTextures(GLsizei n, GLuint *ids)
+{
+    glGenTextures(n,ids);
+    if(!_glTrace::objects()) return;
+    _glTrace::op(_glTrace::GEN_TEXTURES);
+    _glTrace::putBlob(ids,n*sizeof(GLuint));
+}
+
+void traced_glDeleteTextures(GLsizei n, const GLuint *ids)
+{
+    if(_glTrace::objects())
+    {
+        _glTrace::op(_glTrace::DELETE_TEXTURES);
+        _glTrace::putBlob(ids,n*sizeof(GLuint));
+        for(GLsizei i=0; i<n; i++) if(ids[i]==boundTexture) boundTexture = 0;
+    }
+    glDeleteTextures(n,ids);
+}
+
+// object uploads name their texture and any unpack buffer, so they replay in any bind state
+static void putUpload(const GLvoid *pixels, size_t bytes)
+{
+    _glTrace::put<GLuint>(boundUnpack);
+    if(boundUnpack) _glTrace::put<unsigned long long>((unsigned long long)(size_t)pixels);
+    else            _glTrace::putBlob(pixels,bytes);
+}
+
+void traced_glTexImage2D(GLenum target, GLint level, GLint internal, GLsizei w, GLsizei h, GLint border, GLenum format, GLenum type, const GLvoid *pixels)
+{
+    _renderStats::add(_renderStats::TEXELS,(long long)w*h);
+    if(_glTrace::objects())
+    {
+        _glTrace::op(_glTrace::TEX_IMAGE_2D);
+        _glTrace::put<GLuint>(boundTexture);
+        _glTrace::put<GLenum>(target); _glTrace::put<GLint>(level); _glTrace::put<GLint>(internal);
+        _glTrace::put<GLsizei>(w); _glTrace::put<GLsizei>(h); _glTrace::put<GLint>(border);
+        _glTrace::put<GLenum>(format); _glTrace::put<GLenum>(type);
+        putUpload(pixels,imageBytes(w,h,format,type));
+    }
+    glTexImage2D(target,level,internal,w,h,border,format,type,pixels);
+}
+
+void traced_glTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei w, GLsizei h, GLenum format, GLenum type, const GLvoid *pixels)
+{
+    _renderStats::add(_renderStats::TEXELS,(long long)w*h);
+    if(_glTrace::objects())
+    {
+        _glTrace::op(_glTrace::TEX_SUB_IMAGE_2D);
+        _glTrace::put<GLuint>(boundTexture);
+        _glTrace::put<GLenum>(target); _glTrace::put<GLint>(level);
+        _glTrace::put<GLint>(x); _glTrace::put<GLint>(y); _glTrace::put<GLsizei>(w); _glTrace::put<GLsizei>(h);
+        _glTrace::put<GLenum>(format); _glTrace::put<GLenum>(type);
+        putUpload(pixels,imageBytes(w,h,format,type));
+    }
+    glTexSubImage2D(target,level,x,y,w,h,format,type,pixels);
+}
+
+void traced_glTexParameteri(GLenum target, GLenum pname, GLint param)
+{
+    if(_glTrace::objects())
+    {
+        _glTrace::op(_glTrace::TEX_PARAMETER_I);
+        _glTrace::put<GLuint>(boundTexture);
+        _glTrace::put<GLenum>(target); _glTrace::put<GLenum>(pname); _glTrace::put<GLint>(param);
+    }
+    glTexParameteri(target,pname,param);
+}
+
+void traced_glPixelStorei(GLenum pname, GLint param)
+{
+    if(pname==GL_UNPACK_ALIGNMENT) unpackAlignment = param;
+    if(_glTrace::objects()) { _glTrace::op(_glTrace::PIXEL_STORE_I); _glTrace::put<GLenum>(pname); _glTrace::put<GLint>(param); }
+    glPixelStorei(pname,param);
+}
+
+GLuint traced_glGenLists(GLsizei range)
+{
+    GLuint base = glGenLists(range);
+    if(_glTrace::objects()) { _glTrace::op(_glTrace::GEN_LISTS); _glTrace::put<GLsizei>(range); _glTrace::put<GLuint>(base); }
+    return base;
+}
+
+void traced_glDeleteLists(GLuint list, GLsizei range)
+{
+    _renderStats::deleteLists(list,range);
+    if(_glTrace::objects()) { _glTrace::op(_glTrace::DELETE_LISTS); _glTrace::put<GLuint>(list); _glTrace::put<GLsizei>(range); }
+    glDeleteLists(list,range);
+}
+
+void traced_glNewList(GLuint list, GLenum mode)
+{
+    _renderStats::beginList(list,mode==GL_COMPILE_AND_EXECUTE);
+    if(_glTrace::objects())
+    {
+        _glTrace::op(_glTrace::NEW_LIST); _glTrace::put<GLuint>(list); _glTrace::put<GLenum>(mode);
+        _glTrace::listDepth++;
+    }
+    glNewList(list,mode);
+}
+
+void traced_glEndList()
+{
+    _renderStats::endList();
+    if(_glTrace::objects() && _glTrace::listDepth>0)
+    {
+        _glTrace::op(_glTrace::END_LIST);
+        _glTrace::listDepth--;
+    }
+    glEndList();
+}
+
+void traced_glCallList(GLuint list)
+{
+    _renderStats::callList(list);
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::CALL_LIST); _glTrace::put<GLuint>(list); }
+    glCallList(list);
+}
+
+void traced_glEnable(GLenum cap)
+{
+    _renderStats::add(_renderStats::STATES);
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::ENABLE); _glTrace::put<GLenum>(cap); }
+    glEnable(cap);
+}
+
+void traced_glDisable(GLenum cap)
+{
+    _renderStats::add(_renderStats::STATES);
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::DISABLE); _glTrace::put<GLenum>(cap); }
+    glDisable(cap);
+}
+
+void traced_glBlendFunc(GLenum src, GLenum dst)
+{
+    _renderStats::add(_renderStats::STATES);
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::BLEND_FUNC); _glTrace::put<GLenum>(src); _glTrace::put<GLenum>(dst); }
+    glBlendFunc(src,dst);
+}
+
+void traced_glDepthFunc(GLenum func)
+{
+    _renderStats::add(_renderStats::STATES);
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::DEPTH_FUNC); _glTrace::put<GLenum>(func); }
+    glDepthFunc(func);
+}
+
+void traced_glDepthMask(GLboolean on)
+{
+    _renderStats::add(_renderStats::STATES);
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::DEPTH_MASK); _glTrace::put<GLboolean>(on); }
+    glDepthMask(on);
+}
+
+void traced_glStencilFunc(GLenum func, GLint ref, GLuint mask)
+{
+    _renderStats::add(_renderStats::STATES);
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::STENCIL_FUNC); _glTrace::put<GLenum>(func); _glTrace::put<GLint>(ref); _glTrace::put<GLuint>(mask); }
+    glStencilFunc(func,ref,mask);
+}
+
+void traced_glStencilOp(GLenum fail, GLenum zfail, GLenum zpass)
+{
+    _renderStats::add(_renderStats::STATES);
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::STENCIL_OP); _glTrace::put<GLenum>(fail); _glTrace::put<GLenum>(zfail); _glTrace::put<GLenum>(zpass); }
+    glStencilOp(fail,zfail,zpass);
+}
+
+void traced_glClear(GLbitfield mask)
+{
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::CLEAR); _glTrace::put<GLbitfield>(mask); }
+    glClear(mask);
+}
+
+void traced_glClearColor(GLclampf r, GLclampf g, GLclampf b, GLclampf a)
+{
+    if(_glTrace::frameCalls()) { GLfloat c[4] = {r,g,b,a}; _glTrace::op(_glTrace::CLEAR_COLOR); _glTrace::put(c,sizeof(c)); }
+    glClearColor(r,g,b,a);
+}
+
+void traced_glClearDepth(GLclampd d)
+{
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::CLEAR_DEPTH); _glTrace::put<GLclampd>(d); }
+    glClearDepth(d);
+}
+
+void traced_glClearStencil(GLint s)
+{
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::CLEAR_STENCIL); _glTrace::put<GLint>(s); }
+    glClearStencil(s);
+}
+
+void traced_glViewport(GLint x, GLint y, GLsizei w, GLsizei h)
+{
+    _renderStats::add(_renderStats::STATES);
+    if(_glTrace::frameCalls()) { GLint v[4] = {x,y,w,h}; _glTrace::op(_glTrace::VIEWPORT); _glTrace::put(v,sizeof(v)); }
+    glViewport(x,y,w,h);
+}
+
+void traced_glMatrixMode(GLenum mode)
+{
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::MATRIX_MODE); _glTrace::put<GLenum>(mode); }
+    glMatrixMode(mode);
+}
+
+void traced_glLoadIdentity()
+{
+    if(_glTrace::frameCalls()) _glTrace::op(_glTrace::LOAD_IDENTITY);
+    glLoadIdentity();
+}
+
+void traced_glPushMatrix()
+{
+    if(_glTrace::frameCalls()) _glTrace::op(_glTrace::PUSH_MATRIX);
+    glPushMatrix();
+}
+
+void traced_glPopMatrix()
+{
+    if(_glTrace::frameCalls()) _glTrace::op(_glTrace::POP_MATRIX);
+    glPopMatrix();
+}
+
+void traced_glTranslatef(GLfloat x, GLfloat y, GLfloat z)
+{
+    if(_glTrace::frameCalls()) { GLfloat v[3] = {x,y,z}; _glTrace::op(_glTrace::TRANSLATE_F); _glTrace::put(v,sizeof(v)); }
+    glTranslatef(x,y,z);
+}
+
+void traced_glRotatef(GLfloat a, GLfloat x, GLfloat y, GLfloat z)
+{
+    if(_glTrace::frameCalls()) { GLfloat v[4] = {a,x,y,z}; _glTrace::op(_glTrace::ROTATE_F); _glTrace::put(v,sizeof(v)); }
+    glRotatef(a,x,y,z);
+}
+
+void traced_glScalef(GLfloat x, GLfloat y, GLfloat z)
+{
+    if(_glTrace::frameCalls()) { GLfloat v[3] = {x,y,z}; _glTrace::op(_glTrace::SCALE_F); _glTrace::put(v,sizeof(v)); }
+    glScalef(x,y,z);
+}
+
+void traced_glMultMatrixf(const GLfloat *m)
+{
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::MULT_MATRIX_F); _glTrace::put(m,16*sizeof(GLfloat)); }
+    glMultMatrixf(m);
+}
+
+void traced_gluPerspective(GLdouble fov, GLdouble aspect, GLdouble zNear, GLdouble zFar)
+{
+    if(_glTrace::frameCalls()) { GLdouble v[4] = {fov,aspect,zNear,zFar}; _glTrace::op(_glTrace::PERSPECTIVE); _glTrace::put(v,sizeof(v)); }
+    gluPerspective(fov,aspect,zNear,zFar);
+}
+
+void traced_gluOrtho2D(GLdouble left, GLdouble right, GLdouble bottom, GLdouble top)
+{
+    if(_glTrace::frameCalls()) { GLdouble v[4] = {left,right,bottom,top}; _glTrace::op(_glTrace::ORTHO_2D); _glTrace::put(v,sizeof(v)); }
+    gluOrtho2D(left,right,bottom,top);
+}
+
+void traced_glPushAttrib(GLbitfield mask)
+{
+    _renderStats::add(_renderStats::STATES);
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::PUSH_ATTRIB); _glTrace::put<GLbitfield>(mask); }
+    glPushAttrib(mask);
+}
+
+void traced_glPopAttrib()
+{
+    _renderStats::add(_renderStats::STATES);
+    if(_glTrace::frameCalls()) _glTrace::op(_glTrace::POP_ATTRIB);
+    glPopAttrib();
+}
+
+void traced_glPushClientAttrib(GLbitfield mask)
+{
+    if(_glTrace::objects()) clientStack.push_back(client);
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::PUSH_CLIENT_ATTRIB); _glTrace::put<GLbitfield>(mask); }
+    glPushClientAttrib(mask);
+}
+
+void traced_glPopClientAttrib()
+{
+    if(_glTrace::objects() && !clientStack.empty())
+    {
+        client = clientStack.back();
+        clientStack.pop_back();
+    }
+    if(_glTrace::frameCalls()) _glTrace::op(_glTrace::POP_CLIENT_ATTRIB);
+    glPopClientAttrib();
+}
+
+static int paramCount(GLenum pname)
+{
+    switch(pname)
+    {
+        case GL_SHININESS: case GL_SPOT_EXPONENT: case GL_SPOT_CUTOFF:
+        case GL_CONSTANT_ATTENUATION: case GL_LINEAR_ATTENUATION: case GL_QUADRATIC_ATTENUATION: return 1;
+        case GL_SPOT_DIRECTION: case GL_COLOR_INDEXES: return 3;
+        default: return 4;
+    }
+}
+
+void traced_glMaterialfv(GLenum face, GLenum pname, const GLfloat *v)
+{
+    if(_glTrace::frameCalls())
+    {
+        _glTrace::op(_glTrace::MATERIAL_FV); _glTrace::put<GLenum>(face); _glTrace::put<GLenum>(pname);
+        _glTrace::putBlob(v,paramCount(pname)*sizeof(GLfloat));
+    }
+    glMaterialfv(face,pname,v);
+}
+
+void traced_glLightfv(GLenum light, GLenum pname, const GLfloat *v)
+{
+    if(_glTrace::frameCalls())
+    {
+        _glTrace::op(_glTrace::LIGHT_FV); _glTrace::put<GLenum>(light); _glTrace::put<GLenum>(pname);
+        _glTrace::putBlob(v,paramCount(pname)*sizeof(GLfloat));
+    }
+    glLightfv(light,pname,v);
+}
+
+static int arrayIndex(GLenum cap)
+{
+    return cap==GL_VERTEX_ARRAY? 0 : cap==GL_TEXTURE_COORD_ARRAY? 1 : cap==GL_COLOR_ARRAY? 2 : -1;
+}
+
+void traced_glEnableClientState(GLenum cap)
+{
+    int i = arrayIndex(cap);
+    if(i>=0 && _glTrace::objects()) client.arrays[i].on = true;
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::ENABLE_CLIENT_STATE); _glTrace::put<GLenum>(cap); }
+    glEnableClientState(cap);
+}
+
+static void tracePointer(int i, int code, GLint size, GLenum type, GLsizei stride, const GLvoid *ptr)
+{
+    if(!_glTrace::objects()) return;
+
+    traceArray &a = client.arrays[i];
+    a.size = size;
+    a.type = type;
+    a.stride = stride? stride : size*typeSize(type);
+    a.ptr = ptr;
+    a.buffer = client.arrayBuffer;
+
+    // client memory is copied in at the draw, only offsets into buffers mean anything here
+    if(!_glTrace::frameCalls()) return;
+    _glTrace::op(code);
+    _glTrace::put<GLint>(size); _glTrace::put<GLenum>(type); _glTrace::put<GLsizei>(stride);
+    _glTrace::put<GLuint>(a.buffer);
+    _glTrace::put<unsigned long long>(a.buffer? (unsigned long long)(size_t)ptr : 0);
+}
+
+void traced_glVertexPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *ptr)
+{
+    tracePointer(0,_glTrace::VERTEX_POINTER,size,type,stride,ptr);
+    glVertexPointer(size,type,stride,ptr);
+}
+
+void traced_glTexCoordPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *ptr)
+{
+    tracePointer(1,_glTrace::TEX_COORD_POINTER,size,type,stride,ptr);
+    glTexCoordPointer(size,type,stride,ptr);
+}
+
+void traced_glColorPointer(GLint size, GLenum type, GLsizei stride, const GLvoid *ptr)
+{
+    tracePointer(2,_glTrace::COLOR_POINTER,size,type,stride,ptr);
+    glColorPointer(size,type,stride,ptr);
+}
+
+void traced_glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    _renderStats::add(_renderStats::DRAWS); _renderStats::add(_renderStats::VERTICES,count);
+    if(_glTrace::frameCalls() && count>0)
+    {
+        GLuint done[3] = {0,0,0};
+        for(int i=0; i<3; i++)
+        {
+            const traceArray &a = client.arrays[i];
+            if(!a.on) continue;
+            size_t element = a.size*typeSize(a.type);
+
+            if(!a.buffer)
+            {
+                // client memory, from vertex 0 so first still lines up in the replay
+                _glTrace::op(_glTrace::CLIENT_ARRAY);
+                _glTrace::put<unsigned char>((unsigned char)i);
+                _glTrace::put<GLint>(a.size); _glTrace::put<GLenum>(a.type); _glTrace::put<GLsizei>(a.stride);
+                _glTrace::putBlob(a.ptr,(size_t)(first+count-1)*a.stride+element);
+                continue;
+            }
+
+            // vertices the game wrote through a mapping never went through a gl call, copy what this draw reads
+            std::map<GLuint, traceMapping>::iterator m = mapped.find(a.buffer);
+            if(m==mapped.end() || !m->second.write || a.buffer==done[0] || a.buffer==done[1]) continue;
+            done[i] = a.buffer;
+
+            size_t lo = (size_t)-1, hi = 0;
+            for(int j=0; j<3; j++)
+            {
+                const traceArray &b = client.arrays[j];
+                if(!b.on || b.buffer!=a.buffer) continue;
+                size_t start = (size_t)b.ptr+(size_t)first*b.stride;
+                size_t end = (size_t)b.ptr+(size_t)(first+count-1)*b.stride+b.size*typeSize(b.type);
+                if(start<lo) lo = start;
+                if(end>hi) hi = end;
+            }
+
+            const traceMapping &mp = m->second;
+            if(lo<(size_t)mp.offset) lo = mp.offset;
+            if(hi>(size_t)(mp.offset+mp.length)) hi = mp.offset+mp.length;
+            if(hi<=lo) continue;
+
+            _glTrace::op(_glTrace::BUFFER_SUB_DATA);
+            _glTrace::put<GLuint>(a.buffer); _glTrace::put<GLenum>(GL_ARRAY_BUFFER);
+            _glTrace::put<unsigned long long>(lo);
+            _glTrace::putBlob(mp.ptr+(lo-mp.offset),hi-lo);
+        }
+
+        _glTrace::op(_glTrace::DRAW_ARRAYS);
+        _glTrace::put<GLenum>(mode); _glTrace::put<GLint>(first); _glTrace::put<GLsizei>(count);
+    }
+    glDrawArrays(mode,first,count);
+}
+
+void traced_glBegin(GLenum mode)
+{
+    _renderStats::add(_renderStats::DRAWS);
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::BEGIN); _glTrace::put<GLenum>(mode); }
+    glBegin(mode);
+}
+
+void traced_glEnd()
+{
+    if(_glTrace::frameCalls()) _glTrace::op(_glTrace::END);
+    glEnd();
+}
+
+void traced_glVertex2f(GLfloat x, GLfloat y)
+{
+    _renderStats::add(_renderStats::VERTICES);
+    if(_glTrace::frameCalls()) { GLfloat v[2] = {x,y}; _glTrace::op(_glTrace::VERTEX_2F); _glTrace::put(v,sizeof(v)); }
+    glVertex2f(x,y);
+}
+
+void traced_glVertex3f(GLfloat x, GLfloat y, GLfloat z)
+{
+    _renderStats::add(_renderStats::VERTICES);
+    if(_glTrace::frameCalls()) { GLfloat v[3] = {x,y,z}; _glTrace::op(_glTrace::VERTEX_3F); _glTrace::put(v,sizeof(v)); }
+    glVertex3f(x,y,z);
+}
+
+void traced_glTexCoord2f(GLfloat s, GLfloat t)
+{
+    if(_glTrace::frameCalls()) { GLfloat v[2] = {s,t}; _glTrace::op(_glTrace::TEX_COORD_2F); _glTrace::put(v,sizeof(v)); }
+    glTexCoord2f(s,t);
+}
+
+void traced_glColor3f(GLfloat r, GLfloat g, GLfloat b)
+{
+    if(_glTrace::frameCalls()) { GLfloat v[3] = {r,g,b}; _glTrace::op(_glTrace::COLOR_3F); _glTrace::put(v,sizeof(v)); }
+    glColor3f(r,g,b);
+}
+
+void traced_glColor3fv(const GLfloat *v)
+{
+    traced_glColor3f(v[0],v[1],v[2]);
+}
+
+void traced_glColor4f(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+{
+    if(_glTrace::frameCalls()) { GLfloat v[4] = {r,g,b,a}; _glTrace::op(_glTrace::COLOR_4F); _glTrace::put(v,sizeof(v)); }
+    glColor4f(r,g,b,a);
+}
+
+void traced_glScissor(GLint x, GLint y, GLsizei w, GLsizei h)
+{
+    _renderStats::add(_renderStats::STATES);
+    if(_glTrace::frameCalls()) { GLint v[4] = {x,y,w,h}; _glTrace::op(_glTrace::SCISSOR); _glTrace::put(v,sizeof(v)); }
+    glScissor(x,y,w,h);
+}
+
+void traced_glReadPixels(GLint x, GLint y, GLsizei w, GLsizei h, GLenum format, GLenum type, GLvoid *pixels)
+{
+    // into a pack buffer pixels is an offset, the replay reads into its own buffer at the same one
+    if(_glTrace::frameCalls())
+    {
+        GLint v[4] = {x,y,w,h};
+        _glTrace::op(_glTrace::READ_PIXELS);
+        _glTrace::put(v,sizeof(v));
+        _glTrace::put<GLenum>(format);
+        _glTrace::put<GLenum>(type);
+        _glTrace::put<unsigned long long>(boundPack? (unsigned long long)(uintptr_t)pixels : 0);
+    }
+    glReadPixels(x,y,w,h,format,type,pixels);
+}
+
+void traced_glGetTexImage(GLenum target, GLint level, GLenum format, GLenum type, GLvoid *pixels)
+{
+    if(_glTrace::frameCalls())
+    {
+        _glTrace::op(_glTrace::GET_TEX_IMAGE);
+        _glTrace::put<GLenum>(target);
+        _glTrace::put<GLint>(level);
+        _glTrace::put<GLenum>(format);
+        _glTrace::put<GLenum>(type);
+    }
+    glGetTexImage(target,level,format,type,pixels);
+}
+
+void traced_glFinish()
+{
+    if(_glTrace::frameCalls()) _glTrace::op(_glTrace::FINISH);
+    glFinish();
+}
+
+// extension pointers ---------------------------------------------------------
+
+static PFNGLGENBUFFERSPROC realGenBuffers;
+static PFNGLDELETEBUFFERSPROC realDeleteBuffers;
+static PFNGLBINDBUFFERPROC realBindBuffer;
+static PFNGLBUFFERDATAPROC realBufferData;
+static PFNGLBUFFERSUBDATAPROC realBufferSubData;
+static PFNGLBUFFERSTORAGEPROC realBufferStorage;
+static PFNGLMAPBUFFERPROC realMapBuffer;
+static PFNGLMAPBUFFERRANGEPROC realMapBufferRange;
+static PFNGLUNMAPBUFFERPROC realUnmapBuffer;
+static PFNGLGENFRAMEBUFFERSEXTPROC realGenFramebuffers;
+static PFNGLDELETEFRAMEBUFFERSEXTPROC realDeleteFramebuffers;
+static PFNGLBINDFRAMEBUFFEREXTPROC realBindFramebuffer;
+static PFNGLFRAMEBUFFERTEXTURE2DEXTPROC realFramebufferTexture2D;
+static PFNGLGENRENDERBUFFERSEXTPROC realGenRenderbuffers;
+static PFNGLDELETERENDERBUFFERSEXTPROC realDeleteRenderbuffers;
+static PFNGLBINDRENDERBUFFEREXTPROC realBindRenderbuffer;
+static PFNGLRENDERBUFFERSTORAGEEXTPROC realRenderbufferStorage;
+static PFNGLFRAMEBUFFERRENDERBUFFEREXTPROC realFramebufferRenderbuffer;
+static PFNGLCOMPRESSEDTEXIMAGE2DPROC realCompressedTexImage2D;
+static PFNGLCOLORTABLEEXTPROC realColorTable;
+
+static void putNames(int code, GLsizei n, const GLuint *ids)
+{
+    _glTrace::op(code);
+    _glTrace::putBlob(ids,n*sizeof(GLuint));
+}
+
+static void APIENTRY hookGenBuffers(GLsizei n, GLuint *ids)
+{
+    realGenBuffers(n,ids);
+    if(_glTrace::objects()) putNames(_glTrace::GEN_BUFFERS,n,ids);
+}
+
+static void APIENTRY hookDeleteBuffers(GLsizei n, const GLuint *ids)
+{
+    if(_glTrace::objects())
+    {
+        putNames(_glTrace::DELETE_BUFFERS,n,ids);
+        for(GLsizei i=0; i<n; i++)
+        {
+            mapped.erase(ids[i]);
+            bufferSize.erase(ids[i]);
+        }
+    }
+    realDeleteBuffers(n,ids);
+}
+
+static void APIENTRY hookBindBuffer(GLenum target, GLuint id)
+{
+    _renderStats::add(_renderStats::BINDS);
+    GLuint *b = bufferBinding(target);
+    if(b && _glTrace::objects()) *b = id;
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::BIND_BUFFER); _glTrace::put<GLenum>(target); _glTrace::put<GLuint>(id); }
+    realBindBuffer(target,id);
+}
+
+static void APIENTRY hookBufferData(GLenum target, GLsizeiptr size, const GLvoid *data, GLenum usage)
+{
+    if(_glTrace::objects())
+    {
+        GLuint id = boundBuffer(target);
+        bufferSize[id] = size;
+        _glTrace::op(_glTrace::BUFFER_DATA);
+        _glTrace::put<GLuint>(id); _glTrace::put<GLenum>(target);
+        _glTrace::put<unsigned long long>(size); _glTrace::put<GLenum>(usage);
+        _glTrace::putBlob(data,size);
+    }
+    realBufferData(target,size,data,usage);
+}
+
+static void APIENTRY hookBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid *data)
+{
+    if(_glTrace::objects())
+    {
+        _glTrace::op(_glTrace::BUFFER_SUB_DATA);
+        _glTrace::put<GLuint>(boundBuffer(target)); _glTrace::put<GLenum>(target);
+        _glTrace::put<unsigned long long>(offset);
+        _glTrace::putBlob(data,size);
+    }
+    realBufferSubData(target,offset,size,data);
+}
+
+static void APIENTRY hookBufferStorage(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags)
+{
+    if(_glTrace::objects())
+    {
+        GLuint id = boundBuffer(target);
+        bufferSize[id] = size;
+        _glTrace::op(_glTrace::BUFFER_STORAGE);
+        _glTrace::put<GLuint>(id); _glTrace::put<GLenum>(target);
+        _glTrace::put<unsigned long long>(size); _glTrace::put<GLbitfield>(flags);
+        _glTrace::putBlob(data,size);
+    }
+    realBufferStorage(target,size,data,flags);
+}
+
+static void *APIENTRY hookMapBuffer(GLenum target, GLenum access)
+{
+    void *p = realMapBuffer(target,access);
+    if(p && _glTrace::objects())
+    {
+        GLuint id = boundBuffer(target);
+        traceMapping m = {(unsigned char*)p,0,bufferSize[id],access!=GL_READ_ONLY};
+        mapped[id] = m;
+    }
+    return p;
+}
+
+static void *APIENTRY hookMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    void *p = realMapBufferRange(target,offset,length,access);
+    if(p && _glTrace::objects())
+    {
+        traceMapping m = {(unsigned char*)p,offset,length,(access & GL_MAP_WRITE_BIT)!=0};
+        mapped[boundBuffer(target)] = m;
+    }
+    return p;
+}
+
+static GLboolean APIENTRY hookUnmapBuffer(GLenum target)
+{
+    if(_glTrace::objects())
+    {
+        // what was written through the pointer reaches the driver now
+        GLuint id = boundBuffer(target);
+        std::map<GLuint, traceMapping>::iterator m = mapped.find(id);
+        if(m!=mapped.end())
+        {
+            if(m->second.write)
+            {
+                _glTrace::op(_glTrace::BUFFER_SUB_DATA);
+                _glTrace::put<GLuint>(id); _glTrace::put<GLenum>(target);
+                _glTrace::put<unsigned long long>(m->second.offset);
+                _glTrace::putBlob(m->second.ptr,m->second.length);
+            }
+            mapped.erase(m);
+        }
+    }
+    return realUnmapBuffer(target);
+}
+
+static void APIENTRY hookGenFramebuffers(GLsizei n, GLuint *ids)
+{
+    realGenFramebuffers(n,ids);
+    if(_glTrace::objects()) putNames(_glTrace::GEN_FRAMEBUFFERS,n,ids);
+}
+
+static void APIENTRY hookDeleteFramebuffers(GLsizei n, const GLuint *ids)
+{
+    if(_glTrace::objects()) putNames(_glTrace::DELETE_FRAMEBUFFERS,n,ids);
+    realDeleteFramebuffers(n,ids);
+}
+
+static void APIENTRY hookBindFramebuffer(GLenum target, GLuint id)
+{
+    _renderStats::add(_renderStats::BINDS);
+    if(_glTrace::objects()) boundFramebuffer = id;
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::BIND_FRAMEBUFFER); _glTrace::put<GLenum>(target); _glTrace::put<GLuint>(id); }
+    realBindFramebuffer(target,id);
+}
+
+static void APIENTRY hookFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint tex, GLint level)
+{
+    if(_glTrace::objects())
+    {
+        _glTrace::op(_glTrace::FRAMEBUFFER_TEXTURE_2D);
+        _glTrace::put<GLuint>(boundFramebuffer); _glTrace::put<GLenum>(target); _glTrace::put<GLenum>(attachment);
+        _glTrace::put<GLenum>(textarget); _glTrace::put<GLuint>(tex); _glTrace::put<GLint>(level);
+    }
+    realFramebufferTexture2D(target,attachment,textarget,tex,level);
+}
+
+static void APIENTRY hookGenRenderbuffers(GLsizei n, GLuint *ids)
+{
+    realGenRenderbuffers(n,ids);
+    if(_glTrace::objects()) putNames(_glTrace::GEN_RENDERBUFFERS,n,ids);
+}
+
+static void APIENTRY hookDeleteRenderbuffers(GLsizei n, const GLuint *ids)
+{
+    if(_glTrace::objects()) putNames(_glTrace::DELETE_RENDERBUFFERS,n,ids);
+    realDeleteRenderbuffers(n,ids);
+}
+
+static void APIENTRY hookBindRenderbuffer(GLenum target, GLuint id)
+{
+    if(_glTrace::objects()) boundRenderbuffer = id;
+    if(_glTrace::frameCalls()) { _glTrace::op(_glTrace::BIND_RENDERBUFFER); _glTrace::put<GLenum>(target); _glTrace::put<GLuint>(id); }
+    realBindRenderbuffer(target,id);
+}
+
+static void APIENTRY hookRenderbufferStorage(GLenum target, GLenum internal, GLsizei w, GLsizei h)
+{
+    if(_glTrace::objects())
+    {
+        _glTrace::op(_glTrace::RENDERBUFFER_STORAGE);
+        _glTrace::put<GLuint>(boundRenderbuffer); _glTrace::put<GLenum>(target); _glTrace::put<GLenum>(internal);
+        _glTrace::put<GLsizei>(w); _glTrace::put<GLsizei>(h);
+    }
+    realRenderbufferStorage(target,internal,w,h);
+}
+
+static void APIENTRY hookFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum rbTarget, GLuint rb)
+{
+    if(_glTrace::objects())
+    {
+        _glTrace::op(_glTrace::FRAMEBUFFER_RENDERBUFFER);
+        _glTrace::put<GLuint>(boundFramebuffer); _glTrace::put<GLenum>(target); _glTrace::put<GLenum>(attachment);
+        _glTrace::put<GLenum>(rbTarget); _glTrace::put<GLuint>(rb);
+    }
+    realFramebufferRenderbuffer(target,attachment,rbTarget,rb);
+}
+
+static void APIENTRY hookCompressedTexImage2D(GLenum target, GLint level, GLenum internal, GLsizei w, GLsizei h, GLint border, GLsizei size, const void *data)
+{
+    _renderStats::add(_renderStats::TEXELS,(long long)w*h);
+    if(_glTrace::objects())
+    {
+        _glTrace::op(_glTrace::COMPRESSED_TEX_IMAGE_2D);
+        _glTrace::put<GLuint>(boundTexture);
+        _glTrace::put<GLenum>(target); _glTrace::put<GLint>(level); _glTrace::put<GLenum>(internal);
+        _glTrace::put<GLsizei>(w); _glTrace::put<GLsizei>(h); _glTrace::put<GLint>(border);
+        _glTrace::putBlob(data,size);
+    }
+    realCompressedTexImage2D(target,level,internal,w,h,border,size,data);
+}
+
+static void APIENTRY hookColorTable(GLenum target, GLenum internal, GLsizei width, GLenum format, GLenum type, const GLvoid *table)
+{
+    if(_glTrace::objects())
+    {
+        _glTrace::op(_glTrace::COLOR_TABLE);
+        _glTrace::put<GLuint>(boundTexture);
+        _glTrace::put<GLenum>(target); _glTrace::put<GLenum>(internal); _glTrace::put<GLsizei>(width);
+        _glTrace::put<GLenum>(format); _glTrace::put<GLenum>(type);
+        _glTrace::putBlob(table,imageBytes(width,1,format,type));
+    }
+    realColorTable(target,internal,width,format,type,table);
+}
+
+// _glext::init loads the real pointers again after a context is recreated, so hooking twice is safe
+#define TRACE_HOOK(name) if(_glext::name && _glext::name!=hook##name) { real##name = _glext::name; _glext::name = hook##name; }
+
+// always installed, the render stats count binds and uploads through them even without a trace
+void _glTrace::hook()
+{
+    TRACE_HOOK(GenBuffers)
+    TRACE_HOOK(DeleteBuffers)
+    TRACE_HOOK(BindBuffer)
+    TRACE_HOOK(BufferData)
+    TRACE_HOOK(BufferSubData)
+    TRACE_HOOK(BufferStorage)
+    TRACE_HOOK(MapBuffer)
+    TRACE_HOOK(MapBufferRange)
+    TRACE_HOOK(UnmapBuffer)
+    TRACE_HOOK(GenFramebuffers)
+    TRACE_HOOK(DeleteFramebuffers)
+    TRACE_HOOK(BindFramebuffer)
+    TRACE_HOOK(FramebufferTexture2D)
+    TRACE_HOOK(GenRenderbuffers)
+    TRACE_HOOK(DeleteRenderbuffers)
+    TRACE_HOOK(BindRenderbuffer)
+    TRACE_HOOK(RenderbufferStorage)
+    TRACE_HOOK(FramebufferRenderbuffer)
+    TRACE_HOOK(CompressedTexImage2D)
+    TRACE_HOOK(ColorTable)
+}
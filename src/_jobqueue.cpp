@@ -0,0 +1,125 @@
+#include "_jobqueue.h"
+
+_jobQueue::_jobQueue(int n)
+{
+    //ctor
+    threads = n>0? n : 1;
+    pending = 0;
+    busy = 0;
+    quit = 0;
+
+    InitializeCriticalSection(&lock);
+    wake = CreateSemaphore(NULL,0,0x7fffffff,NULL);
+    idle = CreateEvent(NULL,TRUE,TRUE,NULL);
+
+    for(int i=0; i<threads; i++)
+    {
+        HANDLE h = CreateThread(NULL,0,workerMain,this,0,NULL);
+        if(h) handles.push_back(h);
+    }
+    if(handles.empty()) cout<<"jobs: no worker threads, jobs will run in poll()"<<endl;
+}
+
+_jobQueue::~_jobQueue()
+{
+    //dtor
+    // let the workers drain what's queued, then wake them all to see the quit flag
+    quit = 1;
+    ReleaseSemaphore(wake,(LONG)handles.size(),NULL);
+    if(!handles.empty())
+        WaitForMultipleObjects((DWORD)handles.size(),&handles[0],TRUE,INFINITE);
+
+    for(HANDLE h : handles) CloseHandle(h);
+    CloseHandle(wake);
+    CloseHandle(idle);
+    DeleteCriticalSection(&lock);
+}
+
+void _jobQueue::push(std::function<void()> work, std::function<void()> done)
+{
+    job j;
+    j.work = work;
+    j.done = done;
+
+    EnterCriticalSection(&lock);
+    queued.push_back(j);
+    if(busy++==0) ResetEvent(idle);
+    LeaveCriticalSection(&lock);
+
+    InterlockedIncrement(&pending);
+    ReleaseSemaphore(wake,1,NULL);
+}
+
+int _jobQueue::poll()
+{
+    // no workers at all, so do the work here rather than never
+    if(handles.empty())
+    {
+        EnterCriticalSection(&lock);
+        while(!queued.empty())
+        {
+            job j = queued.front();
+            queued.pop_front();
+            LeaveCriticalSection(&lock);
+            if(j.work) j.work();
+            EnterCriticalSection(&lock);
+            finished.push_back(j);
+            if(--busy==0) SetEvent(idle);
+        }
+        LeaveCriticalSection(&lock);
+    }
+
+    // swap the list out so done functions can push new jobs without deadlocking
+    std::deque<job> ready;
+    EnterCriticalSection(&lock);
+    ready.swap(finished);
+    LeaveCriticalSection(&lock);
+
+    for(job &j : ready)
+    {
+        if(j.done) j.done();
+        InterlockedDecrement(&pending);
+    }
+    return (int)ready.size();
+}
+
+int _jobQueue::cores()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors>0? (int)info.dwNumberOfProcessors : 1;
+}
+
+void _jobQueue::wait()
+{
+    if(!handles.empty()) WaitForSingleObject(idle,INFINITE);
+    poll();
+}
+
+DWORD WINAPI _jobQueue::workerMain(LPVOID param)
+{
+    _jobQueue *q = (_jobQueue*)param;
+
+    for(;;)
+    {
+        WaitForSingleObject(q->wake,INFINITE);
+
+        EnterCriticalSection(&q->lock);
+        if(q->queued.empty())
+        {
+            LeaveCriticalSection(&q->lock);
+            if(q->quit) return 0;
+            continue;
+        }
+        job j = q->queued.front();
+        q->queued.pop_front();
+        LeaveCriticalSection(&q->lock);
+
+        if(j.work) j.work();
+
+        EnterCriticalSection(&q->lock);
+        q->finished.push_back(j);
+        if(--q->busy==0) SetEvent(q->idle);
+        LeaveCriticalSection(&q->lock);
+    }
+}
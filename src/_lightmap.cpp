@@ -0,0 +1,241 @@
+#include "_lightmap.h"
+#include "_glcaps.h"
+#include "_softrastergl.h"
+#include <vector>
+
+_lightMap::_lightMap()
+{
+    //ctor
+    enabled = true;
+    ambient = 0.35f;
+    count = 0;
+    stream = nullptr;
+
+    texW = texH = 0;
+    fbo = lightTex = falloffTex = 0;
+    ready = false;
+}
+
+_lightMap::~_lightMap()
+{
+    //dtor
+    freeTarget();
+    if(falloffTex) glDeleteTextures(1,&falloffTex);
+}
+
+void _lightMap::initLights()
+{
+    if(_glCaps::paths[_glCaps::OFFSCREEN]!=_glCaps::PATH_FBO)
+    {
+        cout<<"lights: no framebuffer objects, 2d lighting off"<<endl;
+        enabled = false;
+        return;
+    }
+
+    // smooth (1-d^2)^2 falloff, zero at the edge so quads never show their corners
+    const int size = 64;
+    std::vector<unsigned char> texels(size*size);
+    for(int y=0; y<size; y++)
+        for(int x=0; x<size; x++)
+        {
+            float dx = (x+0.5f)/size*2.0f-1.0f;
+            float dy = (y+0.5f)/size*2.0f-1.0f;
+            float f = 1.0f-(dx*dx+dy*dy);
+            texels[y*size+x] = f>0? (unsigned char)(f*f*255.0f) : 0;
+        }
+
+    glGenTextures(1,&falloffTex);
+    glBindTexture(GL_TEXTURE_2D,falloffTex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT,1);
+    glTexImage2D(GL_TEXTURE_2D,0,GL_LUMINANCE8,size,size,0,GL_LUMINANCE,GL_UNSIGNED_BYTE,&texels[0]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT,4);
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D,0);
+}
+
+bool _lightMap::allocTarget(int w, int h)
+{
+    freeTarget();
+
+    glGenTextures(1,&lightTex);
+    glBindTexture(GL_TEXTURE_2D,lightTex);
+    glTexImage2D(GL_TEXTURE_2D,0,GL_RGB8,w,h,0,GL_RGB,GL_UNSIGNED_BYTE,NULL);
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR); // the upscale is the blur
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D,0);
+
+    _glext::GenFramebuffers(1,&fbo);
+    _glext::BindFramebuffer(GL_FRAMEBUFFER_EXT,fbo);
+    _glext::FramebufferTexture2D(GL_FRAMEBUFFER_EXT,GL_COLOR_ATTACHMENT0_EXT,GL_TEXTURE_2D,lightTex,0);
+    GLenum status = _glext::CheckFramebufferStatus(GL_FRAMEBUFFER_EXT);
+    _glext::BindFramebuffer(GL_FRAMEBUFFER_EXT,0);
+
+    if(status != GL_FRAMEBUFFER_COMPLETE_EXT)
+    {
+        cout<<"lights: framebuffer incomplete, 2d lighting off"<<endl;
+        freeTarget();
+        enabled = false;
+        return false;
+    }
+
+    texW = w;
+    texH = h;
+    return true;
+}
+
+void _lightMap::freeTarget()
+{
+    if(fbo)      _glext::DeleteFramebuffers(1,&fbo);
+    if(lightTex) glDeleteTextures(1,&lightTex);
+    fbo = lightTex = 0;
+    texW = texH = 0;
+}
+
+void _lightMap::add(vec3 pos, float radius, float r, float g, float b)
+{
+    flash(pos,radius,r,g,b,0);
+}
+
+void _lightMap::flash(vec3 pos, float radius, float r, float g, float b, float seconds)
+{
+    if(count>=MAX_LIGHTS) return;
+
+    light2D &l = lights[count++];
+    l.pos = pos;
+    l.radius = radius;
+    l.r = r; l.g = g; l.b = b;
+    l.life = seconds;
+    l.invLife = seconds>0? 1.0f/seconds : 0;
+}
+
+void _lightMap::update(float dt)
+{
+    // swap dead flashes out like the particle pool does
+    for(int i=0; i<count; )
+    {
+        if(lights[i].invLife>0)
+        {
+            lights[i].life -= dt;
+            if(lights[i].life<=0)
+            {
+                lights[i] = lights[--count];
+                continue;
+            }
+        }
+        i++;
+    }
+}
+
+bool _lightMap::accumulate(int w, int h)
+{
+    ready = false;
+    int lw = w/LIGHT_DOWNSCALE, lh = h/LIGHT_DOWNSCALE;
+    if(lw<1) lw = 1;
+    if(lh<1) lh = 1;
+
+    // the scene keeps adding lights while they're switched off, they still only last the frame
+    if(!enabled || w<=0 || h<=0 || ((lw!=texW || lh!=texH) && !allocTarget(lw,lh)))
+    {
+        endFrame();
+        return false;
+    }
+
+    // the cpu renderer has no light buffer, keep these quads out of its frame
+    _softRasterGL *soft = stream->soft;
+    stream->soft = nullptr;
+
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_VIEWPORT_BIT | GL_CURRENT_BIT);
+    _glext::BindFramebuffer(GL_FRAMEBUFFER_EXT,fbo);
+    glViewport(0,0,texW,texH); // same aspect as the window, so the game projection still fits
+
+    glClearColor(ambient,ambient,ambient,1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE,GL_ONE);
+    glBindTexture(GL_TEXTURE_2D,falloffTex);
+
+    // every light in one span, flashes dimmed by the time they have left
+    streamSpan s = stream->alloc(_glCaps::SPRITES,count*4,sizeof(streamColorVertex));
+    if(s.ptr)
+    {
+        streamColorVertex *v = (streamColorVertex*)s.ptr;
+        for(int i=0; i<count; i++)
+        {
+            const light2D &l = lights[i];
+            float k = l.invLife>0? l.life*l.invLife : 1.0f;
+            float x0 = l.pos.x-l.radius, x1 = l.pos.x+l.radius;
+            float y0 = l.pos.y-l.radius, y1 = l.pos.y+l.radius;
+
+            const float corners[4][4] = {{x0,y0,0,0},{x1,y0,1,0},{x1,y1,1,1},{x0,y1,0,1}};
+            for(int c=0; c<4; c++, v++)
+            {
+                v->x = corners[c][0]; v->y = corners[c][1]; v->z = l.pos.z;
+                v->u = corners[c][2]; v->v = corners[c][3];
+                v->r = l.r*k; v->g = l.g*k; v->b = l.b*k; v->a = 1.0f;
+            }
+        }
+        stream->draw(s,GL_QUADS,count*4);
+    }
+
+    glBindTexture(GL_TEXTURE_2D,0);
+    _glext::BindFramebuffer(GL_FRAMEBUFFER_EXT,0);
+    glPopAttrib();
+    stream->soft = soft;
+
+    endFrame();
+    ready = true;
+    return true;
+}
+
+void _lightMap::endFrame()
+{
+    // one-frame lights are done, flashes stay until update() ages them out
+    for(int i=0; i<count; )
+    {
+        if(lights[i].invLife<=0) lights[i] = lights[--count];
+        else i++;
+    }
+}
+
+void _lightMap::apply(int w, int h)
+{
+    if(!ready) return;
+    ready = false;
+
+    _softRasterGL *soft = stream->soft;
+    stream->soft = nullptr;
+
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_DST_COLOR,GL_SRC_COLOR); // dst*src + src*dst = 2*light*scene
+    glColor3f(1.0,1.0,1.0);
+    glBindTexture(GL_TEXTURE_2D,lightTex);
+
+    // ortho is top-left origin, the light buffer is bottom-left
+    streamSpan s = stream->alloc(_glCaps::SPRITES,4,sizeof(streamVertex));
+    if(s.ptr)
+    {
+        streamVertex *v = (streamVertex*)s.ptr;
+        streamPut(v++,0,0,0,0,1);
+        streamPut(v++,w,0,0,1,1);
+        streamPut(v++,w,h,0,1,0);
+        streamPut(v++,0,h,0,0,0);
+        stream->draw(s,GL_QUADS,4);
+    }
+
+    glBindTexture(GL_TEXTURE_2D,0);
+    glPopAttrib();
+    stream->soft = soft;
+}
@@ -0,0 +1,100 @@
+#include "_mipchain.h"
+#include <string.h>
+#include <utility>
+
+// next level's side, never below 1
+static int halfOf(int n)
+{
+    return n>1? n/2 : 1;
+}
+
+_mipChain::_mipChain(int b, int a, int fx, int fy, bool p)
+{
+    //ctor
+    bpp = b;
+    alpha = a;
+    framesX = fx>0? fx : 1;
+    framesY = fy>0? fy : 1;
+    point = p;
+}
+
+_mipChain::~_mipChain()
+{
+    //dtor
+}
+
+int _mipChain::build(const unsigned char *pixels, int w, int h)
+{
+    levels.clear();
+    widths.clear();
+    heights.clear();
+    if(!pixels || w<=0 || h<=0) return 0;
+
+    // a single image has no neighbouring frames to keep apart, it goes all the way to 1x1
+    bool sheet = framesX>1 || framesY>1;
+
+    const unsigned char *src = pixels;
+    while(w>1 || h>1)
+    {
+        // frame sizes have to halve exactly or the frame grid drifts off the texel grid
+        int cellW = w/framesX, cellH = h/framesY;
+        if(sheet && (cellW*framesX!=w || cellH*framesY!=h)) break;
+        if(sheet && (cellW%2 || cellH%2)) break;
+
+        std::vector<unsigned char> dst((size_t)halfOf(w)*halfOf(h)*bpp);
+        halve(src,w,h,&dst[0]);
+
+        w = halfOf(w);
+        h = halfOf(h);
+        levels.push_back(std::move(dst));
+        widths.push_back(w);
+        heights.push_back(h);
+        src = &levels.back()[0];
+    }
+    return (int)levels.size();
+}
+
+void _mipChain::halve(const unsigned char *src, int w, int h, unsigned char *dst)
+{
+    int dw = halfOf(w), dh = halfOf(h);
+
+    // frames are an even number of texels wide, so every 2x2 footprint sits inside one frame.
+    // a single image may be odd: the last row or column is dropped, like gl sizes its levels,
+    // and a side that is already 1 reads the same texel twice
+    for(int y=0; y<dh; y++)
+        for(int x=0; x<dw; x++)
+        {
+            int x0 = 2*x, x1 = 2*x+1<w? 2*x+1 : w-1;
+            int y0 = 2*y, y1 = 2*y+1<h? 2*y+1 : h-1;
+            const unsigned char *t[4] = {
+                src + ((size_t)y0*w + x0)*bpp,
+                src + ((size_t)y0*w + x1)*bpp,
+                src + ((size_t)y1*w + x0)*bpp,
+                src + ((size_t)y1*w + x1)*bpp };
+            unsigned char *d = dst + ((size_t)y*dw + x)*bpp;
+
+            if(point)
+            {
+                memcpy(d,t[0],bpp);
+                continue;
+            }
+
+            // weight color by alpha so invisible texels don't darken the edges
+            int aSum = 0;
+            if(alpha>=0)
+                for(int k=0; k<4; k++) aSum += t[k][alpha];
+
+            for(int c=0; c<bpp; c++)
+            {
+                int sum = 0;
+                if(c==alpha || alpha<0 || aSum==0)
+                    sum = (t[0][c]+t[1][c]+t[2][c]+t[3][c]+2)/4;
+                else
+                {
+                    for(int k=0; k<4; k++) sum += t[k][c]*t[k][alpha];
+                    sum = (sum+aSum/2)/aSum;
+                }
+                d[c] = (unsigned char)sum;
+            }
+        }
+}
@@ -13,18 +13,20 @@ _model::_model()
 _model::~_model()
 {
     //dtor
+    _textureRegistry::release(tex);
 }
 void _model::initModel(char* fileName)
 {
     glEnable(GL_TEXTURE_2D);
     glEnable(GL_COLOR_MATERIAL);
-    mytex->loadTexture(fileName);
+    _textureRegistry::release(tex);
+    tex = _textureRegistry::acquire(fileName);
 }
 
 
 void _model::drawModel()
 {
-    mytex->textureBinder();
+    glBindTexture(GL_TEXTURE_2D,tex);
     glPushMatrix();
 
  //   glColor3f(1.0,0.6,0.6);
@@ -0,0 +1,120 @@
+#include "_overdraw.h"
+#include "_timer.h"
+
+// cold to hot, index is the number of writes (last entry is OVERDRAW_LEVELS or more)
+static const float heatRamp[OVERDRAW_LEVELS+1][3] =
+{
+    {0.0f, 0.0f, 0.0f}, // never written
+    {0.0f, 0.0f, 0.6f},
+    {0.0f, 0.5f, 1.0f},
+    {0.0f, 0.8f, 0.0f},
+    {0.8f, 0.9f, 0.0f},
+    {1.0f, 0.5f, 0.0f},
+    {1.0f, 0.0f, 0.0f},
+    {1.0f, 0.0f, 1.0f},
+    {1.0f, 1.0f, 1.0f},
+};
+
+_overdraw::_overdraw()
+{
+    //ctor
+    enabled = false;
+    supported = false;
+    avgOverdraw = 0;
+    maxOverdraw = 0;
+    stream = nullptr;
+    lastLog = 0;
+}
+
+_overdraw::~_overdraw()
+{
+    //dtor
+}
+
+void _overdraw::initOverdraw()
+{
+    GLint bits = 0;
+    glGetIntegerv(GL_STENCIL_BITS,&bits);
+    supported = bits > 0;
+
+    if(!supported) cout<<"overdraw view: no stencil buffer, disabled"<<endl;
+}
+
+void _overdraw::begin()
+{
+    if(!enabled || !supported) return;
+
+    glClearStencil(0);
+    glClear(GL_STENCIL_BUFFER_BIT);
+
+    // every fragment that passes the depth test bumps its pixel, saturating at 255
+    glEnable(GL_STENCIL_TEST);
+    glStencilFunc(GL_ALWAYS,0,0xFF);
+    glStencilOp(GL_KEEP,GL_KEEP,GL_INCR);
+}
+
+void _overdraw::end(int w, int h)
+{
+    if(!enabled || !supported) return;
+
+    glDisable(GL_STENCIL_TEST);
+
+    if(w<=0 || h<=0) return;
+    counts.resize((size_t)w*h);
+
+    // this stalls the pipeline, fine for a debug view
+    glPixelStorei(GL_PACK_ALIGNMENT,1);
+    glReadPixels(0,0,w,h,GL_STENCIL_INDEX,GL_UNSIGNED_BYTE,&counts[0]);
+    glPixelStorei(GL_PACK_ALIGNMENT,4);
+
+    unsigned long long total = 0;
+    int mx = 0;
+    for(size_t i=0; i<counts.size(); i++)
+    {
+        total += counts[i];
+        if(counts[i] > mx) mx = counts[i];
+    }
+    avgOverdraw = (float)((double)total/counts.size());
+    maxOverdraw = mx;
+
+    double now = _timer::nowMs();
+    if(now-lastLog > 1000.0)
+    {
+        cout<<"overdraw: avg "<<avgOverdraw<<" max "<<maxOverdraw<<endl;
+        lastLog = now;
+    }
+}
+
+void _overdraw::drawHeatmap(int w, int h)
+{
+    if(!enabled || !supported) return;
+
+    glPushAttrib(GL_ENABLE_BIT | GL_STENCIL_BUFFER_BIT | GL_CURRENT_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_TEXTURE_2D);
+    glDisable(GL_BLEND);
+    glEnable(GL_STENCIL_TEST);
+    glStencilOp(GL_KEEP,GL_KEEP,GL_KEEP);
+
+    // the same full screen quad for every level, written once
+    streamSpan s = stream->alloc(_glCaps::SPRITES,4,sizeof(streamVertex));
+    if(!s.ptr) { glPopAttrib(); return; }
+    streamVertex *v = (streamVertex*)s.ptr;
+    streamPut(v++,0,0,0,0,0);
+    streamPut(v++,w,0,0,0,0);
+    streamPut(v++,w,h,0,0,0);
+    streamPut(v++,0,h,0,0,0);
+
+    // one quad per level, the stencil picks the pixels that get each color
+    for(int level=0; level<=OVERDRAW_LEVELS; level++)
+    {
+        if(level<OVERDRAW_LEVELS) glStencilFunc(GL_EQUAL,level,0xFF);
+        else                      glStencilFunc(GL_LEQUAL,level,0xFF); // level <= count
+
+        glColor3fv(heatRamp[level]);
+        stream->draw(s,GL_QUADS,4);
+    }
+
+    glPopAttrib();
+}
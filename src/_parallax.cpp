@@ -24,11 +24,6 @@ void _parallax::drawBackground(GLuint textureID, float width, float height)
 {
     glColor3f(1.0,1.0,1.0); // Set color before binding texture
 
-    // <<< MODIFIED >>> Bind the texture using the passed ID
-    glBindTexture(GL_TEXTURE_2D, textureID);
-
-
-
     // Aspect ratio correction might be needed depending on projection setup
     // This calculation (-width/height) assumes a perspective projection centered at 0.
     // Adjust if using ortho or different view setup.
@@ -36,19 +31,27 @@ void _parallax::drawBackground(GLuint textureID, float width, float height)
     float drawWidth = 10.0f * aspectRatio; // Example: Assume background spans view width of 2*aspectRatio at z=-30
     float drawHeight = 6.0f;             // Example: Assume background spans view height of 2 at z=-30
     float drawZ = -10.0f;
-    glBegin(GL_QUADS); // Use GL_QUADS for rectangles
-        glTexCoord2f(xMin,yMax);
-        glVertex3f(-drawWidth/2.0f, -drawHeight/2.0f, drawZ); // Bottom-Left
 
-        glTexCoord2f(xMax,yMax);
-        glVertex3f( drawWidth/2.0f, -drawHeight/2.0f, drawZ); // Bottom-Right
+    // tiled image: only the tiles on screen are resident, xMin scrolls it the same way
+    if (tiles) {
+        tiles->draw(-drawWidth/2.0f, -drawHeight/2.0f, drawWidth/2.0f, drawHeight/2.0f, drawZ, xMin, (int)height);
+        return;
+    }
+
+    // <<< MODIFIED >>> Bind the texture using the passed ID
+    glBindTexture(GL_TEXTURE_2D, textureID);
+
 
-        glTexCoord2f(xMax,yMin);
-        glVertex3f( drawWidth/2.0f,  drawHeight/2.0f, drawZ); // Top-Right
 
-        glTexCoord2f(xMin,yMin);
-        glVertex3f(-drawWidth/2.0f,  drawHeight/2.0f, drawZ); // Top-Left
-    glEnd();
+    streamSpan s = stream->alloc(_glCaps::SPRITES, 4, sizeof(streamVertex));
+    if (s.ptr) {
+        streamVertex *q = (streamVertex*)s.ptr;
+        streamPut(&q[0], -drawWidth/2.0f, -drawHeight/2.0f, drawZ, xMin, yMax); // Bottom-Left
+        streamPut(&q[1],  drawWidth/2.0f, -drawHeight/2.0f, drawZ, xMax, yMax); // Bottom-Right
+        streamPut(&q[2],  drawWidth/2.0f,  drawHeight/2.0f, drawZ, xMax, yMin); // Top-Right
+        streamPut(&q[3], -drawWidth/2.0f,  drawHeight/2.0f, drawZ, xMin, yMin); // Top-Left
+        stream->draw(s, GL_QUADS, 4);
+    }
 
     glBindTexture(GL_TEXTURE_2D, 0); // Unbind texture
 }
@@ -0,0 +1,322 @@
+#include "_particles.h"
+#include "_glcaps.h"
+#include <xmmintrin.h>
+#include <stdlib.h>
+#include <string.h>
+
+_particles::_particles()
+{
+    //ctor
+    count = 0;
+    pSize = 0.03;
+    pZ = -2.0;
+    drag = 1.5;
+    particleTex = 0;
+    vbo = uvVbo = 0;
+    stream = nullptr;
+
+    simulated = drawn = 0;
+    simMs = drawMs = 0;
+
+    // the kernel runs in blocks of 4 past count, those slots must hold numbers
+    memset(posX,0,sizeof(posX));
+    memset(posY,0,sizeof(posY));
+    memset(velX,0,sizeof(velX));
+    memset(velY,0,sizeof(velY));
+    memset(life,0,sizeof(life));
+    memset(invLife,0,sizeof(invLife));
+    memset(colR,0,sizeof(colR));
+    memset(colG,0,sizeof(colG));
+    memset(colB,0,sizeof(colB));
+    memset(colA,0,sizeof(colA));
+}
+
+_particles::~_particles()
+{
+    //dtor
+    if(particleTex) glDeleteTextures(1,&particleTex);
+    if(vbo) _glext::DeleteBuffers(1,&vbo);
+    if(uvVbo) _glext::DeleteBuffers(1,&uvVbo);
+}
+
+void _particles::initParticles()
+{
+    // small soft dot, only the alpha channel is needed since color comes from the vertices
+    const int S = 32;
+    unsigned char dot[S*S];
+
+    for(int y=0; y<S; y++)
+        for(int x=0; x<S; x++)
+        {
+            float dx = (x+0.5f)/S*2.0f-1.0f;
+            float dy = (y+0.5f)/S*2.0f-1.0f;
+            float d = 1.0f-sqrt(dx*dx+dy*dy);
+            dot[y*S+x] = (unsigned char)(d>0? d*d*255.0f : 0);
+        }
+
+    glGenTextures(1,&particleTex);
+    glBindTexture(GL_TEXTURE_2D,particleTex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT,1);
+    glTexImage2D(GL_TEXTURE_2D,0,GL_ALPHA,S,S,0,GL_ALPHA,GL_UNSIGNED_BYTE,dot);
+    glPixelStorei(GL_UNPACK_ALIGNMENT,4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D,0);
+
+    // texture coordinates never change, fill them once
+    for(int i=0; i<MAX_PARTICLES; i++)
+    {
+        float *t = &uvs[i*8];
+        t[0]=0; t[1]=0;  t[2]=1; t[3]=0;  t[4]=1; t[5]=1;  t[6]=0; t[7]=1;
+    }
+
+    // buffer path: static uvs once, positions and colors are respecified every frame
+    if(_glext::hasVBO)
+    {
+        _glext::GenBuffers(1,&uvVbo);
+        _glext::BindBuffer(GL_ARRAY_BUFFER,uvVbo);
+        _glext::BufferData(GL_ARRAY_BUFFER,sizeof(uvs),uvs,GL_STATIC_DRAW);
+
+        _glext::GenBuffers(1,&vbo);
+        _glext::BindBuffer(GL_ARRAY_BUFFER,vbo);
+        _glext::BufferData(GL_ARRAY_BUFFER,sizeof(verts)+sizeof(cols),nullptr,GL_STREAM_DRAW);
+        _glext::BindBuffer(GL_ARRAY_BUFFER,0);
+    }
+}
+
+void _particles::emit(vec3 p, int n, float r, float g, float b)
+{
+    for(int i=0; i<n && count<MAX_PARTICLES; i++)
+    {
+        float ang = (rand()%360)*PI/180.0;
+        float spd = 0.2f + (rand()%100)/100.0f * 0.8f;
+        float lf  = 0.4f + (rand()%100)/100.0f * 0.6f;
+
+        posX[count] = p.x;
+        posY[count] = p.y;
+        velX[count] = cos(ang)*spd;
+        velY[count] = sin(ang)*spd;
+        life[count] = lf;
+        invLife[count] = 1.0f/lf;
+        colR[count] = r;
+        colG[count] = g;
+        colB[count] = b;
+        colA[count] = 1.0f;
+        count++;
+    }
+}
+
+void _particles::kill(int i)
+{
+    count--;
+    posX[i] = posX[count];  posY[i] = posY[count];
+    velX[i] = velX[count];  velY[i] = velY[count];
+    life[i] = life[count];  invLife[i] = invLife[count];
+    colR[i] = colR[count];  colG[i] = colG[count];
+    colB[i] = colB[count];  colA[i] = colA[count];
+}
+
+void _particles::update(float dt)
+{
+    double start = _timer::nowMs();
+
+    const __m128 vDt   = _mm_set1_ps(dt);
+    const __m128 vGrav = _mm_set1_ps(-GRAVITY*0.1f*dt); // gravity scaled down to screen units
+    const __m128 vDrag = _mm_set1_ps(1.0f-drag*dt);
+    const __m128 vCool = _mm_set1_ps(1.0f-1.5f*dt);     // green drains out so sparks go orange to red
+    const __m128 vZero = _mm_setzero_ps();
+
+    // round up to the SIMD width, slots past count are dead and safe to touch
+    int n = (count+3) & ~3;
+
+    for(int i=0; i<n; i+=4)
+    {
+        __m128 vx = _mm_mul_ps(_mm_loadu_ps(&velX[i]), vDrag);
+        __m128 vy = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&velY[i]), vDrag), vGrav);
+        _mm_storeu_ps(&velX[i], vx);
+        _mm_storeu_ps(&velY[i], vy);
+
+        _mm_storeu_ps(&posX[i], _mm_add_ps(_mm_loadu_ps(&posX[i]), _mm_mul_ps(vx, vDt)));
+        _mm_storeu_ps(&posY[i], _mm_add_ps(_mm_loadu_ps(&posY[i]), _mm_mul_ps(vy, vDt)));
+
+        __m128 lf = _mm_sub_ps(_mm_loadu_ps(&life[i]), vDt);
+        _mm_storeu_ps(&life[i], lf);
+
+        _mm_storeu_ps(&colA[i], _mm_max_ps(_mm_mul_ps(lf, _mm_loadu_ps(&invLife[i])), vZero));
+        _mm_storeu_ps(&colG[i], _mm_mul_ps(_mm_loadu_ps(&colG[i]), vCool));
+    }
+
+    // remove the dead ones, kill() pulls a new particle into i so don't advance
+    for(int i=0; i<count; )
+    {
+        if(life[i]<=0) kill(i);
+        else i++;
+    }
+
+    simulated += count;
+    simMs += _timer::nowMs()-start;
+}
+
+void _particles::drawParticles()
+{
+    if(count==0) return;
+
+    double start = _timer::nowMs();
+    int path = _glCaps::paths[_glCaps::PARTICLES];
+    if(path==_glCaps::PATH_VBO && !vbo) path = _glCaps::PATH_CLIENT_ARRAYS;
+
+    // the ring takes interleaved vertices written straight into mapped memory
+    streamSpan ring = {nullptr, 0, 0, 0};
+    if(path==_glCaps::PATH_PERSISTENT)
+    {
+        if(stream) ring = stream->alloc(_glCaps::PARTICLES,count*4,sizeof(streamColorVertex));
+        if(!ring.ptr) path = _glCaps::PATH_CLIENT_ARRAYS;
+    }
+
+    if(ring.ptr)
+    {
+        streamColorVertex *v = (streamColorVertex*)ring.ptr;
+        for(int i=0; i<count; i++)
+        {
+            float x0 = posX[i]-pSize, x1 = posX[i]+pSize;
+            float y0 = posY[i]-pSize, y1 = posY[i]+pSize;
+            const float xs[4] = {x0,x1,x1,x0}, ys[4] = {y0,y0,y1,y1};
+            const float us[4] = {0,1,1,0},     vs[4] = {0,0,1,1};
+
+            for(int k=0; k<4; k++, v++)
+            {
+                v->x = xs[k]; v->y = ys[k]; v->z = pZ;
+                v->u = us[k]; v->v = vs[k];
+                v->r = colR[i]; v->g = colG[i]; v->b = colB[i]; v->a = colA[i];
+            }
+        }
+    }
+    else if(path!=_glCaps::PATH_IMMEDIATE)
+        for(int i=0; i<count; i++)
+        {
+            float x0 = posX[i]-pSize, x1 = posX[i]+pSize;
+            float y0 = posY[i]-pSize, y1 = posY[i]+pSize;
+
+            float *v = &verts[i*12];
+            v[0]=x0; v[1]=y0;  v[2]=pZ;
+            v[3]=x1; v[4]=y0;  v[5]=pZ;
+            v[6]=x1; v[7]=y1;  v[8]=pZ;
+            v[9]=x0; v[10]=y1; v[11]=pZ;
+
+            float *c = &cols[i*16];
+            for(int k=0; k<4; k++)
+            {
+                c[k*4+0] = colR[i];
+                c[k*4+1] = colG[i];
+                c[k*4+2] = colB[i];
+                c[k*4+3] = colA[i];
+            }
+        }
+
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_CURRENT_BIT);
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+    glDisable(GL_LIGHTING);
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA,GL_ONE); // additive, sparks brighten what's behind them
+    glDepthMask(GL_FALSE);
+
+    glBindTexture(GL_TEXTURE_2D,particleTex);
+
+    if(ring.ptr)
+    {
+        stream->draw(ring,GL_QUADS,count*4);
+    }
+    else if(path==_glCaps::PATH_IMMEDIATE)
+    {
+        glBegin(GL_QUADS);
+        for(int i=0; i<count; i++)
+        {
+            float x0 = posX[i]-pSize, x1 = posX[i]+pSize;
+            float y0 = posY[i]-pSize, y1 = posY[i]+pSize;
+            glColor4f(colR[i],colG[i],colB[i],colA[i]);
+            glTexCoord2f(0,0); glVertex3f(x0,y0,pZ);
+            glTexCoord2f(1,0); glVertex3f(x1,y0,pZ);
+            glTexCoord2f(1,1); glVertex3f(x1,y1,pZ);
+            glTexCoord2f(0,1); glVertex3f(x0,y1,pZ);
+        }
+        glEnd();
+    }
+    else
+    {
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+
+        if(path==_glCaps::PATH_VBO)
+        {
+            size_t vBytes = (size_t)count*12*sizeof(float);
+            size_t cBytes = (size_t)count*16*sizeof(float);
+
+            _glext::BindBuffer(GL_ARRAY_BUFFER,uvVbo);
+            glTexCoordPointer(2,GL_FLOAT,0,(const GLvoid*)0);
+
+            // orphan last frame's storage so the driver doesn't wait for it to be drawn
+            _glext::BindBuffer(GL_ARRAY_BUFFER,vbo);
+            _glext::BufferData(GL_ARRAY_BUFFER,sizeof(verts)+sizeof(cols),nullptr,GL_STREAM_DRAW);
+            _glext::BufferSubData(GL_ARRAY_BUFFER,0,vBytes,verts);
+            _glext::BufferSubData(GL_ARRAY_BUFFER,sizeof(verts),cBytes,cols);
+            glVertexPointer(3,GL_FLOAT,0,(const GLvoid*)0);
+            glColorPointer(4,GL_FLOAT,0,(const GLvoid*)sizeof(verts));
+        }
+        else
+        {
+            glVertexPointer(3,GL_FLOAT,0,verts);
+            glTexCoordPointer(2,GL_FLOAT,0,uvs);
+            glColorPointer(4,GL_FLOAT,0,cols);
+        }
+
+        glDrawArrays(GL_QUADS,0,count*4);
+
+        if(path==_glCaps::PATH_VBO) _glext::BindBuffer(GL_ARRAY_BUFFER,0);
+    }
+
+    glBindTexture(GL_TEXTURE_2D,0);
+    glPopClientAttrib();
+    glPopAttrib();
+
+    drawn += count;
+    drawMs += _timer::nowMs()-start;
+}
+
+void _particles::benchmark(int frames, _streamBuffer *ring)
+{
+    // a pool of its own, the game's sparks carry on untouched
+    _particles *bench = new _particles();
+    bench->initParticles();
+    bench->stream = ring;
+
+    vec3 origin = {0,0,bench->pZ};
+
+    // simulation only, topping the pool up every frame so the kernel always runs full
+    for(int f=0; f<frames; f++)
+    {
+        bench->emit(origin, MAX_PARTICLES-bench->count, 1.0f, 0.8f, 0.3f);
+        bench->update(1.0f/60.0f);
+    }
+
+    // drawing only, glFinish keeps the GPU work inside the measured window
+    bench->emit(origin, MAX_PARTICLES-bench->count, 1.0f, 0.8f, 0.3f);
+    double start = _timer::nowMs();
+    for(int f=0; f<frames; f++)
+    {
+        // every iteration is a frame as far as the vertex ring is concerned
+        if(ring) ring->beginFrame();
+        bench->drawParticles();
+        if(ring) ring->endFrame();
+        glFinish();
+    }
+    double drawTotal = _timer::nowMs()-start;
+
+    cout<<"particles: "<<frames<<" frames, pool "<<MAX_PARTICLES<<", drawn with "<<_glCaps::pathName(_glCaps::PARTICLES)<<endl;
+    cout<<"  simulated per ms: "<<(bench->simMs>0? bench->simulated/bench->simMs : 0)<<endl;
+    cout<<"  drawn per ms:     "<<(drawTotal>0? bench->drawn/drawTotal : 0)<<endl;
+
+    delete bench;
+}
@@ -62,23 +62,32 @@ void _player::drawPlayer(GLuint textureID)
     // <<< REMOVED >>> pTex->textureBinder();
 
     glPushMatrix();
-        glTranslatef(plPos.x, plPos.y, plPos.z);
-        glScalef(plScl.x, plScl.y, plScl.z);
-
-        glBegin(GL_QUADS);
-            // Define UV coords based on current animation frame (calculated in playerActions)
-            glTexCoord2f(xMin, yMax); // Bottom-Left UV
-            glVertex3f(vert[0].x, vert[0].y, vert[0].z); // Bottom-Left Pos
-
-            glTexCoord2f(xMax, yMax); // Bottom-Right UV
-            glVertex3f(vert[1].x, vert[1].y, vert[1].z); // Bottom-Right Pos
-
-            glTexCoord2f(xMax, yMin); // Top-Right UV
-            glVertex3f(vert[2].x, vert[2].y, vert[2].z); // Top-Right Pos
-
-            glTexCoord2f(xMin, yMin); // Top-Left UV
-            glVertex3f(vert[3].x, vert[3].y, vert[3].z); // Top-Left Pos
-        glEnd();
+        if (graph && node >= 0) {
+            glMultMatrixf(graph->world[node]); // built once in the scene graph, only when plPos/plScl change
+        } else {
+            glTranslatef(plPos.x, plPos.y, plPos.z);
+            glScalef(plScl.x, plScl.y, plScl.z);
+        }
+
+        // only the visible part of the frame, the rest would be blended at zero alpha
+        trimRect r = {0,0,1,1};
+        if (trim) r = trim->frame(xMin, yMin);
+        float u0 = xMin + r.x0*(xMax-xMin), u1 = xMin + r.x1*(xMax-xMin);
+        float v0 = yMin + r.y0*(yMax-yMin), v1 = yMin + r.y1*(yMax-yMin);
+        float x0 = vert[0].x + r.x0*(vert[1].x-vert[0].x), x1 = vert[0].x + r.x1*(vert[1].x-vert[0].x);
+        float y0 = vert[3].y - r.y0*(vert[3].y-vert[0].y), y1 = vert[3].y - r.y1*(vert[3].y-vert[0].y);
+
+        // written straight into this frame's stream memory, drawn under the current matrix
+        streamSpan s = stream->alloc(_glCaps::SPRITES, 4, sizeof(streamVertex));
+        if (s.ptr) {
+            streamVertex *q = (streamVertex*)s.ptr;
+            // UV coords come from the current animation frame (calculated in playerActions)
+            streamPut(&q[0], x0, y1, vert[0].z, u0, v1); // Bottom-Left
+            streamPut(&q[1], x1, y1, vert[1].z, u1, v1); // Bottom-Right
+            streamPut(&q[2], x1, y0, vert[2].z, u1, v0); // Top-Right
+            streamPut(&q[3], x0, y0, vert[3].z, u0, v0); // Top-Left
+            stream->draw(s, GL_QUADS, 4);
+        }
 
     glPopMatrix();
 
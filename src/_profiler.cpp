@@ -0,0 +1,209 @@
+#include "_profiler.h"
+#include "_timer.h"
+#include "_glcaps.h"
+#include "_renderstats.h"
+#include <stdio.h>
+
+const char *_profiler::passNames[_profiler::PASS_COUNT] =
+    {"frame", "background", "player", "enemies", "bullets", "particles", "present", "text"};
+
+_profiler::_profiler()
+{
+    //ctor
+    gpuEnabled = false;
+    timestamps = false;
+    slot = 0;
+    frame = 0;
+    elapsedOpen = false;
+    startMs = _timer::nowMs();
+    gpuBase = 0;
+    gpuBaseCpu = 0;
+    eventHead = eventCount = 0;
+
+    for(int p=0; p<PASS_COUNT; p++)
+    {
+        cpuMs[p] = gpuMs[p] = 0;
+        passStart[p] = 0;
+    }
+    for(int s=0; s<PROF_FRAMES; s++)
+    {
+        slotFrame[s] = -1;
+        for(int p=0; p<PASS_COUNT; p++)
+        {
+            issued[s][p] = false;
+            issuedCpu[s][p] = 0;
+            queries[s][p][0] = queries[s][p][1] = 0;
+        }
+    }
+}
+
+_profiler::~_profiler()
+{
+    //dtor
+    if(gpuEnabled) _glext::DeleteQueries(PROF_FRAMES*PASS_COUNT*2,&queries[0][0][0]);
+}
+
+void _profiler::initProfiler()
+{
+    if(_glCaps::paths[_glCaps::GPU_TIMING]==_glCaps::PATH_NONE) return;
+
+    _glext::GenQueries(PROF_FRAMES*PASS_COUNT*2,&queries[0][0][0]);
+    gpuEnabled = true;
+    timestamps = _glCaps::paths[_glCaps::GPU_TIMING]==_glCaps::PATH_TIMESTAMP;
+}
+
+void _profiler::addEvent(long frm, int pass, int gpu, double start, double ms)
+{
+    event &e = events[eventHead];
+    e.frame = frm;
+    e.pass = pass;
+    e.gpu = gpu;
+    e.start = start;
+    e.ms = ms;
+
+    eventHead = (eventHead+1)%PROF_EVENTS;
+    if(eventCount < PROF_EVENTS) eventCount++;
+}
+
+void _profiler::collect(int s)
+{
+    if(slotFrame[s] < 0) return;
+
+    for(int p=0; p<PASS_COUNT; p++)
+    {
+        if(!issued[s][p]) continue;
+        issued[s][p] = false;
+
+        // last query of the pass, if that one is done the first is too
+        GLuint last = timestamps? queries[s][p][1] : queries[s][p][0];
+        GLint ready = 0;
+        _glext::GetQueryObjectiv(last,GL_QUERY_RESULT_AVAILABLE,&ready);
+        if(!ready) continue; // still in flight after PROF_FRAMES, drop it rather than stall
+
+        double ms, start;
+        if(timestamps)
+        {
+            GLuint64 t0 = 0, t1 = 0;
+            _glext::GetQueryObjectui64v(queries[s][p][0],GL_QUERY_RESULT,&t0);
+            _glext::GetQueryObjectui64v(queries[s][p][1],GL_QUERY_RESULT,&t1);
+            if(gpuBase == 0) { gpuBase = t0; gpuBaseCpu = issuedCpu[s][p]; }
+
+            ms = (t1-t0)/1.0e6;
+            start = gpuBaseCpu + (double)(GLint64)(t0-gpuBase)/1.0e6;
+        }
+        else
+        {
+            GLuint64 ns = 0;
+            _glext::GetQueryObjectui64v(queries[s][p][0],GL_QUERY_RESULT,&ns);
+            ms = ns/1.0e6;
+            start = issuedCpu[s][p]; // elapsed queries have no position, borrow the cpu one
+        }
+
+        gpuMs[p] = gpuMs[p]*0.9 + ms*0.1;
+        addEvent(slotFrame[s], p, 1, start, ms);
+    }
+}
+
+void _profiler::beginFrame()
+{
+    frame++;
+    slot = frame%PROF_FRAMES;
+
+    // this set was issued PROF_FRAMES ago, read it before it gets reused
+    if(gpuEnabled) collect(slot);
+    slotFrame[slot] = frame;
+
+    beginPass(FRAME);
+}
+
+void _profiler::endFrame()
+{
+    endPass(FRAME);
+}
+
+void _profiler::beginPass(int p)
+{
+    passStart[p] = _timer::nowMs();
+    if(p!=FRAME) _glTrace::group(passNames[p]); // the replay times the trace by pass
+    if(p!=FRAME) _renderStats::beginPass(p);
+
+    if(!gpuEnabled) return;
+
+    if(timestamps)
+    {
+        _glext::QueryCounter(queries[slot][p][0],GL_TIMESTAMP);
+    }
+    else
+    {
+        // elapsed queries can't nest, so without timestamps the whole-frame pass is cpu only
+        if(p==FRAME || elapsedOpen) return;
+        _glext::BeginQuery(GL_TIME_ELAPSED_EXT,queries[slot][p][0]);
+        elapsedOpen = true;
+    }
+    issued[slot][p] = true;
+    issuedCpu[slot][p] = passStart[p]-startMs;
+}
+
+void _profiler::endPass(int p)
+{
+    if(p!=FRAME) _glTrace::group(nullptr);
+    if(p!=FRAME) _renderStats::endPass();
+    double now = _timer::nowMs();
+    double ms = now-passStart[p];
+    cpuMs[p] = cpuMs[p]*0.9 + ms*0.1;
+    addEvent(frame, p, 0, passStart[p]-startMs, ms);
+
+    if(!gpuEnabled || !issued[slot][p]) return;
+
+    if(timestamps)
+    {
+        _glext::QueryCounter(queries[slot][p][1],GL_TIMESTAMP);
+    }
+    else
+    {
+        _glext::EndQuery(GL_TIME_ELAPSED_EXT);
+        elapsedOpen = false;
+    }
+}
+
+void _profiler::report()
+{
+    printf("%-12s %10s %10s\n","pass","cpu ms","gpu ms");
+    for(int p=0; p<PASS_COUNT; p++)
+    {
+        if(gpuEnabled) printf("%-12s %10.3f %10.3f\n",passNames[p],cpuMs[p],gpuMs[p]);
+        else           printf("%-12s %10.3f %10s\n",passNames[p],cpuMs[p],"n/a");
+    }
+    fflush(stdout);
+
+    // numbers only mean something next to the paths they were measured on
+    _glCaps::log();
+}
+
+bool _profiler::exportTimeline(const char *fileName)
+{
+    FILE *f = fopen(fileName,"w");
+    if(!f)
+    {
+        cout<<"profiler: could not write "<<fileName<<endl;
+        return false;
+    }
+
+    fprintf(f,"{\"traceEvents\":[\n");
+    fprintf(f,"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"cpu\"}},\n");
+    fprintf(f,"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"gpu\"}}");
+
+    // oldest first
+    int first = (eventHead-eventCount+PROF_EVENTS)%PROF_EVENTS;
+    for(int i=0; i<eventCount; i++)
+    {
+        const event &e = events[(first+i)%PROF_EVENTS];
+        fprintf(f,",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%ld}}",
+                passNames[e.pass], e.gpu+1, e.start*1000.0, e.ms*1000.0, e.frame);
+    }
+    fprintf(f,"\n]}\n");
+    fclose(f);
+
+    cout<<"profiler: "<<eventCount<<" events written to "<<fileName<<endl;
+    return true;
+}
@@ -0,0 +1,148 @@
+#include "_renderstats.h"
+#include <string.h>
+
+const char *_renderStats::counterNames[_renderStats::COUNTER_COUNT] =
+    {"draws", "binds", "states", "vertices", "texels"};
+const char *_renderStats::stateNames[RSTATS_STATES] =
+    {"landing", "menu", "help", "game", "paused"};
+
+long long _renderStats::counts[_profiler::PASS_COUNT][_renderStats::COUNTER_COUNT];
+long long _renderStats::last[_renderStats::COUNTER_COUNT];
+_renderStats::stateTotals _renderStats::states[RSTATS_STATES];
+int _renderStats::pass = _profiler::FRAME;
+GLuint _renderStats::compiling = 0;
+bool _renderStats::executing = false;
+std::map<GLuint, _renderStats::listCost> _renderStats::lists;
+FILE *_renderStats::file = nullptr;
+bool _renderStats::json = false;
+long long _renderStats::frameCount = 0;
+
+bool _renderStats::open(const char *fileName)
+{
+    file = fopen(fileName,"w");
+    if(!file)
+    {
+        cout<<"stats: can't write "<<fileName<<endl;
+        return false;
+    }
+
+    const char *ext = strrchr(fileName,'.');
+    json = ext && !strcmp(ext,".json");
+    if(!json)
+    {
+        fprintf(file,"frame,state,pass");
+        for(int c=0; c<COUNTER_COUNT; c++) fprintf(file,",%s",counterNames[c]);
+        fprintf(file,"\n");
+    }
+    cout<<"stats: writing every frame to "<<fileName<<endl;
+    return true;
+}
+
+void _renderStats::close()
+{
+    if(!file) return;
+    fclose(file);
+    file = nullptr;
+    report();
+}
+
+void _renderStats::beginList(GLuint list, bool execute)
+{
+    compiling = list;
+    executing = execute;
+    memset(&lists[list],0,sizeof(listCost));
+}
+
+void _renderStats::endList()
+{
+    compiling = 0;
+}
+
+void _renderStats::callList(GLuint list)
+{
+    std::map<GLuint, listCost>::iterator it = lists.find(list);
+    if(it==lists.end()) return;
+    for(int c=0; c<COUNTER_COUNT; c++) add(c,it->second.c[c]);
+}
+
+void _renderStats::deleteLists(GLuint list, GLsizei range)
+{
+    for(GLsizei i=0; i<range; i++) lists.erase(list+i);
+}
+
+void _renderStats::addToList(int c, long long n)
+{
+    lists[compiling].c[c] += n;
+    if(executing) counts[pass][c] += n;
+}
+
+void _renderStats::frame(int state)
+{
+    long long total[COUNTER_COUNT] = {};
+    for(int p=0; p<_profiler::PASS_COUNT; p++)
+        for(int c=0; c<COUNTER_COUNT; c++) total[c] += counts[p][c];
+
+    if(state>=0 && state<RSTATS_STATES)
+    {
+        stateTotals &s = states[state];
+        s.frames++;
+        for(int c=0; c<COUNTER_COUNT; c++)
+        {
+            s.sum[c] += total[c];
+            if(total[c]>s.peak[c]) s.peak[c] = total[c];
+        }
+    }
+    const char *name = state>=0 && state<RSTATS_STATES? stateNames[state] : "unknown";
+
+    if(file && json)
+    {
+        // one object per line, passes that did nothing are left out
+        fprintf(file,"{\"frame\":%lld,\"state\":\"%s\",\"total\":{",frameCount,name);
+        for(int c=0; c<COUNTER_COUNT; c++) fprintf(file,"%s\"%s\":%lld",c? "," : "",counterNames[c],total[c]);
+        fprintf(file,"},\"passes\":{");
+        bool first = true;
+        for(int p=0; p<_profiler::PASS_COUNT; p++)
+        {
+            if(!counts[p][DRAWS] && !counts[p][BINDS] && !counts[p][STATES] && !counts[p][TEXELS]) continue;
+            fprintf(file,"%s\"%s\":{",first? "" : ",",_profiler::passNames[p]);
+            for(int c=0; c<COUNTER_COUNT; c++) fprintf(file,"%s\"%s\":%lld",c? "," : "",counterNames[c],counts[p][c]);
+            fprintf(file,"}");
+            first = false;
+        }
+        fprintf(file,"}}\n");
+    }
+    else if(file)
+    {
+        // a row per busy pass, then the frame total
+        for(int p=0; p<_profiler::PASS_COUNT; p++)
+        {
+            if(!counts[p][DRAWS] && !counts[p][BINDS] && !counts[p][STATES] && !counts[p][TEXELS]) continue;
+            fprintf(file,"%lld,%s,%s",frameCount,name,_profiler::passNames[p]);
+            for(int c=0; c<COUNTER_COUNT; c++) fprintf(file,",%lld",counts[p][c]);
+            fprintf(file,"\n");
+        }
+        fprintf(file,"%lld,%s,total",frameCount,name);
+        for(int c=0; c<COUNTER_COUNT; c++) fprintf(file,",%lld",total[c]);
+        fprintf(file,"\n");
+    }
+
+    memcpy(last,total,sizeof(last));
+    memset(counts,0,sizeof(counts));
+    frameCount++;
+}
+
+void _renderStats::report()
+{
+    printf("%-8s %7s", "state", "frames");
+    for(int c=0; c<COUNTER_COUNT; c++) printf(" %10s %10s", counterNames[c], "max");
+    printf("\n");
+
+    for(int s=0; s<RSTATS_STATES; s++)
+    {
+        if(!states[s].frames) continue;
+        printf("%-8s %7lld", stateNames[s], states[s].frames);
+        for(int c=0; c<COUNTER_COUNT; c++)
+            printf(" %10.1f %10lld", (double)states[s].sum[c]/states[s].frames, states[s].peak[c]);
+        printf("\n");
+    }
+}
@@ -7,6 +7,8 @@
 #include <string>
 #include <iostream>
 #include <vector>
+#include <cstdio>
+#include <cmath>
 
 
 // constructor: initializes variables when a _scene object is created
@@ -30,22 +32,74 @@ _scene::_scene()
     background = nullptr;
     gameInputs = nullptr;
     gameTimer = nullptr;
+    collisionChecker = nullptr;
+    particles = nullptr;
+    dynRes = nullptr;
+    hud = nullptr;
+    lights = nullptr;
+    profiler = nullptr;
+    overdraw = nullptr;
+
+    // a worker per core: startup decodes run side by side, later ones (variants, tiles, uploads) stay off the frame
+    jobs = new _jobQueue(_jobQueue::cores());
+    uploads = new _uploadQueue(jobs);
+    pack = new _assetPack();
+    uploads->pack = pack;
+    variants = new _assetVariants(uploads);
+    stream = new _streamBuffer();
+    capture = new _capture(jobs);
+    softRaster = new _softRasterGL();
+    graph = new _sceneGraph();
+    tilemap = new _tilemap();
+    backgroundTiles = new _virtualTexture(jobs);
+
+    // frame grids of the sprite sheets (player.png 4x2, mon.png 7x2, b.png single image)
+    playerTrim = new _spriteTrim(4, 2);
+    enemyTrim = new _spriteTrim(7, 2);
+    bulletTrim = new _spriteTrim(1, 1);
 
     // initialize game-specific texture ids
     playerTextureID = 0;
     enemyTextureID = 0;
     bulletTextureID = 0;
+    bulletMipLevels = 1;
     backgroundTextureID = 0;
+    wallTextureID = 0;
 
 }
 
 // destructor: cleans up memory when the _scene object is destroyed
 _scene::~_scene()
 {
+    // stop the workers before anything their jobs point at goes away
+    delete jobs;
+    jobs = nullptr;
+    delete variants;
+    variants = nullptr;
+    delete uploads; // after the jobs too, a worker may still be copying into a mapped buffer
+    uploads = nullptr;
+    delete pack; // after the jobs and uploads, both read from its mapping
+    pack = nullptr;
+    delete capture; // after the jobs, a worker may still be writing from a mapped buffer
+    capture = nullptr;
+    delete softRaster;
+    softRaster = nullptr;
+    delete graph;
+    graph = nullptr;
+    delete tilemap;
+    tilemap = nullptr;
+    delete backgroundTiles; // after the jobs too, their done functions upload into its cache
+    backgroundTiles = nullptr;
+
     // delete the texture loader object
     delete texLoader;
     texLoader = nullptr; // set pointer to null after deleting
 
+    // hand back the scene's texture references, the registry deletes what nobody else holds
+    GLuint textures[] = { landingTextureID, fontTextureID, menuBackgroundTextureID, helpTextureID, playerTextureID,
+                          enemyTextureID, bulletTextureID, backgroundTextureID, wallTextureID };
+    for (GLuint t : textures) _textureRegistry::release(t);
+
     // delete other game objects
     delete player;
     player = nullptr;
@@ -55,6 +109,28 @@ _scene::~_scene()
     gameInputs = nullptr;
     delete gameTimer;
     gameTimer = nullptr;
+    delete collisionChecker;
+    collisionChecker = nullptr;
+    delete particles;
+    particles = nullptr;
+    delete dynRes;
+    dynRes = nullptr;
+    delete hud;
+    hud = nullptr;
+    delete lights;
+    lights = nullptr;
+    delete profiler;
+    profiler = nullptr;
+    delete overdraw;
+    overdraw = nullptr;
+    delete stream;
+    stream = nullptr;
+    delete playerTrim;
+    playerTrim = nullptr;
+    delete enemyTrim;
+    enemyTrim = nullptr;
+    delete bulletTrim;
+    bulletTrim = nullptr;
 
     // loop through the enemies vector and delete each enemy
     for (_enms* enemy : enemies) {
@@ -89,6 +165,17 @@ GLint _scene::initGL()
     // allow material colors to affect lighting
     glEnable(GL_COLOR_MATERIAL);
 
+    // fetch the entry points opengl32.lib doesn't export (framebuffers etc.)
+    _glext::init();
+    // with -gltrace, buffer and framebuffer calls get recorded too
+    _glTrace::hook();
+    // pick and log the fastest path per feature, benchmark numbers are only comparable with this
+    _glCaps::probe();
+    // map the vertex ring now that we know whether buffer storage is there
+    stream->initStream();
+    capture->initCapture();
+    uploads->initUploads();
+
     // get the screen width and height
     dim.x = GetSystemMetrics(SM_CXSCREEN);
     dim.y = GetSystemMetrics(SM_CYSCREEN);
@@ -99,14 +186,35 @@ GLint _scene::initGL()
         return false; // return false if initialization fails
     }
 
+    // baked assets from assetbake -pack: one mapping instead of an open and a decode per file
+    pack->open("images/assets.pak");
+
     // load the background texture for the menu
     if (!loadMenuBackgroundTexture()) {
         // error message is handled inside the function
         return false;
     }
 
+    // the parallax background streams as tiles if assetbake -tiles cut it, otherwise it is one more startup image
+    bool tiledBackground = backgroundTiles->open("images/prlx.jpg");
+
+    // decode and pack every startup image at once on the workers, they're uploaded below in list order
+    std::vector<textureRequest> startup = startupTextures(playerTrim, enemyTrim, bulletTrim, !tiledBackground);
+    double decodeStart = _timer::nowMs();
+    int fromPack = 0;
+    for (textureRequest& r : startup) { // baked ones are uploaded straight from the mapping
+        if (pack->texture(r.fileName.c_str(), r.format, r.mipmaps, r.trim, r.packed, r.base)) {
+            r.ok = true;
+            fromPack++;
+        }
+    }
+    _textureLoader::packAll(jobs, startup);
+    cout << "startup: " << fromPack << " images from the pack, " << startup.size() - fromPack << " decoded on "
+         << jobs->threads << " workers in " << _timer::nowMs() - decodeStart << " ms" << endl;
+    size_t next = 0;
+
     // load the texture for the font
-    texLoader->loadTexture((char*)"images/retro_deco.png");
+    texLoader->upload(startup[next++]);
     if (texLoader->tex == 0) { // check if loading failed
         MessageBox(NULL, "font texture failed to load", "texture load error", MB_OK | MB_ICONERROR);
         return false;
@@ -118,18 +226,9 @@ GLint _scene::initGL()
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); // smooth scaling down
         glBindTexture(GL_TEXTURE_2D, 0); // unbind texture
     }
-    // load the help screen image
-    texLoader->loadTexture((char*)"images/help.png");
-    if (texLoader->tex == 0) {
-        MessageBox(NULL, "help screen texture failed to load", "texture load error", MB_OK | MB_ICONERROR);
-        return false;
-    } else {
-        helpTextureID = texLoader->tex;
-        glBindTexture(GL_TEXTURE_2D, helpTextureID);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glBindTexture(GL_TEXTURE_2D, 0);
-    }
+    // load the help screen image, the smallest copy covering the screen, uploaded in the background
+    helpTextureID = 0;
+    variants->load("images/help.png", (int)dim.x, (int)dim.y, &helpTextureID, _textureLoader::TEX_RGB8);
 
     // load the font data file which describes character positions in the font texture
     if (!loadFontData("images/retro_deco.fnt")) {
@@ -138,12 +237,14 @@ GLint _scene::initGL()
     }
 
     // load the landing page image
-    texLoader->loadTexture((char*)"images/landing_page.png");
+    std::string landingFile = startup[next].fileName; // smallest copy covering the screen
+    texLoader->upload(startup[next++]);
     if (texLoader->tex == 0) {
         MessageBox(NULL, "landing page texture failed to load", "texture load error", MB_OK | MB_ICONERROR);
         return false;
     } else {
         landingTextureID = texLoader->tex;
+        variants->track("images/landing_page.png", landingFile, &landingTextureID, _textureLoader::TEX_RGB8);
         glBindTexture(GL_TEXTURE_2D, landingTextureID);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -151,23 +252,23 @@ GLint _scene::initGL()
     }
 
     // load the player sprite texture
-    texLoader->loadTexture((char*)"images/player.png");
+    texLoader->upload(startup[next++]);
     if (texLoader->tex == 0) {
         MessageBox(NULL, "player.png failed to load", "texture load error", MB_OK | MB_ICONERROR);
         return false;
     } else {
         playerTextureID = texLoader->tex;
         glBindTexture(GL_TEXTURE_2D, playerTextureID);
-        // use nearest neighbor for pixelated look, repeat for wrapping
+        // nearest neighbor for a pixelated look up close, trilinear when drawn smaller than the sheet
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texLoader->minFilter);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glBindTexture(GL_TEXTURE_2D, 0);
     }
 
     // load the enemy sprite texture
-    texLoader->loadTexture((char*)"images/mon.png");
+    texLoader->upload(startup[next++]);
     if (texLoader->tex == 0) {
         MessageBox(NULL, "enemy texture failed to load, images/mon.png", "texture load error", MB_OK | MB_ICONERROR);
         return false;
@@ -175,14 +276,14 @@ GLint _scene::initGL()
         enemyTextureID = texLoader->tex;
         glBindTexture(GL_TEXTURE_2D, enemyTextureID);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texLoader->minFilter);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glBindTexture(GL_TEXTURE_2D, 0);
     }
 
     // load the bullet sprite texture
-    texLoader->loadTexture((char*)"images/b.png");
+    texLoader->upload(startup[next++]);
     if (texLoader->tex == 0) {
         MessageBox(NULL, "bullet texture failed to load, images/b.png", "texture load error", MB_OK | MB_ICONERROR);
         return false;
@@ -190,24 +291,61 @@ GLint _scene::initGL()
         bulletTextureID = texLoader->tex;
         glBindTexture(GL_TEXTURE_2D, bulletTextureID);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texLoader->minFilter); // drawn at 0.15 scale
+        bulletMipLevels = texLoader->mipLevels;
         glBindTexture(GL_TEXTURE_2D, 0);
     }
 
-    // load the parallax background texture
-    texLoader->loadTexture((char*)"images/prlx.jpg");
+    // load the parallax background, if assetbake -tiles cut it only the visible tiles get loaded
+    if (tiledBackground) {
+        backgroundTiles->stream = stream;
+        backgroundTiles->resize((int)dim.x, (int)dim.y);
+    } else {
+        delete backgroundTiles;
+        backgroundTiles = nullptr;
+
+        // the whole image as one texture
+        std::string backgroundFile = startup[next].fileName;
+        texLoader->upload(startup[next++]);
+        if (texLoader->tex == 0) {
+            MessageBox(NULL, "background texture failed to load, images/prlx.jpg", "texture load error", MB_OK | MB_ICONERROR);
+            return false;
+        } else {
+            backgroundTextureID = texLoader->tex;
+            variants->track("images/prlx.jpg", backgroundFile, &backgroundTextureID, _textureLoader::TEX_RGB8);
+            glBindTexture(GL_TEXTURE_2D, backgroundTextureID);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT); // repeat for scrolling
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        }
+    }
+
+    // level tiles, 400x400 drawn at about 50 pixels so they get a mip chain
+    texLoader->upload(startup[next++]);
     if (texLoader->tex == 0) {
-        MessageBox(NULL, "background texture failed to load, images/prlx.jpg", "texture load error", MB_OK | MB_ICONERROR);
+        MessageBox(NULL, "wall texture failed to load, images/wall.png", "texture load error", MB_OK | MB_ICONERROR);
         return false;
     } else {
-        backgroundTextureID = texLoader->tex;
-        glBindTexture(GL_TEXTURE_2D, backgroundTextureID);
+        wallTextureID = texLoader->tex;
+        glBindTexture(GL_TEXTURE_2D, wallTextureID);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT); // repeat for scrolling
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texLoader->minFilter);
         glBindTexture(GL_TEXTURE_2D, 0);
     }
+    const char* mapData;
+    size_t mapSize;
+    if (pack->file("images/level1.map", mapData, mapSize)) {
+        std::istringstream mapText(std::string(mapData, mapSize));
+        tilemap->loadMap(mapText);
+    } else {
+        tilemap->loadMap("images/level1.map"); // no map just means no walls
+    }
+
+    // how much the per-asset formats saved over uploading everything as rgba8
+    _textureLoader::reportMemory();
+    _textureRegistry::report();
 
     // create the player object
     player = new _player();
@@ -215,12 +353,23 @@ GLint _scene::initGL()
         // call player's initialization functions
         player->playerActions(); // likely sets up animation frames or initial state
         player->initPlayer(4, 2); // initialize player properties (maybe grid position?)
+        player->trim = playerTrim; // draw only the visible part of each frame
+        player->stream = stream;
+        player->graph = graph;
+        player->node = graph->create();
+
+        // muzzle on the right edge of the sprite, follows the player through its node
+        muzzleNode = graph->create(player->node);
+        vec3 muzzle = { 1.0f, 0.0f, 0.0f }, none = { 0, 0, 0 }, unit = { 1, 1, 1 };
+        graph->setLocal(muzzleNode, muzzle, none, unit);
     } else { MessageBox(NULL,"player new failed","mem error",MB_OK); return false; } // check memory allocation
 
     // create the parallax background object
     background = new _parallax();
     if (background) {
         background->initPrlx(); // initialize background properties
+        background->stream = stream;
+        background->tiles = backgroundTiles;
     } else { MessageBox(NULL,"background new failed","mem error",MB_OK); return false; }
 
     // create the input handler object
@@ -233,6 +382,51 @@ GLint _scene::initGL()
         // timer might start automatically or need a start call later
     } else { MessageBox(NULL,"timer new failed","mem error",MB_OK); return false; }
 
+    // create the collision checker and the particle pool (the pool never allocates after this)
+    collisionChecker = new _collisionCkeck();
+    particles = new _particles();
+    if (particles) {
+        particles->initParticles(); // builds the spark texture
+        particles->stream = stream;
+    } else { MessageBox(NULL,"particles new failed","mem error",MB_OK); return false; }
+
+    // offscreen target for the game scene, allocated on first use at the window size
+    dynRes = new _dynRes();
+    if (!dynRes) { MessageBox(NULL,"dynamic resolution new failed","mem error",MB_OK); return false; }
+
+    // hud text cached in its own texture, lines are re-rendered only when they change
+    hud = new _uiLayer();
+    if (hud) {
+        hud->measure = [this](const std::string &text) { return textWidth(text); };
+        hud->drawLine = [this](const std::string &text, float x, float y) {
+            glBindTexture(GL_TEXTURE_2D, fontTextureID);
+            textQuads(text, x, y);
+            glBindTexture(GL_TEXTURE_2D, 0);
+        };
+        hud->lineHeight = fontLineHeight;
+        hud->stream = stream;
+    } else { MessageBox(NULL,"hud layer new failed","mem error",MB_OK); return false; }
+
+    // light buffer for bullets, enemies and explosions, needs framebuffer objects
+    lights = new _lightMap();
+    if (lights) {
+        lights->initLights(); // builds the falloff texture
+        lights->stream = stream;
+    } else { MessageBox(NULL,"lights new failed","mem error",MB_OK); return false; }
+
+    // per pass timers, gpu queries only if the driver has timer queries
+    profiler = new _profiler();
+    if (profiler) {
+        profiler->initProfiler();
+    } else { MessageBox(NULL,"profiler new failed","mem error",MB_OK); return false; }
+
+    // overdraw debug view, needs the stencil bits asked for in the pixel format
+    overdraw = new _overdraw();
+    if (overdraw) {
+        overdraw->initOverdraw();
+        overdraw->stream = stream;
+    } else { MessageBox(NULL,"overdraw new failed","mem error",MB_OK); return false; }
+
     // create some enemy objects
     for (int i = 0; i < 2; ++i) { // create 2 enemies
         _enms* enemy = new _enms();
@@ -241,6 +435,11 @@ GLint _scene::initGL()
             vec3 enemyPos = { -0.5f + i * 1.0f, 0.65f, -5.0f };
             enemy->placeEnms(enemyPos); // place the enemy
             enemy->isEnmsLive = true; // mark the enemy as active
+            enemy->initEnms((char*)"images/mon.png"); // the registry hands back enemyTextureID, a reference per enemy
+            enemy->trim = enemyTrim;
+            enemy->stream = stream;
+            enemy->graph = graph;
+            enemy->node = graph->create();
             enemies.push_back(enemy); // add the enemy to the vector
         } else { MessageBox(NULL,"enemy new failed","mem error",MB_OK); /* continue maybe? */ }
     }
@@ -252,6 +451,10 @@ GLint _scene::initGL()
             // set initial position far away (off-screen)
             vec3 initialPos = {0, 0, -100};
             bullet->bInit(initialPos); // initialize bullet state (inactive)
+            bullet->trim = bulletTrim;
+            bullet->stream = stream;
+            bullet->graph = graph;
+            bullet->node = graph->create();
             bullets.push_back(bullet); // add bullet to the vector
         } else { MessageBox(NULL,"bullet new failed","mem error",MB_OK); /* continue maybe? */ }
     }
@@ -275,6 +478,10 @@ void _scene::reSize(GLint width, GLint height)
     // store the new dimensions
     dim.x = width;
     dim.y = height;
+
+    // a different size may want a different copy of the full-screen images
+    if (variants) variants->resize(width, height);
+    if (backgroundTiles) backgroundTiles->resize(width, height);
 }
 
 // sets up an orthographic projection for 2d rendering (ui, overlays)
@@ -311,39 +518,95 @@ void _scene::updateGame(float deltaTime) {
         player->playerActions(); // likely updates animation frame or state based on actiontrigger
     }
 
+    // fade the explosion flashes
+    if (lights) lights->update(deltaTime);
+
     // update background scrolling
     if (background) {
         // scroll the background left at a defined speed
         background->scroll(true, "left", background->speed * deltaTime); // multiply speed by deltatime for frame-rate independence
     }
 
+    // the level scrolls with the background
+    if (tilemap) tilemap->scroll(0.5f * deltaTime);
+
     // update enemy logic
     for (_enms* enemy : enemies) {
         if (enemy && enemy->isEnmsLive) {
-            // placeholder: add enemy movement, ai, shooting logic here
-            // e.g., enemy->update(deltatime);
+            enemy->actions(); // walk/jump animation and movement
         }
     }
 
     // update bullet logic
+    vec3 playerPos = {0,0,0};
+    if (player) playerPos = graph->worldPosition(muzzleNode);
     for (_bullets* bullet : bullets) {
         if (bullet && bullet->bLive) {
-            // placeholder: add bullet movement logic here
-            // e.g., bullet->update(deltatime);
+            bullet->bUpdate(playerPos, bullet->bDes); // moves right, resets at its destination
         }
     }
 
-    // placeholder: add collision detection logic here (player vs enemy, bullet vs enemy, etc.)
+    // bullet vs enemy: spark burst on the hit, bigger burst when the enemy dies
+    for (_bullets* bullet : bullets) {
+        if (!bullet || !bullet->bLive) continue;
+        for (_enms* enemy : enemies) {
+            if (!enemy || !enemy->isEnmsLive) continue;
+            if (collisionChecker && collisionChecker->isRadialCol(bullet->bPos, enemy->pos, 0.1f, 0.2f, 0.0f)) {
+                if (particles) {
+                    particles->emit(bullet->bPos, 40, 1.0f, 0.9f, 0.4f);  // hit sparks
+                    particles->emit(enemy->pos, 150, 1.0f, 0.5f, 0.2f);   // enemy blows up
+                }
+                if (lights) {
+                    vec3 at = { enemy->pos.x, enemy->pos.y, -2.0f };
+                    lights->flash(at, 2.0f, 1.0f, 0.6f, 0.25f, 0.5f);      // explosion flash, fades over half a second
+                }
+                enemy->isEnmsLive = false;
+                score++;
 
+                bullet->actionTrigger = _bullets::HIT;
+                bullet->bActions(); // hides the bullet and puts it back to idle
+                break;
+            }
+        }
+    }
+
+    // move and fade the sparks
+    if (particles) {
+        particles->update(deltaTime);
+    }
 }
 
 // draws the entire scene based on the current state
 GLint _scene::drawScene()
 {
+    // the work this frame takes drives the game scene resolution, see the end of the frame
+    double frameStart = _timer::nowMs();
+
+    if (profiler) profiler->beginFrame();
+    // next region of the vertex ring, waits only if the gpu is frames behind
+    if (stream) stream->beginFrame();
+
+    // f11 frame: every stream draw is also rasterized on the cpu
+    if (softFrame && softRaster && stream) {
+        GLfloat clear[4];
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, clear);
+        softRaster->begin((int)dim.x, (int)dim.y, clear[0], clear[1], clear[2]);
+        stream->soft = softRaster;
+    }
+
+    // finished background decodes get uploaded here, on the gl thread
+    if (jobs) jobs->poll();
+    // uploads whose fence has passed become visible, waiting ones get a pixel buffer
+    if (uploads) uploads->poll();
+
     // clear the color and depth buffers
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glLoadIdentity(); // reset the modelview matrix
 
+    // count every pixel write from here on when the overdraw view is on
+    bool showOverdraw = overdraw && overdraw->enabled && overdraw->supported;
+    if (showOverdraw) overdraw->begin();
+
     // choose what to draw based on the game state
     switch (currentState)
     {
@@ -360,12 +623,7 @@ GLint _scene::drawScene()
                 glBindTexture(GL_TEXTURE_2D, landingTextureID); // select the landing page texture
 
                 // draw a quad covering the whole screen
-                glBegin(GL_QUADS);
-                    glTexCoord2f(0.0, 0.0); glVertex2f(0, 0); // top-left tex coord and vertex
-                    glTexCoord2f(1.0, 0.0); glVertex2f(dim.x, 0); // top-right
-                    glTexCoord2f(1.0, 1.0); glVertex2f(dim.x, dim.y); // bottom-right
-                    glTexCoord2f(0.0, 1.0); glVertex2f(0, dim.y); // bottom-left
-                glEnd();
+                drawScreenQuad(0, 0, dim.x, dim.y); // quad covering the whole screen
 
                 glBindTexture(GL_TEXTURE_2D, 0); // unbind texture
                 glDisable(GL_TEXTURE_2D); // disable texturing
@@ -394,16 +652,13 @@ GLint _scene::drawScene()
                 glColor3f(1.0, 1.0, 1.0); // white color
                 glBindTexture(GL_TEXTURE_2D, helpTextureID); // bind help texture
                 // draw quad for help image
-                glBegin(GL_QUADS);
-                    glTexCoord2f(0.0, 0.0); glVertex2f(0, 0);
-                    glTexCoord2f(1.0, 0.0); glVertex2f(dim.x, 0);
-                    glTexCoord2f(1.0, 1.0); glVertex2f(dim.x, dim.y);
-                    glTexCoord2f(0.0, 1.0); glVertex2f(0, dim.y);
-                glEnd();
+                drawScreenQuad(0, 0, dim.x, dim.y);
                 glBindTexture(GL_TEXTURE_2D, 0);
 
                 // draw help text using the font rendering function
+                if (profiler) profiler->beginPass(_profiler::TEXT);
                 drawText("press [esc] to return to menu", 50, dim.y - 50, 1.0f, 1.0f, 1.0f); // white text at bottom-left
+                if (profiler) profiler->endPass(_profiler::TEXT);
 
                 glDisable(GL_TEXTURE_2D);
                 glDisable(GL_BLEND);
@@ -415,6 +670,33 @@ GLint _scene::drawScene()
             break;
 
         case GAME:
+            // advance the game by the time since the last frame
+            if (gameTimer) {
+                updateGame(gameTimer->getTicks() / (float)CLOCKS_PER_SEC);
+                gameTimer->reset();
+            }
+
+            // world matrices for this frame, only what moved is rebuilt
+            syncGraph();
+
+            // this frame's lights go into the light buffer first, under the game projection
+            if (lights) {
+                if (player) lights->add(graph->worldPosition(player->node), 1.5f, 0.45f, 0.45f, 0.5f);
+                for (_enms* enemy : enemies) {
+                    if (enemy && enemy->isEnmsLive) {
+                        lights->add(graph->worldPosition(enemy->node), 0.6f, 0.5f, 0.15f, 0.6f);
+                    }
+                }
+                for (_bullets* bullet : bullets) {
+                    if (bullet && bullet->bLive) lights->add(graph->worldPosition(bullet->node), 0.4f, 0.6f, 0.5f, 0.2f);
+                }
+                lights->accumulate((int)dim.x, (int)dim.y);
+            }
+
+            // render the world into the scaled target, the hud stays at native size below
+            // (the overdraw view needs the window's stencil buffer, so it renders at native size)
+            if (dynRes && !showOverdraw) dynRes->begin((int)dim.x, (int)dim.y);
+
             // set a green background color for the game area (will be covered by parallax)
             glClearColor(0.0, 0.4, 0.0, 1.0);
             // ensure buffers are cleared (redundant here, but safe)
@@ -429,34 +711,46 @@ GLint _scene::drawScene()
             glColor3f(1.0, 1.0, 1.0); // default color to white
 
             // draw the scrolling background first
+            if (profiler) profiler->beginPass(_profiler::BACKGROUND);
             glPushMatrix();
             glDisable(GL_LIGHTING); // disable lighting for the background image
             if (background) {
                 // call the background's draw function
                 background->drawBackground(backgroundTextureID, dim.x, dim.y);
             }
+            // level walls, only the chunks in view; the view is 45 degrees high at the level's depth
+            if (tilemap) {
+                float halfView = tanf(22.5f * 3.14159265f / 180.0f) * -tilemap->z * (dim.x / (dim.y > 0 ? dim.y : 1));
+                tilemap->draw(wallTextureID, halfView);
+            }
             glEnable(GL_LIGHTING); // re-enable lighting for other objects
             glPopMatrix();
+            if (profiler) profiler->endPass(_profiler::BACKGROUND);
 
             // draw the player
+            if (profiler) profiler->beginPass(_profiler::PLAYER);
             glPushMatrix();
             if (player) {
                 // call the player's draw function, passing its texture
                 player->drawPlayer(playerTextureID);
             }
             glPopMatrix();
+            if (profiler) profiler->endPass(_profiler::PLAYER);
 
             // draw active enemies
+            if (profiler) profiler->beginPass(_profiler::ENEMIES);
             for (_enms* enemy : enemies) {
                 if (enemy && enemy->isEnmsLive) { // only draw if enemy exists and is alive
                     glPushMatrix();
                     // call the enemy's draw function
-                    enemy->drawEnms(enemyTextureID);
+                    enemy->drawEnms(enemy->tex);
                     glPopMatrix();
                 }
             }
+            if (profiler) profiler->endPass(_profiler::ENEMIES);
 
             // draw active bullets
+            if (profiler) profiler->beginPass(_profiler::BULLETS);
             for (_bullets* bullet : bullets) {
                 if (bullet && bullet->bLive) { // only draw if bullet exists and is active
                     glPushMatrix();
@@ -465,12 +759,38 @@ GLint _scene::drawScene()
                     glPopMatrix();
                 }
             }
+            if (profiler) profiler->endPass(_profiler::BULLETS);
+
+            // light the world; sparks are drawn after so they stay at full brightness
+            if (lights) {
+                setOrthoProjection((int)dim.x, (int)dim.y);
+                lights->apply((int)dim.x, (int)dim.y);
+                restorePerspectiveProjection();
+            }
+
+            // draw the sparks on top, the whole pool is a single draw call
+            if (profiler) profiler->beginPass(_profiler::PARTICLES);
+            if (particles) {
+                particles->drawParticles();
+            }
+            if (profiler) profiler->endPass(_profiler::PARTICLES);
 
             // disable states not needed by default after drawing game elements
             glDisable(GL_BLEND);
             glDisable(GL_TEXTURE_2D); // disable textures until needed again
             // lighting and depth test remain enabled usually
 
+            // stretch the scaled scene over the window, then the hud on top
+            if (dynRes) dynRes->end((int)dim.x, (int)dim.y);
+            setOrthoProjection((int)dim.x, (int)dim.y);
+            if (profiler) profiler->beginPass(_profiler::PRESENT);
+            if (dynRes) dynRes->present((int)dim.x, (int)dim.y);
+            if (profiler) profiler->endPass(_profiler::PRESENT);
+            if (profiler) profiler->beginPass(_profiler::TEXT);
+            drawHUD();
+            if (profiler) profiler->endPass(_profiler::TEXT);
+            restorePerspectiveProjection();
+
             break;
 
         case PAUSED:
@@ -489,16 +809,14 @@ GLint _scene::drawScene()
                 float popupWidth = 350; float popupHeight = 100;
                 float popupX = (dim.x - popupWidth) / 2.0f; // center horizontally
                 float popupY = (dim.y - popupHeight) / 2.0f; // center vertically
-                glBegin(GL_QUADS);
-                    glVertex2f(popupX, popupY);
-                    glVertex2f(popupX + popupWidth, popupY);
-                    glVertex2f(popupX + popupWidth, popupY + popupHeight);
-                    glVertex2f(popupX, popupY + popupHeight);
-                glEnd();
+                glBindTexture(GL_TEXTURE_2D, 0); // plain color
+                drawScreenQuad(popupX, popupY, popupWidth, popupHeight);
 
                 // draw pause menu text over the overlay
+                if (profiler) profiler->beginPass(_profiler::TEXT);
                 drawText("quit game?", popupX + 50, popupY + 20, 1.0f, 1.0f, 1.0f); // white text
                 drawText("yes (enter) / no (esc)", popupX + 50, popupY + 50, 1.0f, 1.0f, 1.0f);
+                if (profiler) profiler->endPass(_profiler::TEXT);
 
                 glDisable(GL_TEXTURE_2D);
                 glDisable(GL_BLEND);
@@ -513,12 +831,81 @@ GLint _scene::drawScene()
             break;
     }
 
+    // replace the frame with the write counts
+    if (showOverdraw) {
+        overdraw->end((int)dim.x, (int)dim.y);
+        setOrthoProjection((int)dim.x, (int)dim.y);
+        overdraw->drawHeatmap((int)dim.x, (int)dim.y);
+
+        char line[64];
+        sprintf(line, "overdraw avg %.2f max %d", overdraw->avgOverdraw, overdraw->maxOverdraw);
+        drawText(line, 20, dim.y - 40, 1.0f, 1.0f, 1.0f);
+        glDisable(GL_TEXTURE_2D);
+        glDisable(GL_BLEND);
+        restorePerspectiveProjection();
+    }
+
+    if (softRaster && softRaster->active) {
+        stream->soft = nullptr;
+        softFrame = false;
+        softRaster->finish();
+
+        char name[64];
+        sprintf(name, "soft_%03d.tga", ++softFrames);
+        cout << "soft: " << softRaster->width << "x" << softRaster->height << ", " << softRaster->quads << " quads, bin "
+             << softRaster->binMs << " ms, raster " << softRaster->rasterMs << " ms on " << softRaster->threads << " threads, overdraw avg "
+             << softRaster->avgOverdraw << " max " << softRaster->maxOverdraw << " -> " << name << endl;
+        _capture::writeTGA(name, softRaster->width, softRaster->height, (const unsigned char*)&softRaster->color[0]);
+    }
+
+    // the finished frame, read back into a buffer and written out a few frames later
+    if (capture) capture->frame((int)dim.x, (int)dim.y);
+
+    if (stream) stream->endFrame();
+    if (profiler) profiler->endFrame();
+
+    // cpu time up to the swap, or the gpu's time for the frame when that's longer. not the
+    // present to present interval: under vsync that never drops below the budget, so the
+    // scale could go down but never come back up
+    if (dynRes && currentState == GAME) {
+        double workMs = _timer::nowMs() - frameStart;
+        if (profiler && profiler->gpuEnabled && profiler->gpuMs[_profiler::FRAME] > workMs) workMs = profiler->gpuMs[_profiler::FRAME];
+        dynRes->frameTime(workMs);
+    }
+
+    // end of a traced frame, f12 starts and stops them here
+    _glTrace::frame();
+    // this frame's draw, bind and upload counts go to the state that drew it
+    _renderStats::frame(currentState);
+
     return true; // indicate drawing was successful
 }
 
 // handles windows messages (keyboard, mouse input)
 int _scene::winMsg(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 {
+    // debug views that work in every state
+    if (uMsg == WM_KEYDOWN && wParam == VK_F5) { // f5 -> toggle the overdraw heatmap
+        if (overdraw) overdraw->enabled = !overdraw->enabled;
+        return 0;
+    }
+    if (uMsg == WM_KEYDOWN && wParam == VK_F8) { // f8 -> screenshot of the next frame
+        if (capture) capture->screenshot();
+        return 0;
+    }
+    if (uMsg == WM_KEYDOWN && wParam == VK_F11) { // f11 -> next frame also drawn by the cpu renderer, saved as soft_NNN.tga
+        softFrame = true;
+        return 0;
+    }
+    if (uMsg == WM_KEYDOWN && wParam == VK_F9) { // f9 -> start/stop recording every frame
+        if (capture) capture->toggleRecording();
+        return 0;
+    }
+    if (uMsg == WM_KEYDOWN && wParam == VK_F12) { // f12 -> start/stop writing frames to the gl trace
+        _glTrace::toggle();
+        return 0;
+    }
+
     // handle input specifically for the 'game' state first
     if (currentState == GAME && gameInputs) { // check state and if input handler exists
         switch(uMsg) { // check the type of message
@@ -535,16 +922,33 @@ int _scene::winMsg(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
                         if (bullet && !bullet->bLive) { // if bullet exists and is not already active
                             vec3 playerPos = {0,0,0}; // default position
                             if(player) {
-                                playerPos = player->plPos; // get current player position
+                                playerPos = graph->worldPosition(muzzleNode); // muzzle, as of the last drawn frame
                             }
-                            // reset the bullet to the player's position and make it active
+                            // reset the bullet to the muzzle position and make it active
                             bullet->bReset(playerPos);
+                            bullet->actionTrigger = _bullets::SHOOT;
                             bullet->bActions(); // start bullet movement/animation
                             break; // only fire one bullet per key press
                         }
                     }
+                } else if (wParam == 'L') { // 'l' -> toggle the 2d lights
+                    if (lights && lights->fbo) lights->enabled = !lights->enabled;
                 } else if (wParam == 'P') { // 'p' key
                     currentState = PAUSED; // pause the game
+                } else if (wParam == VK_F2) { // f2 -> particle benchmark, results go to the console
+                    _particles::benchmark(300, stream);
+                } else if (wParam == VK_F3) { // f3 -> toggle dynamic resolution
+                    if (dynRes) dynRes->enabled = !dynRes->enabled;
+                } else if (wParam == VK_F7) { // f7 -> next supported particle draw path, for benchmarking
+                    _glCaps::next(_glCaps::PARTICLES);
+                    cout << "particles: drawing with " << _glCaps::pathName(_glCaps::PARTICLES) << endl;
+                } else if (wParam == VK_F6) { // f6 -> base level vs mipmapped sampling, results go to the console
+                    samplingBenchmark();
+                } else if (wParam == VK_F4) { // f4 -> pass timings to the console and a trace file
+                    if (profiler) {
+                        profiler->report();
+                        profiler->exportTimeline("profile_timeline.json");
+                    }
                 } else {
                     // handle player movement keys
                     if (player) {
@@ -664,79 +1068,75 @@ int _scene::winMsg(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 }
 
 // loads font data from a .fnt file generated by tools like bmfont
+// the glyph table comes from the pack or the .fntb next to the .fnt in one read, the text is only parsed when neither is there
 bool _scene::loadFontData(const char* filename) {
-    std::ifstream file(filename); // open the file
-    if (!file.is_open()) { // check if file opened successfully
+    const char* data;
+    size_t size;
+    std::string compiled = _fontTable::binaryName(filename);
+    bool loaded = pack && pack->file(compiled.c_str(), data, size) && fontTable.fromBinary(data, size, 0, 0);
+    if (!loaded) loaded = fontTable.load(filename); // the .fntb while it matches the .fnt, else parse and write one
+    if (!loaded && pack && pack->file(filename, data, size)) { // only the text is in the pack
+        std::istringstream text(std::string(data, size));
+        fontTable.parse(text);
+        loaded = true;
+    }
+    if (!loaded) {
         std::cerr << "error: could not open font data file: " << filename << std::endl;
         MessageBox(NULL, "error: could not open .fnt file!", "font data error", MB_OK | MB_ICONERROR);
         return false; // return error
     }
-    std::string line; std::string key; // variables for parsing
-    fontDataMap.clear(); // clear any existing font data
-    // reset font metrics
-    fontTextureWidth = 0; fontTextureHeight = 0; fontLineHeight = 0; fontBaseHeight = 0;
-
-    // read the file line by line
-    while (std::getline(file, line)) {
-        std::stringstream ss(line); // use stringstream to easily extract parts
-        ss >> key; // read the first word (key) of the line
-
-        if (key == "common") { // information about the font texture itself
-            std::string valuePair;
-            while (ss >> valuePair) { // read key=value pairs
-                size_t equalsPos = valuePair.find('=');
-                if (equalsPos != std::string::npos) {
-                    std::string currentKey = valuePair.substr(0, equalsPos);
-                    std::string currentValue = valuePair.substr(equalsPos + 1);
-                    try { // use try-catch for safety when converting string to number
-                        if (currentKey == "base") fontBaseHeight = std::stof(currentValue);
-                        else if (currentKey == "lineHeight") fontLineHeight = std::stof(currentValue);
-                        else if (currentKey == "scaleW") fontTextureWidth = std::stof(currentValue); // texture width
-                        else if (currentKey == "scaleH") fontTextureHeight = std::stof(currentValue); // texture height
-                    } catch (...) { std::cerr << "font parse error (common)\n"; }
-                }
-            }
-        } else if (key == "char") { // information about a specific character
-            CharData charData; // struct to hold data for one character
-            std::string valuePair;
-            while (ss >> valuePair) { // read key=value pairs
-                size_t equalsPos = valuePair.find('=');
-                if (equalsPos != std::string::npos) {
-                    std::string currentKey = valuePair.substr(0, equalsPos);
-                    std::string currentValue = valuePair.substr(equalsPos + 1);
-                    try { // use try-catch for string to number conversion
-                        if (currentKey == "id") charData.id = std::stoi(currentValue); // ascii id
-                        else if (currentKey == "x") charData.x = std::stof(currentValue); // position in texture (top-left x)
-                        else if (currentKey == "y") charData.y = std::stof(currentValue); // position in texture (top-left y)
-                        else if (currentKey == "width") charData.width = std::stof(currentValue); // width in texture
-                        else if (currentKey == "height") charData.height = std::stof(currentValue); // height in texture
-                        else if (currentKey == "xoffset") charData.xoffset = std::stof(currentValue); // offset when drawing on screen (x)
-                        else if (currentKey == "yoffset") charData.yoffset = std::stof(currentValue); // offset when drawing on screen (y)
-                        else if (currentKey == "xadvance") charData.xadvance = std::stof(currentValue); // how much to move cursor after drawing
-                    } catch (...) { std::cerr << "font parse error (char)\n"; }
-                }
-            }
-            // store the parsed character data in the map, using the character id as the key
-            if (charData.id != 0 ) { // make sure id is valid before storing
-                fontDataMap[charData.id] = charData;
-            }
-        }
-        // add parsing for "kerning" lines if needed
-    }
-    file.close(); // close the file
+
+    // font metrics
+    fontTextureWidth = fontTable.scaleW;
+    fontTextureHeight = fontTable.scaleH;
+    fontLineHeight = fontTable.lineHeight;
+    fontBaseHeight = fontTable.base;
 
     // check if essential data was loaded
-    if (fontTextureWidth == 0 || fontTextureHeight == 0 || fontDataMap.empty()) {
+    if (fontTextureWidth == 0 || fontTextureHeight == 0 || fontTable.count == 0) {
         MessageBox(NULL, "warning: font data might be missing or invalid (.fnt parsing).", "font data warning", MB_OK | MB_ICONWARNING);
         // might still be usable if only some chars are missing, but drawing might fail
     }
     return true; // loading finished (possibly with warnings)
 }
 
+// pushes this frame's entity transforms; unchanged ones don't dirty their node
+void _scene::syncGraph() {
+    if (!graph) return;
+
+    vec3 none = { 0, 0, 0 };
+    if (player) graph->setLocal(player->node, player->plPos, none, player->plScl);
+
+    for (_enms* enemy : enemies) {
+        if (!enemy || !enemy->isEnmsLive) continue;
+        vec3 at = { enemy->pos.x, enemy->pos.y, -2.0f }; // enemies are drawn at z -2
+        vec3 size = { enemy->scale.x, enemy->scale.y, 1.0f };
+        graph->setLocal(enemy->node, at, enemy->rot, size);
+    }
+
+    for (_bullets* bullet : bullets) {
+        if (bullet && bullet->bLive) graph->setLocal(bullet->node, bullet->bPos, bullet->bRot, bullet->bScale);
+    }
+
+    graph->update();
+}
+
+// textured (or plain, with texture 0 bound) rectangle in ortho pixels, top-left uv 0,0
+void _scene::drawScreenQuad(float x, float y, float w, float h) {
+    streamSpan s = stream->alloc(_glCaps::SPRITES, 4, sizeof(streamVertex));
+    if (!s.ptr) return;
+    streamVertex* v = (streamVertex*)s.ptr;
+    streamPut(&v[0], x, y, 0, 0, 0);         // top-left
+    streamPut(&v[1], x + w, y, 0, 1, 0);     // top-right
+    streamPut(&v[2], x + w, y + h, 0, 1, 1); // bottom-right
+    streamPut(&v[3], x, y + h, 0, 0, 1);     // bottom-left
+    stream->draw(s, GL_QUADS, 4);
+}
+
 // draws text on the screen using the loaded bitmap font
 void _scene::drawText(std::string text, float screenX, float screenY, float r, float g, float b) {
     // check if font texture and data are loaded and valid
-    if (fontTextureID == 0 || fontDataMap.empty() || fontTextureWidth == 0 || fontTextureHeight == 0) {
+    if (fontTextureID == 0 || fontTable.count == 0 || fontTextureWidth == 0 || fontTextureHeight == 0) {
         return; // cannot draw text without font resources
     }
 
@@ -748,15 +1148,29 @@ void _scene::drawText(std::string text, float screenX, float screenY, float r, f
 
     glColor3f(r, g, b); // set the text color
 
+    textQuads(text, screenX, screenY);
+
+    glBindTexture(GL_TEXTURE_2D, 0); // unbind the font texture
+    // disable blend/texture if they were specifically enabled only for text
+    // glDisable(GL_TEXTURE_2D);
+    // glDisable(GL_BLEND);
+}
+
+// glyph quads of a line in one stream draw, the caller sets the font texture, color and blending
+void _scene::textQuads(const std::string &text, float screenX, float screenY) {
+    if (fontTable.count == 0 || fontTextureWidth == 0 || fontTextureHeight == 0) return;
     float currentX = screenX; // tracks the horizontal position for the next character
 
-    // begin drawing quads (one quad per character)
-    glBegin(GL_QUADS);
-    for (char &c : text) { // loop through each character in the input string
-        // find the character data in the map
-        auto it = fontDataMap.find(c);
-        if (it != fontDataMap.end()) { // if character data is found
-            CharData cd = it->second; // get the character data struct
+    // one span for the whole string, one draw call (one quad per character)
+    streamSpan s = stream->alloc(_glCaps::TEXT, (int)text.size() * 4, sizeof(streamVertex));
+    if (!s.ptr) return;
+    streamVertex* v = (streamVertex*)s.ptr;
+    int quads = 0;
+    for (const char &c : text) { // loop through each character in the input string
+        // look the character up in the glyph table
+        const CharData* glyph = fontTable.glyph((unsigned char)c);
+        if (glyph) { // if character data is found
+            const CharData& cd = *glyph;
 
             // calculate screen coordinates for the quad vertices
             float x1 = currentX + cd.xoffset; // top-left x
@@ -771,44 +1185,169 @@ void _scene::drawText(std::string text, float screenX, float screenY, float r, f
             float v2 = (cd.y + cd.height) / fontTextureHeight; // bottom-right v
 
             // define the quad vertices and their corresponding texture coordinates
-            glTexCoord2f(u1, v1); glVertex2f(x1, y1); // top-left
-            glTexCoord2f(u2, v1); glVertex2f(x2, y1); // top-right
-            glTexCoord2f(u2, v2); glVertex2f(x2, y2); // bottom-right
-            glTexCoord2f(u1, v2); glVertex2f(x1, y2); // bottom-left
+            streamPut(v++, x1, y1, 0, u1, v1); // top-left
+            streamPut(v++, x2, y1, 0, u2, v1); // top-right
+            streamPut(v++, x2, y2, 0, u2, v2); // bottom-right
+            streamPut(v++, x1, y2, 0, u1, v2); // bottom-left
+            quads++;
 
             // move the cursor position for the next character
             currentX += cd.xadvance;
         } else {
             // character not found in font data (e.g., unsupported character)
             // optional: advance by a default amount (like space width) or draw a placeholder
-            auto space_it = fontDataMap.find(' '); // find data for space character
-            if (space_it != fontDataMap.end()) {
-                currentX += space_it->second.xadvance; // advance by space width
+            const CharData* space = fontTable.glyph(' '); // find data for space character
+            if (space) {
+                currentX += space->xadvance; // advance by space width
             }
             // else: currentx remains unchanged, characters might overlap
         }
     }
-    glEnd(); // finish drawing quads
+    stream->draw(s, GL_QUADS, quads * 4);
 
-    glBindTexture(GL_TEXTURE_2D, 0); // unbind the font texture
-    // disable blend/texture if they were specifically enabled only for text
-    // glDisable(GL_TEXTURE_2D);
-    // glDisable(GL_BLEND);
+}
+
+// width in pixels of a line drawn at x = 0, glyph offsets included
+float _scene::textWidth(const std::string &text) {
+    float currentX = 0, right = 0;
+    for (const char &c : text) {
+        const CharData* glyph = fontTable.glyph((unsigned char)c);
+        if (!glyph) glyph = fontTable.glyph(' ');
+        if (!glyph) continue;
+        right = std::max(right, currentX + glyph->xoffset + glyph->width);
+        currentX += glyph->xadvance;
+    }
+    return std::max(right, currentX);
+}
+
+// draws the in-game hud (expects the ortho projection to be set)
+// the lines only reach the hud layer's texture when they change, the layer itself is one quad
+void _scene::drawHUD() {
+    if (!hud) return;
+
+    char line[64];
+    sprintf(line, "score: %d", score);
+    hud->set(0, line, 20, 20, 1.0f, 1.0f, 1.0f);
+
+    line[0] = '\0';
+    if (dynRes && dynRes->enabled && _glCaps::paths[_glCaps::OFFSCREEN] == _glCaps::PATH_FBO && !(overdraw && overdraw->enabled)) {
+        sprintf(line, "res: %d%%", (int)(dynRes->scale * 100.0f + 0.5f));
+    }
+    hud->set(1, line, 20, 50, 1.0f, 1.0f, 1.0f); // empty hides it
+
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    hud->present((int)dim.x, (int)dim.y);
+    glPopAttrib();
+}
+
+// f6 -> the same screen of minified bullets sampled from the base level only, then through the mip chain.
+// on a software renderer the base level run walks the whole 900x720 sheet for every small quad.
+void _scene::samplingBenchmark() {
+    const int frames = 60;
+    const int quads = 2000;
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_TEXTURE_2D);
+    setOrthoProjection((int)dim.x, (int)dim.y);
+    glBindTexture(GL_TEXTURE_2D, bulletTextureID);
+
+    double ms[2] = {0, 0};
+    for (int pass = 0; pass < 2; pass++) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, pass == 0 ? 0 : bulletMipLevels - 1);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, pass == 0 ? GL_LINEAR : GL_LINEAR_MIPMAP_LINEAR);
+        glFinish();
+
+        double start = _timer::nowMs();
+        for (int f = 0; f < frames; f++) {
+            glBegin(GL_QUADS);
+            for (int q = 0; q < quads; q++) {
+                // bullet sized quads spread over the screen, same layout for both passes
+                float x = (float)((q * 37) % (int)(dim.x > 24 ? dim.x - 24 : 1));
+                float y = (float)((q * 53) % (int)(dim.y > 19 ? dim.y - 19 : 1));
+                glTexCoord2f(0, 0); glVertex2f(x, y);
+                glTexCoord2f(1, 0); glVertex2f(x + 24, y);
+                glTexCoord2f(1, 1); glVertex2f(x + 24, y + 19);
+                glTexCoord2f(0, 1); glVertex2f(x, y + 19);
+            }
+            glEnd();
+            glFinish();
+        }
+        ms[pass] = (_timer::nowMs() - start) / frames;
+    }
+
+    // back to what the loader picked
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, bulletMipLevels - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, bulletMipLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+
+    restorePerspectiveProjection();
+    glPopAttrib();
+
+    cout << "sampling: " << (renderer ? renderer : "unknown renderer") << ", " << quads << " bullets x " << frames << " frames" << endl;
+    cout << "  base level only: " << ms[0] << " ms/frame" << endl;
+    cout << "  " << bulletMipLevels << " mip levels:    " << ms[1] << " ms/frame" << endl;
+}
+
+// every image initGL needs before the first frame, in the order it uploads them
+std::vector<textureRequest> _scene::startupTextures(_spriteTrim* player, _spriteTrim* enemy, _spriteTrim* bullet, bool wholeBackground) {
+    std::vector<textureRequest> list;
+    auto add = [&list](const std::string& file, _spriteTrim* trim, int format, bool mipmaps) {
+        textureRequest r;
+        r.fileName = file;
+        r.trim = trim;
+        r.format = format;
+        r.mipmaps = mipmaps;
+        r.base = nullptr;
+        r.ok = false;
+        list.push_back(r);
+    };
+
+    add("images/retro_deco.png", nullptr, _textureLoader::TEX_LUMINANCE_ALPHA8, false);
+    add(variants->pick("images/landing_page.png", (int)dim.x, (int)dim.y), nullptr, _textureLoader::TEX_RGB8, false);
+    add("images/player.png", player, _textureLoader::TEX_RGBA8, true);
+    add("images/mon.png", enemy, _textureLoader::TEX_RGBA8, true);
+    add("images/b.png", bullet, _textureLoader::TEX_PALETTE8, true);
+    if (wholeBackground) add(variants->pick("images/prlx.jpg", (int)dim.x, (int)dim.y), nullptr, _textureLoader::TEX_RGB8, false);
+    add("images/wall.png", nullptr, _textureLoader::TEX_AUTO, true);
+    return list;
+}
+
+// -loadbench: decode and pack the startup images on more and more workers
+void _scene::loadBenchmark() {
+    // trims of their own, the scene's are in use
+    _spriteTrim playerGrid(4, 2), enemyGrid(7, 2), bulletGrid(1, 1);
+    int cores = _jobQueue::cores();
+
+    std::vector<int> workers;
+    for (int n = 1; n < cores; n *= 2) workers.push_back(n);
+    workers.push_back(cores);
+
+    cout << "load benchmark: " << cores << " cores" << endl;
+    double single = 0;
+    for (int n : workers) {
+        _jobQueue pool(n);
+        double best = 0;
+        for (int run = 0; run < 3; run++) { // best of three, the file cache is warm from initGL
+            std::vector<textureRequest> batch = startupTextures(&playerGrid, &enemyGrid, &bulletGrid, backgroundTiles == nullptr);
+            double start = _timer::nowMs();
+            _textureLoader::packAll(&pool, batch);
+            double ms = _timer::nowMs() - start;
+            if (run == 0 || ms < best) best = ms;
+        }
+        if (n == 1) single = best;
+        cout << "  " << n << " workers: " << best << " ms, " << (best > 0 ? single / best : 0) << "x" << endl;
+    }
 }
 
 // specific function to load the menu background texture
 bool _scene::loadMenuBackgroundTexture() {
-    texLoader->loadTexture((char*)"images/menu_background.png"); // load the image
-    if (texLoader->tex == 0) { // check for loading errors
-        MessageBox(NULL, "menu background texture failed to load", "texture load error", MB_OK | MB_ICONERROR);
-        return false; // return failure
-    }
-    menuBackgroundTextureID = texLoader->tex; // store the texture id
-    // set texture parameters for the menu background (linear filtering)
-    glBindTexture(GL_TEXTURE_2D, menuBackgroundTextureID);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glBindTexture(GL_TEXTURE_2D, 0); // unbind
+    // decoded and uploaded in the background, the landing screen shows meanwhile.
+    // the id stays 0 until the upload has landed (linear filtering, no mipmaps)
+    variants->load("images/menu_background.png", (int)dim.x, (int)dim.y, &menuBackgroundTextureID, _textureLoader::TEX_RGB8);
     return true; // return success
 }
 
@@ -827,12 +1366,7 @@ void _scene::drawMenuScene() {
         // draw the menu background image first
         glColor4f(1.0f, 1.0f, 1.0f, 1.0f); // set color to white, full opacity
         glBindTexture(GL_TEXTURE_2D, menuBackgroundTextureID); // bind the menu background texture
-        glBegin(GL_QUADS); // draw a full-screen quad
-            glTexCoord2f(0.0, 0.0); glVertex2f(0, 0);
-            glTexCoord2f(1.0, 0.0); glVertex2f(dim.x, 0);
-            glTexCoord2f(1.0, 1.0); glVertex2f(dim.x, dim.y);
-            glTexCoord2f(0.0, 1.0); glVertex2f(0, dim.y);
-        glEnd();
+        drawScreenQuad(0, 0, dim.x, dim.y); // draw a full-screen quad
         glBindTexture(GL_TEXTURE_2D, 0); // unbind texture
 
         // calculate positions for menu text items (centered horizontally, spaced vertically)
@@ -841,9 +1375,11 @@ void _scene::drawMenuScene() {
         float menuY_Spacing = 60; // vertical distance between menu items
 
         // draw the menu options using the drawtext function
+        if (profiler) profiler->beginPass(_profiler::TEXT);
         drawText("new game: 'n'", menuX, menuY_Start, 0.0f, 0.0f, 0.0f); // black text
         drawText("help: 'h'", menuX, menuY_Start + menuY_Spacing, 0.0f, 0.0f, 0.0f);
         drawText("exit: press e", menuX, menuY_Start + 2 * menuY_Spacing, 0.0f, 0.0f, 0.0f);
+        if (profiler) profiler->endPass(_profiler::TEXT);
 
         // restore previous opengl state
         glDisable(GL_TEXTURE_2D);
@@ -0,0 +1,119 @@
+#include "_scenegraph.h"
+#include <math.h>
+
+static const float identity[16] = {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1};
+
+static inline bool sameVec(const vec3 &a, const vec3 &b)
+{
+    return a.x==b.x && a.y==b.y && a.z==b.z;
+}
+
+// out = a * b, column major
+static void mulMatrix(const float *a, const float *b, float *out)
+{
+    for(int c=0; c<4; c++)
+        for(int r=0; r<4; r++)
+            out[c*4+r] = a[r]*b[c*4] + a[4+r]*b[c*4+1] + a[8+r]*b[c*4+2] + a[12+r]*b[c*4+3];
+}
+
+_sceneGraph::_sceneGraph()
+{
+    //ctor
+    count = 0;
+    rebuilt = 0;
+}
+
+_sceneGraph::~_sceneGraph()
+{
+    //dtor
+}
+
+int _sceneGraph::create(int p)
+{
+    if(count>=MAX_NODES || p>=count) return -1;
+
+    int n = count++;
+    parent[n] = p;
+    pos[n].x = pos[n].y = pos[n].z = 0;
+    rot[n].x = rot[n].y = rot[n].z = 0;
+    scale[n].x = scale[n].y = scale[n].z = 1;
+    for(int i=0; i<16; i++) local[n][i] = world[n][i] = identity[i];
+    dirty[n] = true;
+    moved[n] = false;
+    return n;
+}
+
+void _sceneGraph::setLocal(int n, vec3 p, vec3 r, vec3 s)
+{
+    if(n<0 || n>=count) return;
+    if(sameVec(pos[n],p) && sameVec(rot[n],r) && sameVec(scale[n],s)) return;
+
+    pos[n] = p;
+    rot[n] = r;
+    scale[n] = s;
+    dirty[n] = true;
+}
+
+void _sceneGraph::setPosition(int n, vec3 p)
+{
+    if(n<0 || n>=count) return;
+    setLocal(n,p,rot[n],scale[n]);
+}
+
+void _sceneGraph::buildLocal(int n)
+{
+    // T * S * Rx * Ry * Rz, the glTranslate, glScale, glRotate order bullets and enemies issue without a graph
+    const float d = 3.14159265f/180.0f;
+    float cx = cosf(rot[n].x*d), sx = sinf(rot[n].x*d);
+    float cy = cosf(rot[n].y*d), sy = sinf(rot[n].y*d);
+    float cz = cosf(rot[n].z*d), sz = sinf(rot[n].z*d);
+
+    // columns of Rx*Ry*Rz
+    float r[3][3] = {
+        { cy*cz,  cx*sz+sx*sy*cz,  sx*sz-cx*sy*cz},
+        {-cy*sz,  cx*cz-sx*sy*sz,  sx*cz+cx*sy*sz},
+        { sy,    -sx*cy,           cx*cy}
+    };
+    float s[3] = {scale[n].x, scale[n].y, scale[n].z};
+
+    float *m = local[n];
+    for(int c=0; c<3; c++)
+    {
+        m[c*4+0] = r[c][0]*s[0]; // the scale applies to rows, after the rotation
+        m[c*4+1] = r[c][1]*s[1];
+        m[c*4+2] = r[c][2]*s[2];
+        m[c*4+3] = 0;
+    }
+    m[12] = pos[n].x;
+    m[13] = pos[n].y;
+    m[14] = pos[n].z;
+    m[15] = 1;
+}
+
+void _sceneGraph::update()
+{
+    rebuilt = 0;
+    for(int n=0; n<count; n++)
+    {
+        int p = parent[n];
+        moved[n] = dirty[n] || (p>=0 && moved[p]);
+        if(!moved[n]) continue;
+
+        if(dirty[n]) buildLocal(n);
+        dirty[n] = false;
+
+        if(p<0) for(int i=0; i<16; i++) world[n][i] = local[n][i];
+        else    mulMatrix(world[p],local[n],world[n]);
+        rebuilt++;
+    }
+}
+
+vec3 _sceneGraph::worldPosition(int n)
+{
+    vec3 v = {0,0,0};
+    if(n<0 || n>=count) return v;
+    v.x = world[n][12];
+    v.y = world[n][13];
+    v.z = world[n][14];
+    return v;
+}
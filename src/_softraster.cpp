@@ -0,0 +1,351 @@
+#include "_softraster.h"
+#include <emmintrin.h>
+#include <math.h>
+#include <chrono>
+
+// bgra8 <-> 0..255 floats, one pixel per register
+static inline __m128 unpackPixel(unsigned int p)
+{
+    __m128i z = _mm_setzero_si128();
+    __m128i v = _mm_cvtsi32_si128((int)p);
+    v = _mm_unpacklo_epi8(v,z);
+    v = _mm_unpacklo_epi16(v,z);
+    return _mm_cvtepi32_ps(v);
+}
+
+static inline unsigned int packPixel(__m128 c)
+{
+    __m128i i = _mm_cvtps_epi32(c);
+    i = _mm_packs_epi32(i,i);
+    i = _mm_packus_epi16(i,i); // saturates to 0..255
+    return (unsigned int)_mm_cvtsi128_si32(i);
+}
+
+static inline int wrapTexel(int i, int n, bool clamp)
+{
+    if(clamp) return i<0? 0 : (i>=n? n-1 : i);
+    i %= n;
+    return i<0? i+n : i;
+}
+
+// GL_LINEAR: texel centers at (i+0.5)/size
+static inline __m128 sampleBilinear(const softTexture *t, float u, float v)
+{
+    float fx = u*t->width-0.5f, fy = v*t->height-0.5f;
+    float flx = floorf(fx), fly = floorf(fy);
+    int x0 = (int)flx, y0 = (int)fly;
+    float ax = fx-flx, ay = fy-fly;
+
+    int xa = wrapTexel(x0,t->width,t->clamp), xb = wrapTexel(x0+1,t->width,t->clamp);
+    int ya = wrapTexel(y0,t->height,t->clamp), yb = wrapTexel(y0+1,t->height,t->clamp);
+    const unsigned int *row0 = &t->texels[(size_t)ya*t->width];
+    const unsigned int *row1 = &t->texels[(size_t)yb*t->width];
+
+    __m128 wx = _mm_set1_ps(ax), wy = _mm_set1_ps(ay);
+    __m128 p00 = unpackPixel(row0[xa]), p10 = unpackPixel(row0[xb]);
+    __m128 p01 = unpackPixel(row1[xa]), p11 = unpackPixel(row1[xb]);
+    __m128 top = _mm_add_ps(p00,_mm_mul_ps(_mm_sub_ps(p10,p00),wx));
+    __m128 bot = _mm_add_ps(p01,_mm_mul_ps(_mm_sub_ps(p11,p01),wx));
+    return _mm_add_ps(top,_mm_mul_ps(_mm_sub_ps(bot,top),wy));
+}
+
+// attribute as a plane over the triangle: value = c + dx*x + dy*y
+struct softPlane
+{
+    float c, dx, dy;
+};
+
+// edges as e = a*x + b*y + c, positive inside a counter clockwise triangle
+struct softEdge
+{
+    float a, b, c;
+    bool topLeft; // owns pixels exactly on it, so shared quad diagonals aren't blended twice
+};
+
+static softEdge makeEdge(float px, float py, float qx, float qy)
+{
+    softEdge e;
+    e.a = -(qy-py);
+    e.b = qx-px;
+    e.c = (qy-py)*px-(qx-px)*py;
+    e.topLeft = e.a>0 || (e.a==0 && e.b>0);
+    return e;
+}
+
+static inline bool inside(const softEdge &e, float v)
+{
+    return v>0 || (v==0 && e.topLeft);
+}
+
+static void rasterTriangle(const softQuad &q, int i0, int i1, int i2,
+                           int tx0, int ty0, int tx1, int ty1, unsigned int *target, unsigned char *counts, int pitch)
+{
+    float area = (q.x[i1]-q.x[i0])*(q.y[i2]-q.y[i0]) - (q.y[i1]-q.y[i0])*(q.x[i2]-q.x[i0]);
+    if(fabsf(area)<1e-6f) return;
+    if(area<0) { int t = i1; i1 = i2; i2 = t; area = -area; }
+
+    // e0 is opposite vertex i0 and so on, e/area is that vertex's weight
+    softEdge e0 = makeEdge(q.x[i1],q.y[i1],q.x[i2],q.y[i2]);
+    softEdge e1 = makeEdge(q.x[i2],q.y[i2],q.x[i0],q.y[i0]);
+    softEdge e2 = makeEdge(q.x[i0],q.y[i0],q.x[i1],q.y[i1]);
+    float inv = 1.0f/area;
+
+    softPlane pu, pv;
+    pu.dx = (e0.a*q.u[i0]+e1.a*q.u[i1]+e2.a*q.u[i2])*inv;
+    pu.dy = (e0.b*q.u[i0]+e1.b*q.u[i1]+e2.b*q.u[i2])*inv;
+    pu.c  = (e0.c*q.u[i0]+e1.c*q.u[i1]+e2.c*q.u[i2])*inv;
+    pv.dx = (e0.a*q.v[i0]+e1.a*q.v[i1]+e2.a*q.v[i2])*inv;
+    pv.dy = (e0.b*q.v[i0]+e1.b*q.v[i1]+e2.b*q.v[i2])*inv;
+    pv.c  = (e0.c*q.v[i0]+e1.c*q.v[i1]+e2.c*q.v[i2])*inv;
+
+    // all four color channels in one register each
+    __m128 c0 = _mm_loadu_ps(q.col[i0]), c1 = _mm_loadu_ps(q.col[i1]), c2 = _mm_loadu_ps(q.col[i2]);
+    __m128 vInv = _mm_set1_ps(inv);
+    __m128 colDx = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(e0.a),c0),_mm_mul_ps(_mm_set1_ps(e1.a),c1)),_mm_mul_ps(_mm_set1_ps(e2.a),c2)),vInv);
+    __m128 colDy = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(e0.b),c0),_mm_mul_ps(_mm_set1_ps(e1.b),c1)),_mm_mul_ps(_mm_set1_ps(e2.b),c2)),vInv);
+    __m128 colC  = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(e0.c),c0),_mm_mul_ps(_mm_set1_ps(e1.c),c1)),_mm_mul_ps(_mm_set1_ps(e2.c),c2)),vInv);
+
+    // triangle bounds clipped to the tile
+    float minX = fminf(q.x[i0],fminf(q.x[i1],q.x[i2])), maxX = fmaxf(q.x[i0],fmaxf(q.x[i1],q.x[i2]));
+    float minY = fminf(q.y[i0],fminf(q.y[i1],q.y[i2])), maxY = fmaxf(q.y[i0],fmaxf(q.y[i1],q.y[i2]));
+    int x0 = (int)floorf(minX), x1 = (int)ceilf(maxX);
+    int y0 = (int)floorf(minY), y1 = (int)ceilf(maxY);
+    if(x0<tx0) x0 = tx0;
+    if(y0<ty0) y0 = ty0;
+    if(x1>tx1) x1 = tx1;
+    if(y1>ty1) y1 = ty1;
+    if(x0>=x1 || y0>=y1) return;
+
+    const __m128 white = _mm_set1_ps(255.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 to01 = _mm_set1_ps(1.0f/255.0f);
+
+    for(int y=y0; y<y1; y++)
+    {
+        float py = y+0.5f;
+        float px = x0+0.5f;
+        float w0 = e0.a*px+e0.b*py+e0.c;
+        float w1 = e1.a*px+e1.b*py+e1.c;
+        float w2 = e2.a*px+e2.b*py+e2.c;
+        unsigned int *dst = target+(size_t)y*pitch;
+        unsigned char *written = counts+(size_t)y*pitch;
+
+        for(int x=x0; x<x1; x++, px+=1.0f, w0+=e0.a, w1+=e1.a, w2+=e2.a)
+        {
+            if(!inside(e0,w0) || !inside(e1,w1) || !inside(e2,w2)) continue;
+            if(written[x]<255) written[x]++; // GL_INCR on the stencil
+
+            __m128 col = _mm_add_ps(colC,_mm_add_ps(_mm_mul_ps(colDx,_mm_set1_ps(px)),_mm_mul_ps(colDy,_mm_set1_ps(py))));
+            __m128 tex = q.tex? sampleBilinear(q.tex,pu.c+pu.dx*px+pu.dy*py,pv.c+pv.dx*px+pv.dy*py) : white;
+            __m128 src = _mm_mul_ps(tex,col); // 0..255
+
+            if(q.blend==_softRaster::BLEND_NONE)
+            {
+                dst[x] = packPixel(src);
+                continue;
+            }
+
+            __m128 a = _mm_mul_ps(_mm_shuffle_ps(src,src,_MM_SHUFFLE(3,3,3,3)),to01);
+            __m128 d = unpackPixel(dst[x]);
+            __m128 out;
+            if(q.blend==_softRaster::BLEND_ADD)
+                out = _mm_add_ps(_mm_mul_ps(src,a),d);                             // GL_SRC_ALPHA, GL_ONE
+            else if(q.blend==_softRaster::BLEND_PREMULTIPLIED)
+                out = _mm_add_ps(src,_mm_mul_ps(d,_mm_sub_ps(one,a)));             // GL_ONE, GL_ONE_MINUS_SRC_ALPHA
+            else
+                out = _mm_add_ps(_mm_mul_ps(src,a),_mm_mul_ps(d,_mm_sub_ps(one,a))); // GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA
+            dst[x] = packPixel(out);
+        }
+    }
+}
+
+_softRaster::_softRaster(int workerCount)
+{
+    //ctor
+    width = height = 0;
+    active = false;
+    binMs = rasterMs = 0;
+    quads = 0;
+    avgOverdraw = 0;
+    maxOverdraw = 0;
+    tilesX = tilesY = 0;
+    clearColor = 0xFF000000;
+
+    generation = 0;
+    running = 0;
+    quit = false;
+    nextTile = 0;
+
+    threads = workerCount>0? workerCount : (int)std::thread::hardware_concurrency();
+    if(threads<1) threads = 1; // hardware_concurrency may not know
+    for(int i=1; i<threads; i++) pool.push_back(std::thread(&_softRaster::workerMain,this));
+}
+
+_softRaster::~_softRaster()
+{
+    //dtor
+    {
+        std::lock_guard<std::mutex> l(lock);
+        quit = true;
+    }
+    wake.notify_all();
+    for(std::thread &t : pool) t.join();
+}
+
+double _softRaster::nowMs()
+{
+    return std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void _softRaster::workerMain()
+{
+    int seen = 0;
+    std::unique_lock<std::mutex> l(lock);
+    for(;;)
+    {
+        wake.wait(l,[&]() { return quit || generation!=seen; });
+        if(quit) return;
+        seen = generation;
+
+        l.unlock();
+        drainTiles();
+        l.lock();
+        if(--running==0) done.notify_one();
+    }
+}
+
+void _softRaster::drainTiles()
+{
+    // tiles share nothing but the read-only quads and textures
+    for(int i=nextTile++; i<(int)work.size(); i=nextTile++)
+        rasterTile(work[i]%tilesX,work[i]/tilesX);
+}
+
+void _softRaster::begin(int w, int h, float r, float g, float b)
+{
+    if(w<1) w = 1;
+    if(h<1) h = 1;
+    width = w;
+    height = h;
+
+    clearColor = packPixel(_mm_set_ps(255.0f,r*255.0f,g*255.0f,b*255.0f)); // lanes b, g, r, a
+    color.assign((size_t)w*h,clearColor);
+    overdraw.assign((size_t)w*h,0);
+
+    submitted.clear();
+    quads = 0;
+    active = true;
+}
+
+void _softRaster::submit(const softQuad &q)
+{
+    submitted.push_back(q);
+    quads++;
+}
+
+void _softRaster::finish()
+{
+    if(!active) return;
+    active = false;
+
+    double start = nowMs();
+    tilesX = (width+SOFT_TILE-1)/SOFT_TILE;
+    tilesY = (height+SOFT_TILE-1)/SOFT_TILE;
+    bins.resize((size_t)tilesX*tilesY);
+    for(std::vector<int> &b : bins) b.clear();
+
+    for(int i=0; i<(int)submitted.size(); i++)
+    {
+        const softQuad &q = submitted[i];
+        float minX = fminf(fminf(q.x[0],q.x[1]),fminf(q.x[2],q.x[3]));
+        float maxX = fmaxf(fmaxf(q.x[0],q.x[1]),fmaxf(q.x[2],q.x[3]));
+        float minY = fminf(fminf(q.y[0],q.y[1]),fminf(q.y[2],q.y[3]));
+        float maxY = fmaxf(fmaxf(q.y[0],q.y[1]),fmaxf(q.y[2],q.y[3]));
+        if(maxX<=0 || maxY<=0 || minX>=width || minY>=height) continue;
+
+        int bx0 = minX<0? 0 : (int)minX/SOFT_TILE, bx1 = maxX>=width? tilesX-1 : (int)maxX/SOFT_TILE;
+        int by0 = minY<0? 0 : (int)minY/SOFT_TILE, by1 = maxY>=height? tilesY-1 : (int)maxY/SOFT_TILE;
+        for(int ty=by0; ty<=by1; ty++)
+            for(int tx=bx0; tx<=bx1; tx++)
+                bins[ty*tilesX+tx].push_back(i);
+    }
+    binMs = nowMs()-start;
+
+    start = nowMs();
+    work.clear();
+    for(int t=0; t<tilesX*tilesY; t++)
+        if(!bins[t].empty()) work.push_back(t);
+    nextTile = 0;
+    {
+        std::lock_guard<std::mutex> l(lock);
+        running = (int)pool.size();
+        generation++;
+    }
+    wake.notify_all();
+    drainTiles();
+    {
+        std::unique_lock<std::mutex> l(lock);
+        done.wait(l,[&]() { return running==0; });
+    }
+    rasterMs = nowMs()-start;
+
+    unsigned long long total = 0;
+    maxOverdraw = 0;
+    for(size_t i=0; i<overdraw.size(); i++)
+    {
+        total += overdraw[i];
+        if(overdraw[i]>maxOverdraw) maxOverdraw = overdraw[i];
+    }
+    avgOverdraw = (float)((double)total/overdraw.size());
+}
+
+void _softRaster::rasterTile(int tx, int ty)
+{
+    int x0 = tx*SOFT_TILE, y0 = ty*SOFT_TILE;
+    int x1 = x0+SOFT_TILE<width? x0+SOFT_TILE : width;
+    int y1 = y0+SOFT_TILE<height? y0+SOFT_TILE : height;
+
+    for(int i : bins[ty*tilesX+tx])
+    {
+        const softQuad &q = submitted[i];
+        rasterTriangle(q,0,1,2,x0,y0,x1,y1,&color[0],&overdraw[0],width);
+        rasterTriangle(q,0,2,3,x0,y0,x1,y1,&color[0],&overdraw[0],width);
+    }
+}
+
+void _softRaster::drawQuads(const void *vertices, int stride, int count, const float *m,
+                            const float *color, const softTexture *tex, int blend)
+{
+    if(!active || !vertices) return;
+
+    softQuad q;
+    q.tex = tex;
+    q.blend = blend;
+
+    bool colored = stride==(int)sizeof(streamColorVertex);
+    for(int i=0; i+3<count; i+=4)
+    {
+        bool visible = true;
+        for(int k=0; k<4; k++)
+        {
+            const streamColorVertex *v = (const streamColorVertex*)((const unsigned char*)vertices+(size_t)(i+k)*stride);
+            float cx = m[0]*v->x + m[4]*v->y + m[8]*v->z  + m[12];
+            float cy = m[1]*v->x + m[5]*v->y + m[9]*v->z  + m[13];
+            float cw = m[3]*v->x + m[7]*v->y + m[11]*v->z + m[15];
+            if(cw<=0) { visible = false; break; }
+
+            // ndc to target pixels; the whole target, whatever viewport the scaled offscreen pass uses
+            q.x[k] = (cx/cw*0.5f+0.5f)*width;
+            q.y[k] = (cy/cw*0.5f+0.5f)*height;
+            q.u[k] = v->u;
+            q.v[k] = v->v;
+
+            const float *rgba = colored? &v->r : color;
+            q.col[k][0] = rgba[2];
+            q.col[k][1] = rgba[1];
+            q.col[k][2] = rgba[0];
+            q.col[k][3] = rgba[3];
+        }
+        if(visible) submit(q);
+    }
+}
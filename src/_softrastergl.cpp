@@ -0,0 +1,84 @@
+#include "_softrastergl.h"
+
+_softRasterGL::_softRasterGL(int workerCount) : _softRaster(workerCount)
+{
+    //ctor
+}
+
+_softRasterGL::~_softRasterGL()
+{
+    //dtor
+}
+
+void _softRasterGL::begin(int w, int h, float r, float g, float b)
+{
+    textures.clear(); // textures may have been replaced since the last frame
+    _softRaster::begin(w,h,r,g,b);
+}
+
+const softTexture *_softRasterGL::texture(GLuint id)
+{
+    auto it = textures.find(id);
+    if(it!=textures.end()) return it->second.texels.empty()? nullptr : &it->second;
+
+    // the texture is bound right now, copy its base level back once this frame
+    softTexture &t = textures[id];
+    GLint w = 0, h = 0, wrap = GL_REPEAT;
+    glGetTexLevelParameteriv(GL_TEXTURE_2D,0,GL_TEXTURE_WIDTH,&w);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D,0,GL_TEXTURE_HEIGHT,&h);
+    glGetTexParameteriv(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,&wrap);
+    if(w<=0 || h<=0) return nullptr;
+
+    t.width = w;
+    t.height = h;
+    t.clamp = wrap!=GL_REPEAT;
+    t.texels.resize((size_t)w*h);
+    glPixelStorei(GL_PACK_ALIGNMENT,4);
+    glGetTexImage(GL_TEXTURE_2D,0,GL_BGRA,GL_UNSIGNED_BYTE,&t.texels[0]);
+    return &t;
+}
+
+void _softRasterGL::fromGL(const streamSpan &s, GLenum mode, GLsizei count)
+{
+    if(!active || mode!=GL_QUADS || !s.ptr) return;
+
+    // the overdraw heatmap picks pixels by stencil value, overdraw already has those counts
+    if(glIsEnabled(GL_STENCIL_TEST))
+    {
+        GLint func = GL_ALWAYS;
+        glGetIntegerv(GL_STENCIL_FUNC,&func);
+        if(func!=GL_ALWAYS) return;
+    }
+
+    GLfloat mv[16], pr[16], cur[4];
+    glGetFloatv(GL_MODELVIEW_MATRIX,mv);
+    glGetFloatv(GL_PROJECTION_MATRIX,pr);
+    glGetFloatv(GL_CURRENT_COLOR,cur);
+
+    // projection * modelview, column major like gl
+    float m[16];
+    for(int c=0; c<4; c++)
+        for(int r=0; r<4; r++)
+            m[c*4+r] = pr[r]*mv[c*4] + pr[4+r]*mv[c*4+1] + pr[8+r]*mv[c*4+2] + pr[12+r]*mv[c*4+3];
+
+    const softTexture *tex = nullptr;
+    if(glIsEnabled(GL_TEXTURE_2D))
+    {
+        GLint id = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D,&id);
+        if(id) tex = texture((GLuint)id);
+    }
+
+    int blend = BLEND_NONE;
+    if(glIsEnabled(GL_BLEND))
+    {
+        GLint srcFactor = GL_SRC_ALPHA, dstFactor = GL_ONE_MINUS_SRC_ALPHA;
+        glGetIntegerv(GL_BLEND_SRC,&srcFactor);
+        glGetIntegerv(GL_BLEND_DST,&dstFactor);
+        if(dstFactor==GL_ONE) blend = BLEND_ADD;
+        else blend = srcFactor==GL_ONE? BLEND_PREMULTIPLIED : BLEND_ALPHA; // the hud layer is premultiplied
+    }
+
+    // reads back the span, slow from write-combined memory but this is a debug path
+    drawQuads(s.ptr,s.stride,count,m,cur,tex,blend);
+}
@@ -0,0 +1,115 @@
+#include "_spritetrim.h"
+
+_spriteTrim::_spriteTrim(int fx, int fy)
+{
+    //ctor
+    framesX = fx>0? fx : 1;
+    framesY = fy>0? fy : 1;
+    fullArea = trimmedArea = 0;
+
+    // until build() runs every frame is drawn whole
+    trimRect whole = {0,0,1,1};
+    rects.assign(framesX*framesY, whole);
+}
+
+_spriteTrim::~_spriteTrim()
+{
+    //dtor
+}
+
+void _spriteTrim::build(const unsigned char *pixels, int w, int h, int channels)
+{
+    if(!pixels || w<=0 || h<=0) return;
+
+    int cellW = w/framesX;
+    int cellH = h/framesY;
+    if(cellW<=0 || cellH<=0) return;
+
+    fullArea = trimmedArea = 0;
+
+    // no alpha channel (luminance or rgb), every texel is visible
+    bool hasAlpha = (channels==2 || channels==4);
+
+    for(int fy=0; fy<framesY; fy++)
+        for(int fx=0; fx<framesX; fx++)
+        {
+            int minX = cellW, minY = cellH, maxX = -1, maxY = -1;
+
+            for(int y=0; y<cellH; y++)
+            {
+                const unsigned char *row = pixels + ((size_t)(fy*cellH+y)*w + fx*cellW)*channels;
+                for(int x=0; x<cellW; x++)
+                {
+                    if(hasAlpha && row[x*channels+channels-1]==0) continue; // fully transparent adds nothing when blended
+                    if(x<minX) minX = x;
+                    if(x>maxX) maxX = x;
+                    if(y<minY) minY = y;
+                    if(y>maxY) maxY = y;
+                }
+            }
+
+            trimRect &r = rects[fy*framesX+fx];
+            fullArea += (double)cellW*cellH;
+
+            if(maxX<0)
+            {
+                r.x0 = r.y0 = r.x1 = r.y1 = 0; // empty frame, nothing to draw
+                continue;
+            }
+
+            // one texel of padding so linear filtering keeps the soft edge
+            if(minX>0) minX--;
+            if(minY>0) minY--;
+            if(maxX<cellW-1) maxX++;
+            if(maxY<cellH-1) maxY++;
+
+            r.x0 = (float)minX/cellW;
+            r.y0 = (float)minY/cellH;
+            r.x1 = (float)(maxX+1)/cellW;
+            r.y1 = (float)(maxY+1)/cellH;
+
+            trimmedArea += (double)(maxX-minX+1)*(maxY-minY+1);
+        }
+}
+
+void _spriteTrim::inset(int levels, int w, int h)
+{
+    if(levels<2) return;
+    if(framesX==1 && framesY==1) return; // no neighbouring frames to bleed in
+
+    int cellW = w/framesX;
+    int cellH = h/framesY;
+    if(cellW<=0 || cellH<=0) return;
+
+    // the chain keeps frames apart but the frames touch, so bilinear filtering on
+    // level k still reads half a texel (2^(k-1) base texels) past a frame's edge.
+    // rects reaching the edge are pulled in by that much for the last level
+    float texels = (float)(1<<(levels-2));
+    float ix = texels/cellW, iy = texels/cellH;
+
+    for(trimRect &r : rects)
+    {
+        if(r.x1<=r.x0 || r.y1<=r.y0) continue; // empty frame
+        if(2*ix<1)
+        {
+            if(r.x0<ix) r.x0 = ix;
+            if(r.x1>1-ix) r.x1 = 1-ix;
+        }
+        if(2*iy<1)
+        {
+            if(r.y0<iy) r.y0 = iy;
+            if(r.y1>1-iy) r.y1 = 1-iy;
+        }
+    }
+}
+
+const trimRect &_spriteTrim::frame(float xMin, float yMin) const
+{
+    // animations keep adding a frame width to xMin and rely on GL_REPEAT, so wrap it
+    int col = (int)floor(xMin*framesX+0.5f) % framesX;
+    int row = (int)floor(yMin*framesY+0.5f) % framesY;
+    if(col<0) col += framesX;
+    if(row<0) row += framesY;
+
+    return rects[row*framesX+col];
+}
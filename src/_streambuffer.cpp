@@ -0,0 +1,171 @@
+#include "_streambuffer.h"
+#include "_timer.h"
+#include "_softrastergl.h"
+
+_streamBuffer::_streamBuffer()
+{
+    //ctor
+    persistent = false;
+    waits = overflows = 0;
+    waitMs = 0;
+    soft = nullptr;
+
+    buffer = 0;
+    mapped = nullptr;
+    for(int i=0; i<STREAM_REGIONS; i++) fences[i] = 0;
+    region = 0;
+    cursor = 0;
+    clientCursor = 0;
+}
+
+_streamBuffer::~_streamBuffer()
+{
+    //dtor
+    for(int i=0; i<STREAM_REGIONS; i++)
+        if(fences[i]) _glext::DeleteSync(fences[i]);
+
+    if(buffer)
+    {
+        _glext::BindBuffer(GL_ARRAY_BUFFER,buffer);
+        _glext::UnmapBuffer(GL_ARRAY_BUFFER);
+        _glext::BindBuffer(GL_ARRAY_BUFFER,0);
+        _glext::DeleteBuffers(1,&buffer);
+    }
+}
+
+void _streamBuffer::initStream()
+{
+    client.resize(STREAM_REGION_BYTES);
+
+    if(!_glCaps::supported(_glCaps::PATH_PERSISTENT)) return;
+
+    // immutable storage mapped once for the whole run, coherent so writes need no flush
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLsizeiptr size = (GLsizeiptr)STREAM_REGIONS*STREAM_REGION_BYTES;
+
+    _glext::GenBuffers(1,&buffer);
+    _glext::BindBuffer(GL_ARRAY_BUFFER,buffer);
+    _glext::BufferStorage(GL_ARRAY_BUFFER,size,nullptr,flags);
+    mapped = (unsigned char*)_glext::MapBufferRange(GL_ARRAY_BUFFER,0,size,flags);
+    _glext::BindBuffer(GL_ARRAY_BUFFER,0);
+
+    if(!mapped)
+    {
+        cout<<"stream: persistent map failed, using client memory"<<endl;
+        _glext::DeleteBuffers(1,&buffer);
+        buffer = 0;
+        return;
+    }
+    persistent = true;
+    cout<<"stream: "<<STREAM_REGIONS<<" x "<<STREAM_REGION_BYTES/1024<<" KB persistent ring"<<endl;
+}
+
+void _streamBuffer::beginFrame()
+{
+    region = (region+1)%STREAM_REGIONS;
+    cursor = 0;
+    clientCursor = 0;
+
+    if(!fences[region]) return;
+
+    // normally long signalled, only a gpu running STREAM_REGIONS frames behind makes us wait
+    GLenum r = _glext::ClientWaitSync(fences[region],0,0);
+    if(r==GL_TIMEOUT_EXPIRED)
+    {
+        double start = _timer::nowMs();
+        do
+            r = _glext::ClientWaitSync(fences[region],GL_SYNC_FLUSH_COMMANDS_BIT,1000000); // 1 ms slices
+        while(r==GL_TIMEOUT_EXPIRED);
+        waits++;
+        waitMs += _timer::nowMs()-start;
+    }
+    _glext::DeleteSync(fences[region]);
+    fences[region] = 0;
+}
+
+void _streamBuffer::endFrame()
+{
+    if(persistent && cursor>0)
+        fences[region] = _glext::FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+}
+
+streamSpan _streamBuffer::alloc(int feature, int count, int stride)
+{
+    streamSpan s = {nullptr, 0, _glCaps::paths[feature], stride};
+    size_t bytes = (size_t)count*stride;
+
+    if(s.path==_glCaps::PATH_PERSISTENT && persistent)
+    {
+        // round up so the span starts on a whole vertex of its own layout counted from the
+        // buffer start, which is what first indexes from; a region isn't a multiple of every stride
+        size_t regionStart = (size_t)region*STREAM_REGION_BYTES;
+        size_t base = (regionStart+cursor+stride-1)/stride*stride;
+        size_t at = base-regionStart;
+        if(at+bytes<=STREAM_REGION_BYTES)
+        {
+            s.ptr = mapped+base;
+            s.first = (GLint)(base/stride);
+            cursor = at+bytes;
+            return s;
+        }
+    }
+    else
+    {
+        if(s.path==_glCaps::PATH_PERSISTENT) s.path = _glCaps::PATH_CLIENT_ARRAYS;
+
+        size_t at = (clientCursor+stride-1)/stride*stride;
+        if(at+bytes<=client.size())
+        {
+            s.ptr = &client[at];
+            s.first = (GLint)(at/stride);
+            clientCursor = at+bytes;
+            return s;
+        }
+    }
+
+    if(overflows++==0) cout<<"stream: frame is out of vertex space, dropping draws"<<endl;
+    return s;
+}
+
+void _streamBuffer::draw(const streamSpan &s, GLenum mode, GLsizei count)
+{
+    if(!s.ptr || count<=0) return;
+    if(soft) soft->fromGL(s,mode,count);
+
+    bool colored = s.stride==(int)sizeof(streamColorVertex);
+
+    if(s.path==_glCaps::PATH_IMMEDIATE)
+    {
+        // client memory, so reading it back is fine here
+        glBegin(mode);
+        for(GLsizei i=0; i<count; i++)
+        {
+            const streamColorVertex *v = (const streamColorVertex*)((const unsigned char*)s.ptr+i*s.stride);
+            if(colored) glColor4f(v->r,v->g,v->b,v->a);
+            glTexCoord2f(v->u,v->v);
+            glVertex3f(v->x,v->y,v->z);
+        }
+        glEnd();
+        return;
+    }
+
+    // the persistent ring draws from offset 0 of the buffer, client spans from the scratch region
+    uintptr_t base = (s.path==_glCaps::PATH_PERSISTENT)? 0 : (uintptr_t)&client[0];
+    if(s.path==_glCaps::PATH_PERSISTENT) _glext::BindBuffer(GL_ARRAY_BUFFER,buffer);
+
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(3,GL_FLOAT,s.stride,(const GLvoid*)base);
+    glTexCoordPointer(2,GL_FLOAT,s.stride,(const GLvoid*)(base+3*sizeof(float)));
+    if(colored)
+    {
+        glEnableClientState(GL_COLOR_ARRAY);
+        glColorPointer(4,GL_FLOAT,s.stride,(const GLvoid*)(base+5*sizeof(float)));
+    }
+
+    glDrawArrays(mode,s.first,count);
+
+    glPopClientAttrib();
+    if(s.path==_glCaps::PATH_PERSISTENT) _glext::BindBuffer(GL_ARRAY_BUFFER,0);
+}
@@ -1,32 +1,505 @@
 #include "_textureloader.h"
+#include "_textureregistry.h"
+#include "_glext.h"
+#include "_glcaps.h"
+#include <vector>
+#include <unordered_map>
+#include <string.h>
+#include <stdio.h>
+
+const char *_textureLoader::formatNames[TEX_FORMAT_COUNT] = {"auto","rgba8","rgb8","l8","a8","la8","palette8","bc1","bc3","bc7"};
+long long _textureLoader::totalBytes = 0;
+long long _textureLoader::totalRGBA8Bytes = 0;
+
+// bytes per texel of each upload format (palette entries are counted separately, blocks by level size)
+static const int texelBytes[_textureLoader::TEX_FORMAT_COUNT] = {4,4,3,1,1,2,1,0,0,0};
+
+// what the decoded pixels actually use, decides which formats are lossless
+struct pixelStats
+{
+    bool opaque;  // alpha is 255 everywhere
+    bool gray;    // r==g==b wherever something is visible
+    bool white;   // rgb is 255 wherever something is visible, only alpha carries data
+};
+
+static void readTexel(const unsigned char *p, int channels, unsigned char &r, unsigned char &g, unsigned char &b, unsigned char &a)
+{
+    switch(channels)
+    {
+        case 1: r=g=b=p[0]; a=255; break;
+        case 2: r=g=b=p[0]; a=p[1]; break;
+        case 3: r=p[0]; g=p[1]; b=p[2]; a=255; break;
+        default: r=p[0]; g=p[1]; b=p[2]; a=p[3]; break;
+    }
+}
+
+static pixelStats analyse(const unsigned char *px, size_t n, int channels)
+{
+    pixelStats st = {true,true,true};
+    unsigned char r,g,b,a;
+
+    for(size_t i=0; i<n; i++)
+    {
+        readTexel(px+i*channels,channels,r,g,b,a);
+        if(a<255) st.opaque = false;
+        if(a==0) continue; // color under zero alpha never shows
+        if(r!=g || g!=b) st.gray = false;
+        if((r&g&b)!=255) st.white = false;
+    }
+    return st;
+}
 
 _textureLoader::_textureLoader()
 {
     //ctor
+    width = height = 0;
+    image = nullptr;
+    tex = 0;
+    format = TEX_RGBA8;
+    gpuBytes = 0;
+    mipLevels = 1;
+    minFilter = GL_LINEAR;
 }
 
 _textureLoader::~_textureLoader()
 {
     //dtor
 }
-void _textureLoader::loadTexture(char* fileName)
+
+int _textureLoader::buildPalette(int channels, unsigned char *indices, unsigned char *palette)
 {
-    glGenTextures(1,&tex);
-    glBindTexture(GL_TEXTURE_2D,tex);
+    std::unordered_map<unsigned int,unsigned char> lookup;
+    size_t n = (size_t)width*height;
+    unsigned char r,g,b,a;
+
+    for(size_t i=0; i<n; i++)
+    {
+        readTexel(image+i*channels,channels,r,g,b,a);
+        unsigned int key = (r<<24)|(g<<16)|(b<<8)|a;
 
-    image = SOIL_load_image(fileName,&width,&height,0,SOIL_LOAD_RGBA);
+        auto it = lookup.find(key);
+        if(it==lookup.end())
+        {
+            int next = (int)lookup.size();
+            if(next>=256) return -1; // too many colors for 8 bit indices
 
-    if(!image)cout<< "Fail to Load Image"<<endl;
-    glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA,width,height,0,GL_RGBA,GL_UNSIGNED_BYTE,image);
+            palette[next*4+0] = r;
+            palette[next*4+1] = g;
+            palette[next*4+2] = b;
+            palette[next*4+3] = a;
+            it = lookup.insert(std::make_pair(key,(unsigned char)next)).first;
+        }
+        indices[i] = it->second;
+    }
+    return (int)lookup.size();
+}
+
+int _textureLoader::pickFormat(int channels, int requested, int paletteSize, std::string &log)
+{
+    pixelStats st = analyse(image,(size_t)width*height,channels);
+
+    bool lossless[TEX_FORMAT_COUNT];
+    lossless[TEX_AUTO]             = false;
+    lossless[TEX_RGBA8]            = true;
+    lossless[TEX_RGB8]             = st.opaque;
+    lossless[TEX_LUMINANCE8]       = st.opaque && st.gray;
+    lossless[TEX_ALPHA8]           = st.white;
+    lossless[TEX_LUMINANCE_ALPHA8] = st.gray;
+    lossless[TEX_PALETTE8]         = paletteSize>0;
+    lossless[TEX_BC1] = lossless[TEX_BC3] = lossless[TEX_BC7] = false; // never encoded at load time
+
+    if(requested!=TEX_AUTO && requested<TEX_FORMAT_COUNT)
+    {
+        if(lossless[requested]) return requested;
+
+        // no paletted texture support is expected on most drivers, fall back quietly
+        if(requested!=TEX_PALETTE8 || _glext::hasPalettedTexture)
+            log += std::string("texture: ")+formatNames[requested]+" would lose data, picking another format\n";
+    }
+
+    // cheapest first
+    static const int order[] = {TEX_LUMINANCE8, TEX_ALPHA8, TEX_PALETTE8, TEX_LUMINANCE_ALPHA8, TEX_RGB8, TEX_RGBA8};
+    for(int f : order)
+        if(lossless[f]) return f;
+    return TEX_RGBA8;
+}
 
-    SOIL_free_image_data(image);
+static void setDefaultParams(int levels, GLenum minFilter)
+{
     glEnable(GL_TEXTURE_2D);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,levels-1); // a short chain is still complete
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,minFilter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,GL_REPEAT);
 }
 
+void _textureLoader::ddsPath(const char *fileName, char *out, size_t outSize)
+{
+    // swap the extension, a dot inside a directory name doesn't count
+    const char *dot = strrchr(fileName,'.');
+    const char *slash = strrchr(fileName,'/');
+    const char *bslash = strrchr(fileName,'\\');
+    if(!slash || (bslash && bslash>slash)) slash = bslash;
+    size_t stem = (dot && (!slash || dot>slash))? (size_t)(dot-fileName) : strlen(fileName);
+
+    snprintf(out,outSize,"%.*s.dds",(int)stem,fileName);
+}
+
+bool _textureLoader::ddsCurrent(const char *fileName, const char *dds)
+{
+    // without both there is nothing to compare, a missing .dds just fails to load
+    WIN32_FILE_ATTRIBUTE_DATA src, baked;
+    if(!GetFileAttributesEx(fileName,GetFileExInfoStandard,&src) || !GetFileAttributesEx(dds,GetFileExInfoStandard,&baked)) return true;
+
+    unsigned long long srcTime = ((unsigned long long)src.ftLastWriteTime.dwHighDateTime<<32) | src.ftLastWriteTime.dwLowDateTime;
+    unsigned long long bakedTime = ((unsigned long long)baked.ftLastWriteTime.dwHighDateTime<<32) | baked.ftLastWriteTime.dwLowDateTime;
+    return srcTime<=bakedTime;
+}
+
+bool _textureLoader::decode(const char *fileName, decodedTexture &out)
+{
+    out.fileName = fileName;
+    out.hasBlocks = false;
+    out.pixels.clear();
+    out.log.clear();
+
+    // a baked .dds next to the image goes straight to the driver, with whatever levels it was baked with
+    char path[MAX_PATH];
+    ddsPath(fileName,path,sizeof(path));
+    bool stale = !ddsCurrent(fileName,path);
+    if(stale) out.log += std::string(path)+": older than "+fileName+", loading the image instead (rebake it)\n";
+    if(!stale && _dxt::loadDDS(path,out.dds))
+    {
+        int texPath = _glCaps::paths[_glCaps::TEXTURES];
+        bool supported = (out.dds.format==_dxt::BC7)? texPath==_glCaps::PATH_BPTC : texPath!=_glCaps::PATH_UNCOMPRESSED;
+        out.width = out.dds.width;
+        out.height = out.dds.height;
+
+        if(supported)
+        {
+            out.hasBlocks = true;
+            out.channels = 4;
+            return true;
+        }
+
+        // no bc7 decoder on the cpu side, the source image is still there to fall back on
+        if(out.dds.format!=_dxt::BC7)
+        {
+            out.channels = 4;
+            out.pixels.resize((size_t)out.width*out.height*4);
+            _dxt::decode(out.dds,0,&out.pixels[0]);
+            out.log += std::string(path)+": no s3tc support, decompressing\n";
+            return true;
+        }
+    }
+
+    // keep the file's own channel count rather than expanding everything to rgba
+    unsigned char *px = SOIL_load_image(fileName,&out.width,&out.height,&out.channels,SOIL_LOAD_AUTO);
+    if(!px) return false;
+
+    out.pixels.assign(px,px+(size_t)out.width*out.height*out.channels);
+    SOIL_free_image_data(px);
+    return true;
+}
+
+void _textureLoader::packBlocks(decodedTexture &dec, packedTexture &out, _spriteTrim *trim)
+{
+    _dxt::image &dds = dec.dds;
+    char path[MAX_PATH];
+    ddsPath(dec.fileName.c_str(),path,sizeof(path));
+    out.fileName = dec.fileName;
+    out.loadedFrom = path;
+
+    if(trim)
+    {
+        if(dds.format==_dxt::BC7)
+            out.log += std::string(path)+": bc7 can't be trimmed, drawing whole frames\n";
+        else
+        {
+            std::vector<unsigned char> rgba((size_t)dds.width*dds.height*4);
+            _dxt::decode(dds,0,&rgba[0]);
+            trim->build(&rgba[0],dds.width,dds.height,4);
+            trim->inset((int)dds.levels.size(),dds.width,dds.height);
+        }
+    }
+
+    out.format = TEX_BC1;
+    if(dds.format==_dxt::BC3) out.format = TEX_BC3;
+    if(dds.format==_dxt::BC7) out.format = TEX_BC7;
+
+    for(size_t i=0; i<dds.levels.size(); i++)
+    {
+        const _dxt::level &lv = dds.levels[i];
+        out.offsets.push_back(lv.offset);
+        out.sizes.push_back(lv.size);
+        out.widths.push_back(lv.width);
+        out.heights.push_back(lv.height);
+        out.rgbaBytes += (long long)lv.width*lv.height*4;
+    }
+    out.width = dds.width;
+    out.height = dds.height;
+    out.data.swap(dds.data);
+}
+
+void _textureLoader::uploadLevel(int level, int w, int h, const unsigned char *texels)
+{
+    switch(format)
+    {
+        case TEX_RGBA8:
+            glTexImage2D(GL_TEXTURE_2D,level,GL_RGBA8,w,h,0,GL_RGBA,GL_UNSIGNED_BYTE,texels); break;
+        case TEX_RGB8:
+            glTexImage2D(GL_TEXTURE_2D,level,GL_RGB8,w,h,0,GL_RGB,GL_UNSIGNED_BYTE,texels); break;
+        case TEX_LUMINANCE8:
+            glTexImage2D(GL_TEXTURE_2D,level,GL_LUMINANCE8,w,h,0,GL_LUMINANCE,GL_UNSIGNED_BYTE,texels); break;
+        case TEX_ALPHA8:
+            glTexImage2D(GL_TEXTURE_2D,level,GL_ALPHA8,w,h,0,GL_ALPHA,GL_UNSIGNED_BYTE,texels); break;
+        case TEX_LUMINANCE_ALPHA8:
+            glTexImage2D(GL_TEXTURE_2D,level,GL_LUMINANCE8_ALPHA8,w,h,0,GL_LUMINANCE_ALPHA,GL_UNSIGNED_BYTE,texels); break;
+        case TEX_PALETTE8:
+            glTexImage2D(GL_TEXTURE_2D,level,GL_COLOR_INDEX8_EXT,w,h,0,GL_COLOR_INDEX,GL_UNSIGNED_BYTE,texels); break;
+    }
+}
+
+void _textureLoader::loadTexture(char* fileName, _spriteTrim* trim, int requested, bool mipmaps)
+{
+    decodedTexture dec;
+    if(!decode(fileName,dec))
+    {
+        cout<<dec.log;
+        cout<< "Fail to Load Image"<<endl;
+        tex = 0;
+        return;
+    }
+    upload(dec,trim,requested,mipmaps);
+}
+
+void _textureLoader::upload(decodedTexture &dec, _spriteTrim* trim, int requested, bool mipmaps)
+{
+    packedTexture packed;
+    bool ok = pack(dec,packed,trim,requested,mipmaps);
+    cout<<packed.log;
+    if(!ok || packed.data.empty())
+    {
+        tex = 0;
+        return;
+    }
+    submit(packed,&packed.data[0]);
+}
+
+void _textureLoader::packAll(_jobQueue *jobs, std::vector<textureRequest> &requests)
+{
+    // one job per file, so the biggest image sets the wall time rather than the sum of them
+    for(textureRequest &r : requests)
+    {
+        if(r.base) continue; // nothing to decode
+        textureRequest *req = &r;
+        req->ok = false;
+        jobs->push([req]()
+        {
+            decodedTexture dec;
+            _textureLoader packer; // pack keeps scratch state in the loader
+            // nothing goes to cout from here, the lines would interleave; SOIL's failure text is shared, so it isn't used either
+            bool decoded = decode(req->fileName.c_str(),dec);
+            if(!decoded) req->packed.log = dec.log;
+            req->ok = decoded && packer.pack(dec,req->packed,req->trim,req->format,req->mipmaps)
+                   && !req->packed.data.empty();
+        });
+    }
+    jobs->wait();
+
+    // back on the calling thread, in request order
+    for(textureRequest &r : requests) cout<<r.packed.log;
+}
+
+void _textureLoader::upload(textureRequest &r)
+{
+    if(!r.ok)
+    {
+        tex = 0;
+        return;
+    }
+    submit(r.packed,r.base? r.base : &r.packed.data[0]);
+}
+
+bool _textureLoader::pack(decodedTexture &dec, packedTexture &out, _spriteTrim* trim, int requested, bool mipmaps)
+{
+    out.fileName = dec.fileName;
+    out.log = dec.log;
+    out.loadedFrom.clear();
+    out.data.clear();
+    out.offsets.clear(); out.sizes.clear();
+    out.widths.clear(); out.heights.clear();
+    out.palette.clear();
+    out.rgbaBytes = 0;
+
+    if(dec.hasBlocks)
+    {
+        packBlocks(dec,out,trim);
+        return true;
+    }
+    if(dec.pixels.empty()) return false;
+
+    const char *fileName = dec.fileName.c_str();
+    int channels = dec.channels;
+    width = dec.width;
+    height = dec.height;
+    image = &dec.pixels[0];
+
+    if(trim)
+    {
+        trim->build(image,width,height,channels);
+        if(trim->fullArea>0)
+        {
+            char line[MAX_PATH+64];
+            snprintf(line,sizeof(line),"%s: trimmed frames cover %d%% of the full quads\n",fileName,
+                     (int)(100.0*trim->trimmedArea/trim->fullArea));
+            out.log += line;
+        }
+    }
+
+    size_t n = (size_t)width*height;
+
+    // paletted upload only makes sense when the driver can sample it
+    std::vector<unsigned char> indices;
+    unsigned char palette[256*4] = {0};
+    int paletteSize = -1;
+    if(_glext::hasPalettedTexture && (requested==TEX_PALETTE8 || requested==TEX_AUTO))
+    {
+        indices.resize(n);
+        paletteSize = buildPalette(channels,&indices[0],palette);
+    }
+
+    format = pickFormat(channels,requested,paletteSize,out.log);
+    out.format = format;
+
+    // repack unless the decoded layout already matches
+    static const int layoutChannels[TEX_FORMAT_COUNT] = {0,4,3,1,0,2,0,0,0,0};
+    std::vector<unsigned char> *level0 = &dec.pixels;
+    std::vector<unsigned char> packed;
+    if(format!=TEX_PALETTE8 && layoutChannels[format]!=channels)
+    {
+        packed.resize(n*texelBytes[format]);
+        unsigned char r,g,b,a;
+        unsigned char *d = &packed[0];
+        for(size_t i=0; i<n; i++)
+        {
+            readTexel(image+i*channels,channels,r,g,b,a);
+            switch(format)
+            {
+                case TEX_RGBA8:            *d++=r; *d++=g; *d++=b; *d++=a; break;
+                case TEX_RGB8:             *d++=r; *d++=g; *d++=b; break;
+                case TEX_LUMINANCE8:       *d++=r; break;
+                case TEX_ALPHA8:           *d++=a; break;
+                case TEX_LUMINANCE_ALPHA8: *d++=r; *d++=a; break;
+            }
+        }
+        level0 = &packed;
+    }
+
+    if(format==TEX_PALETTE8)
+    {
+        out.palette.assign(palette,palette+sizeof(palette));
+        level0 = &indices;
+    }
+
+    // the levels go back to back, level 0 is taken over rather than copied
+    _mipChain *chain = nullptr;
+    if(mipmaps)
+    {
+        // alpha position in each packed layout, -1 where there is none
+        static const int alphaByte[TEX_FORMAT_COUNT] = {-1,3,-1,-1,0,1,-1,-1,-1,-1};
+        chain = new _mipChain(texelBytes[format],alphaByte[format],
+                              trim? trim->framesX : 1, trim? trim->framesY : 1, format==TEX_PALETTE8);
+        chain->build(&(*level0)[0],width,height);
+    }
+
+    out.data.swap(*level0);
+    out.data.resize(n*texelBytes[format]);
+    out.offsets.push_back(0);
+    out.sizes.push_back(out.data.size());
+    out.widths.push_back(width);
+    out.heights.push_back(height);
+    out.rgbaBytes = (long long)n*4;
+
+    if(chain)
+    {
+        for(size_t i=0; i<chain->levels.size(); i++)
+        {
+            out.offsets.push_back(out.data.size());
+            out.sizes.push_back(chain->levels[i].size());
+            out.widths.push_back(chain->widths[i]);
+            out.heights.push_back(chain->heights[i]);
+            out.data.insert(out.data.end(),chain->levels[i].begin(),chain->levels[i].end());
+            out.rgbaBytes += (long long)chain->widths[i]*chain->heights[i]*4;
+        }
+        if(trim) trim->inset((int)chain->levels.size()+1,width,height);
+        delete chain;
+    }
+    out.width = width;
+    out.height = height;
+
+    image = nullptr;
+    return true;
+}
+
+void _textureLoader::submit(const packedTexture &p, const unsigned char *base)
+{
+    glGenTextures(1,&tex);
+    glBindTexture(GL_TEXTURE_2D,tex);
+
+    format = p.format;
+    width = p.width;
+    height = p.height;
+    mipLevels = (int)p.offsets.size();
+    gpuBytes = 0;
+
+    GLenum internal = 0;
+    if(format==TEX_BC1) internal = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    if(format==TEX_BC3) internal = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    if(format==TEX_BC7) internal = GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+
+    if(format==TEX_PALETTE8 && !p.palette.empty())
+    {
+        // the palette stays in client memory, so step out of an unpack buffer for it
+        GLint unpack = 0;
+        if(!base) glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING,&unpack);
+        if(unpack) _glext::BindBuffer(GL_PIXEL_UNPACK_BUFFER,0);
+        _glext::ColorTable(GL_TEXTURE_2D,GL_RGBA8,256,GL_RGBA,GL_UNSIGNED_BYTE,&p.palette[0]);
+        if(unpack) _glext::BindBuffer(GL_PIXEL_UNPACK_BUFFER,unpack);
+        gpuBytes += p.palette.size();
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT,1); // rgb and single channel rows aren't 4 byte multiples
+    for(int i=0; i<mipLevels; i++)
+    {
+        // with an unpack buffer bound base is null and the offset is into the buffer
+        const unsigned char *texels = base? base+p.offsets[i] : (const unsigned char*)p.offsets[i];
+        if(internal)
+            _glext::CompressedTexImage2D(GL_TEXTURE_2D,i,internal,p.widths[i],p.heights[i],0,(GLsizei)p.sizes[i],texels);
+        else
+            uploadLevel(i,p.widths[i],p.heights[i],texels);
+        gpuBytes += p.sizes[i]; // drivers may pad rgb8 to 4 bytes, this counts what was asked for
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT,4);
+
+    totalBytes += gpuBytes;
+    totalRGBA8Bytes += p.rgbaBytes;
+    minFilter = mipLevels>1? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+
+    cout<<(p.loadedFrom.empty()? p.fileName : p.loadedFrom)<<": "<<width<<"x"<<height<<" "<<formatNames[format]<<", "<<mipLevels<<" levels, "<<gpuBytes/1024<<" KB"<<endl;
+    _textureRegistry::add(p.fileName,tex,gpuBytes); // the caller holds the one reference
+
+    setDefaultParams(mipLevels,minFilter);
+}
+
+void _textureLoader::reportMemory()
+{
+    long long saved = totalRGBA8Bytes-totalBytes;
+    cout<<"textures: "<<totalBytes/1024<<" KB uploaded, "<<totalRGBA8Bytes/1024<<" KB as rgba8, "
+        <<saved/1024<<" KB saved"<<endl;
+}
+
 void _textureLoader::textureBinder()
 {
     glBindTexture(GL_TEXTURE_2D,tex);
@@ -0,0 +1,110 @@
+#include "_textureregistry.h"
+#include <ctype.h>
+#include <vector>
+
+long long _textureRegistry::liveBytes = 0;
+int _textureRegistry::liveCount = 0;
+std::map<std::string, GLuint> _textureRegistry::byPath;
+std::map<GLuint, _textureRegistry::entry> _textureRegistry::byName;
+
+std::string _textureRegistry::normalize(const char *path)
+{
+    // windows paths: case and slash direction don't matter
+    std::string p = path? path : "";
+    for(size_t i=0; i<p.size(); i++)
+    {
+        if(p[i]=='\\') p[i] = '/';
+        p[i] = (char)tolower((unsigned char)p[i]);
+    }
+
+    // split on slashes, drop empty and . segments, let .. eat the one before it
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while(start<=p.size())
+    {
+        size_t slash = p.find('/',start);
+        if(slash==std::string::npos) slash = p.size();
+        std::string part = p.substr(start,slash-start);
+        start = slash+1;
+
+        if(part.empty() || part==".") continue;
+        if(part==".." && !parts.empty() && parts.back()!="..") parts.pop_back();
+        else parts.push_back(part);
+    }
+
+    std::string out = (!p.empty() && p[0]=='/')? "/" : "";
+    for(size_t i=0; i<parts.size(); i++) out += (i? "/" : "")+parts[i];
+    return out;
+}
+
+GLuint _textureRegistry::acquire(const char *path, _spriteTrim *trim, int format, bool mipmaps)
+{
+    std::map<std::string, GLuint>::iterator it = byPath.find(normalize(path));
+    if(it!=byPath.end())
+    {
+        retain(it->second);
+        return it->second;
+    }
+
+    // submit() adds it, with the reference handed to the caller
+    _textureLoader loader;
+    loader.loadTexture((char*)path,trim,format,mipmaps);
+    return loader.tex;
+}
+
+void _textureRegistry::add(const std::string &path, GLuint tex, long long bytes)
+{
+    if(!tex || byName.count(tex)) return;
+
+    entry e;
+    e.path = normalize(path.c_str());
+    e.tex = tex;
+    e.refs = 1;
+    e.bytes = bytes;
+    byName[tex] = e;
+    if(!byPath.count(e.path)) byPath[e.path] = tex; // a second copy (a variant swap in flight) isn't shared
+
+    liveBytes += bytes;
+    liveCount++;
+}
+
+void _textureRegistry::retain(GLuint tex)
+{
+    std::map<GLuint, entry>::iterator it = byName.find(tex);
+    if(it!=byName.end()) it->second.refs++;
+}
+
+void _textureRegistry::release(GLuint tex)
+{
+    if(!tex) return;
+
+    std::map<GLuint, entry>::iterator it = byName.find(tex);
+    if(it==byName.end())
+    {
+        glDeleteTextures(1,&tex);
+        return;
+    }
+    if(--it->second.refs>0) return;
+
+    std::map<std::string, GLuint>::iterator p = byPath.find(it->second.path);
+    if(p!=byPath.end() && p->second==tex) byPath.erase(p);
+    liveBytes -= it->second.bytes;
+    liveCount--;
+    byName.erase(it);
+    glDeleteTextures(1,&tex);
+}
+
+const _textureRegistry::entry *_textureRegistry::find(GLuint tex)
+{
+    std::map<GLuint, entry>::iterator it = byName.find(tex);
+    return it==byName.end()? nullptr : &it->second;
+}
+
+void _textureRegistry::report()
+{
+    printf("%-40s %5s %6s %8s\n", "texture", "name", "refs", "KB");
+    for(std::map<GLuint, entry>::iterator it = byName.begin(); it!=byName.end(); ++it)
+        printf("%-40s %5u %6d %8lld\n", it->second.path.c_str(), it->first, it->second.refs, it->second.bytes/1024);
+    printf("%d live textures, %lld KB\n", liveCount, liveBytes/1024);
+    fflush(stdout);
+}
@@ -0,0 +1,223 @@
+#include "_tilemap.h"
+#include "_streambuffer.h"
+#include <fstream>
+#include <string>
+#include <math.h>
+
+_tilemap::_tilemap()
+{
+    //ctor
+    width = height = 0;
+    tileSize = 0.25f;
+    originX = 0;
+    originY = -1.25f;
+    z = -3.0f;
+    scrollX = 0;
+    atlasX = atlasY = 1;
+
+    chunksDrawn = chunksBuilt = 0;
+    chunksX = chunksY = 0;
+    path = _glCaps::PATH_DISPLAY_LIST;
+}
+
+_tilemap::~_tilemap()
+{
+    //dtor
+    freeChunks();
+}
+
+void _tilemap::freeChunks()
+{
+    for(chunk &c : chunks)
+    {
+        if(!c.id) continue;
+        if(path==_glCaps::PATH_VBO) _glext::DeleteBuffers(1,&c.id);
+        else                        glDeleteLists(c.id,1);
+    }
+    chunks.clear();
+}
+
+bool _tilemap::loadMap(const char *fileName)
+{
+    std::ifstream file(fileName);
+    if(!file)
+    {
+        cout<<"tilemap: could not open "<<fileName<<endl;
+        return false;
+    }
+    return loadMap(file);
+}
+
+bool _tilemap::loadMap(std::istream &file)
+{
+    std::vector<std::string> rows;
+    std::string line;
+    size_t w = 0;
+    while(std::getline(file,line))
+    {
+        if(!line.empty() && line[line.size()-1]=='\r') line.erase(line.size()-1);
+        if(line.empty() || line[0]==';') continue; // comments
+        rows.push_back(line);
+        if(line.size()>w) w = line.size();
+    }
+    if(rows.empty() || w==0) return false;
+
+    freeChunks();
+    path = _glCaps::paths[_glCaps::TILES];
+    width = (int)w;
+    height = (int)rows.size();
+    tiles.assign((size_t)width*height,0);
+
+    // the file lists the top row first, the array starts at the bottom like the world
+    for(int r=0; r<height; r++)
+    {
+        const std::string &row = rows[height-1-r];
+        for(int x=0; x<(int)row.size(); x++)
+        {
+            char c = row[x];
+            int id = c=='#'? 1 : (c>='1' && c<='9')? c-'0' : 0;
+            tiles[(size_t)r*width+x] = (unsigned char)id;
+        }
+    }
+
+    chunksX = (width+TILE_CHUNK-1)/TILE_CHUNK;
+    chunksY = (height+TILE_CHUNK-1)/TILE_CHUNK;
+    chunk empty = {0,0,true};
+    chunks.assign((size_t)chunksX*chunksY,empty);
+
+    cout<<"tilemap: "<<width<<"x"<<height<<" tiles in "<<chunksX*chunksY<<" chunks"<<endl;
+    return true;
+}
+
+int _tilemap::tile(int x, int y)
+{
+    if(x<0 || y<0 || x>=width || y>=height) return 0;
+    return tiles[(size_t)y*width+x];
+}
+
+void _tilemap::setTile(int x, int y, int id)
+{
+    if(x<0 || y<0 || x>=width || y>=height) return;
+    unsigned char &t = tiles[(size_t)y*width+x];
+    if(t==id) return;
+
+    t = (unsigned char)id;
+    chunks[(y/TILE_CHUNK)*chunksX + x/TILE_CHUNK].dirty = true;
+}
+
+void _tilemap::scroll(float dx)
+{
+    float levelW = width*tileSize;
+    if(levelW<=0) return;
+
+    scrollX = fmodf(scrollX+dx,levelW);
+    if(scrollX<0) scrollX += levelW;
+}
+
+void _tilemap::buildChunk(int cx, int cy)
+{
+    chunk &c = chunks[cy*chunksX+cx];
+    c.dirty = false;
+    chunksBuilt++;
+
+    // one quad per non-empty tile, in the stream's vertex layout
+    std::vector<streamVertex> verts;
+    float du = 1.0f/atlasX, dv = 1.0f/atlasY;
+    for(int ty=cy*TILE_CHUNK; ty<(cy+1)*TILE_CHUNK && ty<height; ty++)
+        for(int tx=cx*TILE_CHUNK; tx<(cx+1)*TILE_CHUNK && tx<width; tx++)
+        {
+            int id = tiles[(size_t)ty*width+tx];
+            if(!id) continue;
+
+            float x0 = originX+tx*tileSize, x1 = x0+tileSize;
+            float y0 = originY+ty*tileSize, y1 = y0+tileSize;
+            float u0 = ((id-1)%atlasX)*du, v0 = ((id-1)/atlasX%atlasY)*dv;
+            float u1 = u0+du, v1 = v0+dv;
+
+            streamVertex q[4];
+            streamPut(&q[0],x0,y0,z,u0,v1); // bottom-left, image rows run top down
+            streamPut(&q[1],x1,y0,z,u1,v1);
+            streamPut(&q[2],x1,y1,z,u1,v0);
+            streamPut(&q[3],x0,y1,z,u0,v0);
+            verts.insert(verts.end(),q,q+4);
+        }
+    c.vertices = (int)verts.size();
+
+    if(path==_glCaps::PATH_VBO)
+    {
+        if(!c.id) _glext::GenBuffers(1,&c.id);
+        _glext::BindBuffer(GL_ARRAY_BUFFER,c.id);
+        _glext::BufferData(GL_ARRAY_BUFFER,verts.size()*sizeof(streamVertex),verts.empty()? nullptr : &verts[0],GL_STATIC_DRAW);
+        _glext::BindBuffer(GL_ARRAY_BUFFER,0);
+        return;
+    }
+
+    if(!c.id) c.id = glGenLists(1);
+    glNewList(c.id,GL_COMPILE);
+    glBegin(GL_QUADS);
+    for(const streamVertex &v : verts)
+    {
+        glTexCoord2f(v.u,v.v);
+        glVertex3f(v.x,v.y,v.z);
+    }
+    glEnd();
+    glEndList();
+}
+
+void _tilemap::draw(GLuint tex, float halfView)
+{
+    chunksDrawn = chunksBuilt = 0;
+    if(chunks.empty()) return;
+
+    float chunkW = TILE_CHUNK*tileSize;
+    float levelW = width*tileSize;
+    float left = scrollX-halfView, right = scrollX+halfView;
+
+    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+    glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+    glDisable(GL_LIGHTING);
+    glEnable(GL_TEXTURE_2D);
+    glColor3f(1.0,1.0,1.0);
+    glBindTexture(GL_TEXTURE_2D,tex);
+    if(path==_glCaps::PATH_VBO)
+    {
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    }
+
+    // the level repeats, so the view can straddle the end and the start of it
+    for(int copy=-1; copy<=1; copy++)
+    {
+        float shift = copy*levelW;
+        if(originX+shift+levelW<left || originX+shift>right) continue;
+
+        glPushMatrix();
+        glTranslatef(shift-scrollX,0,0);
+        for(int cy=0; cy<chunksY; cy++)
+            for(int cx=0; cx<chunksX; cx++)
+            {
+                float x0 = originX+shift+cx*chunkW;
+                if(x0+chunkW<left || x0>right) continue;
+
+                chunk &c = chunks[cy*chunksX+cx];
+                if(c.dirty) buildChunk(cx,cy);
+                if(!c.vertices) continue;
+
+                if(path==_glCaps::PATH_VBO)
+                {
+                    _glext::BindBuffer(GL_ARRAY_BUFFER,c.id);
+                    glVertexPointer(3,GL_FLOAT,sizeof(streamVertex),(const GLvoid*)0);
+                    glTexCoordPointer(2,GL_FLOAT,sizeof(streamVertex),(const GLvoid*)(3*sizeof(float)));
+                    glDrawArrays(GL_QUADS,0,c.vertices);
+                }
+                else glCallList(c.id);
+                chunksDrawn++;
+            }
+        glPopMatrix();
+    }
+
+    if(path==_glCaps::PATH_VBO) _glext::BindBuffer(GL_ARRAY_BUFFER,0);
+    glBindTexture(GL_TEXTURE_2D,0);
+    glPopClientAttrib();
+    glPopAttrib();
+}
@@ -34,3 +34,13 @@ void _timer::reset()
 {
     startTime = clock();
 }
+
+double _timer::nowMs()
+{
+    static LARGE_INTEGER freq = {};
+    if(freq.QuadPart == 0) QueryPerformanceFrequency(&freq);
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart * 1000.0 / (double)freq.QuadPart;
+}
@@ -0,0 +1,229 @@
+#include "_uilayer.h"
+#include "_glcaps.h"
+#include <math.h>
+
+_uiLayer::_uiLayer()
+{
+    //ctor
+    enabled = true;
+    texW = texH = 0;
+    fbo = colorTex = 0;
+    redrawn = 0;
+    stream = nullptr;
+    lineHeight = 0;
+}
+
+_uiLayer::~_uiLayer()
+{
+    //dtor
+    freeTarget();
+}
+
+bool _uiLayer::usable()
+{
+    return enabled && measure && drawLine && stream &&
+           _glCaps::paths[_glCaps::OFFSCREEN]==_glCaps::PATH_FBO && _glext::hasBlendSeparate;
+}
+
+bool _uiLayer::allocTarget(int w, int h)
+{
+    freeTarget();
+
+    // drawn 1:1 over the window, no filtering needed
+    glGenTextures(1,&colorTex);
+    glBindTexture(GL_TEXTURE_2D,colorTex);
+    glTexImage2D(GL_TEXTURE_2D,0,GL_RGBA8,w,h,0,GL_RGBA,GL_UNSIGNED_BYTE,NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D,0);
+
+    _glext::GenFramebuffers(1,&fbo);
+    _glext::BindFramebuffer(GL_FRAMEBUFFER_EXT,fbo);
+    _glext::FramebufferTexture2D(GL_FRAMEBUFFER_EXT,GL_COLOR_ATTACHMENT0_EXT,GL_TEXTURE_2D,colorTex,0);
+    GLenum status = _glext::CheckFramebufferStatus(GL_FRAMEBUFFER_EXT);
+    _glext::BindFramebuffer(GL_FRAMEBUFFER_EXT,0);
+
+    if(status != GL_FRAMEBUFFER_COMPLETE_EXT)
+    {
+        cout<<"ui layer: framebuffer incomplete, drawing the hud every frame"<<endl;
+        freeTarget();
+        enabled = false;
+        return false;
+    }
+
+    texW = w;
+    texH = h;
+    return true;
+}
+
+void _uiLayer::freeTarget()
+{
+    if(fbo)      _glext::DeleteFramebuffers(1,&fbo);
+    if(colorTex) glDeleteTextures(1,&colorTex);
+    fbo = colorTex = 0;
+    texW = texH = 0;
+}
+
+_uiLayer::box _uiLayer::bounds(const line &l)
+{
+    box b;
+    b.x0 = (int)floorf(l.x)-UI_PAD;
+    b.y0 = (int)floorf(l.y)-UI_PAD;
+    b.x1 = (int)ceilf(l.x+(measure? measure(l.text) : 0))+UI_PAD;
+    b.y1 = (int)ceilf(l.y+lineHeight)+UI_PAD;
+    return b;
+}
+
+void _uiLayer::markDirty(box b)
+{
+    // grow an overlapping box until nothing else overlaps it, so no pixel is cleared twice
+    for(size_t i=0; i<dirty.size(); )
+    {
+        box &d = dirty[i];
+        if(d.x0<b.x1 && b.x0<d.x1 && d.y0<b.y1 && b.y0<d.y1)
+        {
+            if(d.x0<b.x0) b.x0 = d.x0;
+            if(d.y0<b.y0) b.y0 = d.y0;
+            if(d.x1>b.x1) b.x1 = d.x1;
+            if(d.y1>b.y1) b.y1 = d.y1;
+            dirty.erase(dirty.begin()+i);
+            i = 0;
+        }
+        else i++;
+    }
+    dirty.push_back(b);
+}
+
+void _uiLayer::set(int slot, const std::string &text, float x, float y, float r, float g, float b)
+{
+    if(slot<0) return;
+    if(slot>=(int)lines.size())
+    {
+        line blank = {"", 0, 0, 1, 1, 1, {0, 0, 0, 0}};
+        lines.resize(slot+1, blank);
+    }
+
+    line &l = lines[slot];
+    if(l.text==text && l.x==x && l.y==y && l.r==r && l.g==g && l.b==b) return; // already in the layer
+
+    if(!l.text.empty()) markDirty(l.at);
+    l.text = text;
+    l.x = x; l.y = y;
+    l.r = r; l.g = g; l.b = b;
+    l.at = bounds(l);
+    if(!l.text.empty()) markDirty(l.at);
+}
+
+void _uiLayer::invalidate()
+{
+    for(line &l : lines) l.at = bounds(l);
+    dirty.clear();
+    box all = {0, 0, texW, texH};
+    dirty.push_back(all);
+}
+
+void _uiLayer::redraw()
+{
+    // these glyphs land in the layer, not the window, keep them out of the cpu renderer's frame
+    _softRasterGL *soft = stream->soft;
+    stream->soft = nullptr;
+    _glext::BindFramebuffer(GL_FRAMEBUFFER_EXT,fbo);
+
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_SCISSOR_BIT | GL_CURRENT_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_SCISSOR_TEST);
+    glEnable(GL_BLEND);
+    // color over alpha as usual, alpha accumulated as coverage: the layer ends up premultiplied
+    _glext::BlendFuncSeparate(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA,GL_ONE,GL_ONE_MINUS_SRC_ALPHA);
+    glClearColor(0,0,0,0);
+
+    for(box &d : dirty)
+    {
+        int x0 = d.x0<0? 0 : d.x0, y0 = d.y0<0? 0 : d.y0;
+        int x1 = d.x1>texW? texW : d.x1, y1 = d.y1>texH? texH : d.y1;
+        if(x1<=x0 || y1<=y0) continue;
+
+        // ortho is top-left origin, the scissor bottom-left
+        glScissor(x0,texH-y1,x1-x0,y1-y0);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        for(line &l : lines)
+        {
+            if(l.text.empty() || l.at.x1<=x0 || l.at.x0>=x1 || l.at.y1<=y0 || l.at.y0>=y1) continue;
+            glColor3f(l.r,l.g,l.b);
+            drawLine(l.text,l.x,l.y);
+        }
+        redrawn++;
+    }
+    dirty.clear();
+
+    glPopAttrib();
+    _glext::BindFramebuffer(GL_FRAMEBUFFER_EXT,0);
+    stream->soft = soft;
+}
+
+void _uiLayer::drawDirect()
+{
+    if(!drawLine) return;
+
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT);
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
+    for(line &l : lines)
+    {
+        if(l.text.empty()) continue;
+        glColor3f(l.r,l.g,l.b);
+        drawLine(l.text,l.x,l.y);
+    }
+    glPopAttrib();
+}
+
+void _uiLayer::present(int w, int h)
+{
+    if(!usable() || w<=0 || h<=0)
+    {
+        drawDirect();
+        return;
+    }
+
+    if(w!=texW || h!=texH)
+    {
+        if(!allocTarget(w,h))
+        {
+            drawDirect();
+            return;
+        }
+        invalidate();
+    }
+    if(!dirty.empty()) redraw();
+
+    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE,GL_ONE_MINUS_SRC_ALPHA); // premultiplied
+
+    glColor4f(1.0,1.0,1.0,1.0);
+    glBindTexture(GL_TEXTURE_2D,colorTex);
+
+    // the layer is bottom-left origin like any render target
+    streamSpan s = stream->alloc(_glCaps::SPRITES,4,sizeof(streamVertex));
+    if(s.ptr)
+    {
+        streamVertex *v = (streamVertex*)s.ptr;
+        streamPut(v++,0,0,0,0,1);
+        streamPut(v++,w,0,0,1,1);
+        streamPut(v++,w,h,0,1,0);
+        streamPut(v++,0,h,0,0,0);
+        stream->draw(s,GL_QUADS,4);
+    }
+
+    glBindTexture(GL_TEXTURE_2D,0);
+    glPopAttrib();
+}
@@ -0,0 +1,205 @@
+#include "_uploadqueue.h"
+#include "_timer.h"
+#include "_textureregistry.h"
+#include <string.h>
+
+_uploadQueue::_uploadQueue(_jobQueue *q)
+{
+    //ctor
+    jobs = q;
+    uploader = new _textureLoader();
+    uploaded = 0;
+    bytes = 0;
+    submitMs = 0;
+
+    for(int i=0; i<UPLOAD_SLOTS; i++)
+    {
+        slots[i].pbo = 0;
+        slots[i].capacity = 0;
+        slots[i].fence = 0;
+        slots[i].state = FREE;
+        slots[i].issuedFrame = 0;
+        slots[i].tex = 0;
+    }
+    frameCount = 0;
+    decoding = 0;
+}
+
+_uploadQueue::~_uploadQueue()
+{
+    //dtor
+    // the job queue is gone by now, so nothing is still copying into a mapping
+    for(int i=0; i<UPLOAD_SLOTS; i++)
+    {
+        if(slots[i].fence) _glext::DeleteSync(slots[i].fence);
+        _textureRegistry::release(slots[i].tex); // never handed over
+        if(slots[i].pbo) _glext::DeleteBuffers(1,&slots[i].pbo); // unmaps it too
+    }
+    delete uploader;
+    uploader = nullptr;
+}
+
+void _uploadQueue::initUploads()
+{
+    if(_glCaps::paths[_glCaps::UPLOADS]!=_glCaps::PATH_PBO) return;
+
+    for(int i=0; i<UPLOAD_SLOTS; i++) _glext::GenBuffers(1,&slots[i].pbo);
+}
+
+int _uploadQueue::pending()
+{
+    int n = decoding+(int)waiting.size();
+    for(int i=0; i<UPLOAD_SLOTS; i++)
+        if(slots[i].state!=FREE) n++;
+    return n;
+}
+
+void _uploadQueue::load(const std::string &fileName, int format, bool mipmaps, std::function<void(GLuint)> ready)
+{
+    std::shared_ptr<packedTexture> packed(new packedTexture);
+    const unsigned char *levels = nullptr;
+    if(pack && pack->texture(fileName.c_str(),format,mipmaps,nullptr,*packed,levels))
+    {
+        request r = {packed, levels, packed->offsets.back()+packed->sizes.back(), ready};
+        waiting.push_back(r);
+        return;
+    }
+
+    decoding++;
+    std::shared_ptr<bool> ok(new bool(false));
+    jobs->push(
+        [fileName, format, mipmaps, packed, ok]()
+        {
+            decodedTexture dec;
+            _textureLoader packer; // pack keeps scratch state in the loader, one per job
+            bool decoded = _textureLoader::decode(fileName.c_str(),dec);
+            if(!decoded) packed->log = dec.log;
+            *ok = decoded && packer.pack(dec,*packed,nullptr,format,mipmaps) && !packed->data.empty();
+        },
+        [this, fileName, packed, ok, ready]()
+        {
+            decoding--;
+            cout<<packed->log; // the worker only collects it
+            if(!*ok)
+            {
+                cout<<fileName<<": failed to load"<<endl;
+                if(ready) ready(0);
+                return;
+            }
+            request r = {packed, &packed->data[0], packed->data.size(), ready};
+            waiting.push_back(r);
+        });
+}
+
+GLuint _uploadQueue::direct(request &r)
+{
+    double t = _timer::nowMs();
+    uploader->submit(*r.packed,r.levels);
+    glBindTexture(GL_TEXTURE_2D,0);
+    submitMs += _timer::nowMs()-t;
+    return uploader->tex;
+}
+
+void _uploadQueue::start(slot *s, request &r)
+{
+    GLsizeiptr size = (GLsizeiptr)r.size;
+
+    _glext::BindBuffer(GL_PIXEL_UNPACK_BUFFER,s->pbo);
+    if(size>s->capacity)
+    {
+        _glext::BufferData(GL_PIXEL_UNPACK_BUFFER,size,nullptr,GL_STREAM_DRAW);
+        s->capacity = size;
+    }
+    // the slot's last upload has passed its fence, so the map never waits on the gpu
+    unsigned char *dst = (unsigned char*)(_glext::hasMapBufferRange?
+        _glext::MapBufferRange(GL_PIXEL_UNPACK_BUFFER,0,size,GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT) :
+        _glext::MapBuffer(GL_PIXEL_UNPACK_BUFFER,GL_WRITE_ONLY));
+    _glext::BindBuffer(GL_PIXEL_UNPACK_BUFFER,0);
+
+    if(!dst)
+    {
+        cout<<r.packed->fileName<<": could not map an unpack buffer, uploading from memory"<<endl;
+        GLuint tex = direct(r);
+        if(r.ready) r.ready(tex);
+        uploaded++;
+        return;
+    }
+
+    // the mapping stays valid until copied(), the worker only writes it
+    s->state = COPYING;
+    s->req = r;
+    std::shared_ptr<packedTexture> packed = r.packed; // keeps decoded levels alive until the copy is done
+    const unsigned char *src = r.levels;
+    size_t n = r.size;
+    jobs->push([dst, packed, src, n]() { memcpy(dst,src,n); },
+               [this, s]() { copied(s); });
+}
+
+void _uploadQueue::copied(slot *s)
+{
+    double t = _timer::nowMs();
+
+    _glext::BindBuffer(GL_PIXEL_UNPACK_BUFFER,s->pbo);
+    _glext::UnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    uploader->submit(*s->req.packed,nullptr); // offsets into the bound buffer
+    glBindTexture(GL_TEXTURE_2D,0);
+    _glext::BindBuffer(GL_PIXEL_UNPACK_BUFFER,0);
+
+    if(_glext::hasSync) s->fence = _glext::FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,0);
+    bytes += s->req.size;
+    s->req.packed.reset(); // the buffer holds the levels now
+    s->tex = uploader->tex;
+    s->issuedFrame = frameCount;
+    s->state = UPLOADING;
+
+    submitMs += _timer::nowMs()-t;
+}
+
+void _uploadQueue::poll()
+{
+    frameCount++;
+
+    if(_glCaps::paths[_glCaps::UPLOADS]!=_glCaps::PATH_PBO)
+    {
+        // no unpack buffers, every upload stalls the frame it runs in
+        if(waiting.empty()) return;
+        request r = waiting.front();
+        waiting.pop_front();
+        GLuint tex = direct(r);
+        if(r.ready) r.ready(tex);
+        uploaded++;
+        return;
+    }
+
+    for(int i=0; i<UPLOAD_SLOTS; i++)
+    {
+        slot *s = &slots[i];
+        if(s->state!=UPLOADING) continue;
+
+        if(s->fence)
+        {
+            GLenum r = _glext::ClientWaitSync(s->fence,0,0);
+            if(r!=GL_ALREADY_SIGNALED && r!=GL_CONDITION_SATISFIED) continue;
+            _glext::DeleteSync(s->fence);
+            s->fence = 0;
+        }
+        else if(frameCount-s->issuedFrame < UPLOAD_DELAY) continue;
+
+        GLuint tex = s->tex;
+        std::function<void(GLuint)> ready = s->req.ready;
+        s->tex = 0;
+        s->req.ready = nullptr;
+        s->state = FREE;
+        uploaded++;
+        if(ready) ready(tex);
+        else _textureRegistry::release(tex);
+    }
+
+    for(int i=0; i<UPLOAD_SLOTS && !waiting.empty(); i++)
+    {
+        if(slots[i].state!=FREE) continue;
+        request r = waiting.front();
+        waiting.pop_front();
+        start(&slots[i],r);
+    }
+}
@@ -0,0 +1,313 @@
+#include "_virtualtexture.h"
+#include "_textureloader.h"
+#include <fstream>
+#include <sstream>
+#include <memory>
+#include <string.h>
+#include <math.h>
+
+static GLenum pixelFormat(int channels)
+{
+    return channels==4? GL_RGBA : channels==3? GL_RGB : channels==2? GL_LUMINANCE_ALPHA : GL_LUMINANCE;
+}
+
+_virtualTexture::_virtualTexture(_jobQueue *q)
+{
+    //ctor
+    jobs = q;
+    stream = nullptr;
+    width = height = 0;
+    tileSize = levels = 0;
+    level = 0;
+    resident = loaded = evicted = 0;
+
+    cacheTex = coarseTex = 0;
+    cacheW = cacheH = slotsX = 0;
+    channels = 3;
+    inFlight = 0;
+    generation = 0;
+    frame = 0;
+    lastU = 0;
+}
+
+_virtualTexture::~_virtualTexture()
+{
+    //dtor
+    if(cacheTex) glDeleteTextures(1,&cacheTex);
+    if(coarseTex) glDeleteTextures(1,&coarseTex);
+}
+
+std::string _virtualTexture::tileName(int l, int c, int r)
+{
+    char suffix[48];
+    snprintf(suffix,sizeof(suffix),"_t%d_%d_%d.tga",l,c,r);
+    return stem+suffix;
+}
+
+bool _virtualTexture::open(const char *fileName)
+{
+    // images/prlx.jpg -> images/prlx.tiles
+    std::string src = fileName;
+    size_t slash = src.find_last_of("/\\");
+    size_t dot = src.find_last_of('.');
+    stem = (dot==std::string::npos || (slash!=std::string::npos && dot<slash))? src : src.substr(0,dot);
+
+    std::ifstream file((stem+".tiles").c_str());
+    std::string line;
+    bool found = false;
+    while(!found && std::getline(file,line))
+    {
+        if(line.empty() || line[0]=='#') continue;
+        std::istringstream ss(line);
+        found = (ss>>width>>height>>tileSize>>levels) && width>0 && height>0 && tileSize>0 && levels>0;
+    }
+    if(!found) return false;
+
+    // the coarsest level is one small tile, kept loaded to draw whatever hasn't streamed in yet
+    decodedTexture dec;
+    bool decoded = _textureLoader::decode(tileName(levels-1,0,0).c_str(),dec);
+    cout<<dec.log;
+    if(!decoded || dec.pixels.empty())
+    {
+        cout<<fileName<<": tile "<<dec.fileName<<" failed to load, drawing the whole image"<<endl;
+        return false;
+    }
+    channels = dec.channels;
+
+    glGenTextures(1,&coarseTex);
+    glBindTexture(GL_TEXTURE_2D,coarseTex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT,1);
+    glTexImage2D(GL_TEXTURE_2D,0,channels==4? GL_RGBA8 : GL_RGB8,dec.width,dec.height,0,pixelFormat(channels),GL_UNSIGNED_BYTE,&dec.pixels[0]);
+    glPixelStorei(GL_UNPACK_ALIGNMENT,4);
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D,0);
+
+    cout<<fileName<<": "<<width<<"x"<<height<<" in "<<tileSize<<" px tiles, "<<levels<<" levels"<<endl;
+    return true;
+}
+
+void _virtualTexture::resize(int w, int h)
+{
+    if(!coarseTex || w<=0 || h<=0) return;
+
+    // the drawn level has one to two texels per pixel, plus a partial tile each side and the prefetch
+    int cols = (2*w+tileSize-1)/tileSize+1+VT_PREFETCH;
+    int rows = (2*h+tileSize-1)/tileSize+1;
+    int maxCols = (width+tileSize-1)/tileSize, maxRows = (height+tileSize-1)/tileSize;
+    if(cols>maxCols) cols = maxCols;
+    if(rows>maxRows) rows = maxRows;
+    int n = cols*rows;
+
+    GLint maxTex = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE,&maxTex);
+    int pitch = tileSize+2, fit = maxTex/pitch;
+    if(fit<1) return;
+    int sx = n<fit? n : fit;
+    int sy = (n+sx-1)/sx;
+    if(sy>fit) { sy = fit; n = sx*sy; }
+    if(cacheTex && n==(int)slots.size() && sx==slotsX) return;
+
+    if(cacheTex) glDeleteTextures(1,&cacheTex);
+    slotsX = sx;
+    cacheW = sx*pitch;
+    cacheH = sy*pitch;
+
+    glGenTextures(1,&cacheTex);
+    glBindTexture(GL_TEXTURE_2D,cacheTex);
+    glTexImage2D(GL_TEXTURE_2D,0,channels==4? GL_RGBA8 : GL_RGB8,cacheW,cacheH,0,pixelFormat(channels),GL_UNSIGNED_BYTE,NULL);
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR); // the level pick does the minifying
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D,0);
+
+    // everything streams in again, decodes still running for the old cache are dropped
+    slot empty = {-1,-1};
+    slots.assign(n,empty);
+    slotOf.clear();
+    pending.clear();
+    resident = 0;
+    generation++;
+
+    cout<<stem<<": "<<w<<"x"<<h<<" window, tile cache "<<cacheW<<"x"<<cacheH<<" with "<<n<<" slots, "
+        <<(long long)cacheW*cacheH*(channels==4? 4 : 3)/1024<<" KB"<<endl;
+}
+
+int _virtualTexture::find(int k)
+{
+    std::map<int, int>::iterator it = slotOf.find(k);
+    if(it==slotOf.end()) return -1;
+    slots[it->second].used = frame;
+    return it->second;
+}
+
+void _virtualTexture::request(int l, int c, int r)
+{
+    int k = key(l,c,r);
+    if(!cacheTex || inFlight>=VT_IN_FLIGHT || pending.count(k)) return;
+    pending.insert(k);
+    inFlight++;
+
+    int gen = generation;
+    std::string name = tileName(l,c,r);
+    std::shared_ptr<decodedTexture> dec(new decodedTexture);
+    std::shared_ptr<bool> ok(new bool(false));
+    jobs->push(
+        [dec, ok, name]() { *ok = _textureLoader::decode(name.c_str(),*dec); },
+        [this, dec, ok, k, gen]()
+        {
+            inFlight--;
+            cout<<dec->log;
+            if(gen!=generation) return; // the cache was reallocated since
+            if(!*ok || dec->pixels.empty())
+            {
+                cout<<dec->fileName<<": tile failed to load, drawing the coarse level there"<<endl;
+                return; // stays pending so it isn't asked for again every frame
+            }
+            pending.erase(k);
+            upload(k,&dec->pixels[0],dec->width,dec->height,dec->channels);
+        });
+}
+
+void _virtualTexture::upload(int k, const unsigned char *pixels, int w, int h, int ch)
+{
+    // a free slot, or the one drawn longest ago as long as it isn't on screen this frame
+    int s = -1;
+    for(int i=0; i<(int)slots.size(); i++)
+    {
+        if(slots[i].key<0) { s = i; break; }
+        if(slots[i].used<frame && (s<0 || slots[i].used<slots[s].used)) s = i;
+    }
+    if(s<0) return; // every slot is visible, asked for again next frame
+
+    if(slots[s].key>=0)
+    {
+        slotOf.erase(slots[s].key);
+        evicted++;
+    }
+
+    int pitch = tileSize+2;
+    if(w>pitch) w = pitch;
+    if(h>pitch) h = pitch;
+
+    glBindTexture(GL_TEXTURE_2D,cacheTex);
+    glPixelStorei(GL_UNPACK_ALIGNMENT,1);
+    glTexSubImage2D(GL_TEXTURE_2D,0,(s%slotsX)*pitch,(s/slotsX)*pitch,w,h,pixelFormat(ch),GL_UNSIGNED_BYTE,pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT,4);
+    glBindTexture(GL_TEXTURE_2D,0);
+
+    slots[s].key = k;
+    slots[s].used = frame;
+    slotOf[k] = s;
+    resident = (int)slotOf.size();
+    loaded++;
+}
+
+void _virtualTexture::flush(std::vector<streamVertex> &quads, GLuint tex)
+{
+    if(quads.empty()) return;
+
+    glBindTexture(GL_TEXTURE_2D,tex);
+    streamSpan s = stream->alloc(_glCaps::SPRITES,(int)quads.size(),sizeof(streamVertex));
+    if(s.ptr)
+    {
+        memcpy(s.ptr,&quads[0],quads.size()*sizeof(streamVertex));
+        stream->draw(s,GL_QUADS,(int)quads.size());
+    }
+}
+
+void _virtualTexture::draw(float x0, float y0, float x1, float y1, float z, float u, int viewH)
+{
+    if(!coarseTex || x1<=x0 || y1<=y0) return;
+    frame++;
+
+    // the smallest level still covering the window height with a texel per pixel
+    level = 0;
+    while(level<levels-1 && levelH(level+1)>=viewH) level++;
+
+    int lw = levelW(level), lh = levelH(level);
+    int cols = (lw+tileSize-1)/tileSize, rows = (lh+tileSize-1)/tileSize;
+    int cw = levelW(levels-1), ch = levelH(levels-1);
+
+    // the image height fills the quad and repeats sideways, like the whole texture did with GL_REPEAT
+    float span = lh*(x1-x0)/(y1-y0);
+    float xs = (x1-x0)/span, ys = (y1-y0)/lh;
+
+    int dir = u>lastU? 1 : u<lastU? -1 : 0;
+    lastU = u;
+
+    cached.clear();
+    coarse.clear();
+
+    float p = (u-floorf(u))*lw, left = span, qx0 = x0;
+    int firstCol = (int)(p/tileSize), lastCol = firstCol;
+    int guard = (int)(span/tileSize)+cols+2;
+    while(left>0 && guard-->0)
+    {
+        int c = (int)(p/tileSize);
+        if(c>=cols) c = cols-1;
+        int end = (c+1)*tileSize<lw? (c+1)*tileSize : lw;
+        float seg = end-p;
+        if(seg>left) seg = left;
+        float qx1 = qx0+seg*xs;
+        lastCol = c;
+
+        for(int r=0; r<rows; r++)
+        {
+            int ty0 = r*tileSize, ty1 = ty0+tileSize<lh? ty0+tileSize : lh;
+            float qy1 = y1-ty0*ys, qy0 = y1-ty1*ys; // image rows run top down
+
+            float tu0, tu1, tv0, tv1;
+            std::vector<streamVertex> *out;
+            int s = find(key(level,c,r));
+            if(s>=0)
+            {
+                // inside the slot's border
+                float ox = (s%slotsX)*(tileSize+2)+1.0f, oy = (s/slotsX)*(tileSize+2)+1.0f;
+                tu0 = (ox+p-c*tileSize)/cacheW;
+                tu1 = tu0+seg/cacheW;
+                tv0 = oy/cacheH;
+                tv1 = (oy+ty1-ty0)/cacheH;
+                out = &cached;
+            }
+            else
+            {
+                request(level,c,r);
+                float fx = (float)cw/lw, fy = (float)ch/lh;
+                tu0 = (1.0f+p*fx)/(cw+2);
+                tu1 = (1.0f+(p+seg)*fx)/(cw+2);
+                tv0 = (1.0f+ty0*fy)/(ch+2);
+                tv1 = (1.0f+ty1*fy)/(ch+2);
+                out = &coarse;
+            }
+
+            streamVertex q[4];
+            streamPut(&q[0],qx0,qy0,z,tu0,tv1);
+            streamPut(&q[1],qx1,qy0,z,tu1,tv1);
+            streamPut(&q[2],qx1,qy1,z,tu1,tv0);
+            streamPut(&q[3],qx0,qy1,z,tu0,tv0);
+            out->insert(out->end(),q,q+4);
+        }
+
+        p += seg;
+        if(p>=lw) p -= lw;
+        left -= seg;
+        qx0 = qx1;
+    }
+
+    // columns about to scroll in, so they are usually resident before they show
+    for(int i=1; dir && i<=VT_PREFETCH; i++)
+    {
+        int c = dir>0? lastCol+i : firstCol-i;
+        c = ((c%cols)+cols)%cols;
+        for(int r=0; r<rows; r++)
+            if(find(key(level,c,r))<0) request(level,c,r);
+    }
+
+    flush(coarse,coarseTex);
+    flush(cached,cacheTex);
+    glBindTexture(GL_TEXTURE_2D,0);
+}
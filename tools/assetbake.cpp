@@ -0,0 +1,543 @@
+// assetbake - offline texture compressor
+//
+//   assetbake [-bc1|-bc3] [-mips] [-frames CxR] image...
+//   assetbake -variants 0.25,0.5,0.75 image...
+//   assetbake -tiles 256 image...
+//   assetbake -pack images/assets.pak [-format F] [-mips|-nomips] [-frames CxR|-noframes] file...
+//   assetbake -font font.fnt...
+//
+// writes image.dds next to each image. without a flag opaque images become
+// bc1 (4 bits per texel) and anything with alpha becomes bc3 (8 bits per texel).
+// -mips adds a mip chain, filtered per frame of a CxR sprite sheet so frames
+// never bleed into each other. flags apply to the images after them.
+// the game picks the .dds up on its own when the driver supports it.
+//
+// -variants writes scaled copies (image_WxH.tga) and an image.variants manifest
+// listing them and the source, the game loads the smallest copy covering the window.
+//
+// -tiles cuts the image and its halvings, down to one that fits a single tile,
+// into image_t<level>_<col>_<row>.tga with a one texel border (wrapping sideways,
+// clamped at the top and bottom) and writes an image.tiles manifest. the game
+// then streams in only the tiles it draws.
+//
+// -pack writes every file after it into one asset pack instead. images are
+// decoded, converted to the -format the game asks for (auto, rgba8, rgb8, l8,
+// a8, la8, palette8) and mipmapped the way _textureLoader does at runtime, with
+// the sprite trim of a -frames grid stored next to them; a baked .dds keeps its
+// blocks. anything else (.fnt, .map) goes in as it is. an image only matches at
+// runtime when it's asked for with the same format, mipmaps and grid.
+//
+// -font compiles each bmfont .fnt into the .fntb next to it (see _fontTable),
+// so the game never parses the text. put the .fntb in the pack to load it from there.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <ctype.h>
+#include <vector>
+#include <SOIL.h>
+#include <string>
+#include <_dxt.h>
+#include <_mipchain.h>
+#include <_assetpack.h>
+#include <_textureregistry.h>
+#include <_glcaps.h>
+#include <_fonttable.h>
+
+// images/help.png + ".dds" -> images/help.dds
+static void siblingName(const char *fileName, const char *suffix, char *out, size_t outSize)
+{
+    const char *dot = strrchr(fileName,'.');
+    const char *slash = strrchr(fileName,'/');
+    const char *bslash = strrchr(fileName,'\\');
+    if(!slash || (bslash && bslash>slash)) slash = bslash;
+    size_t stem = (dot && (!slash || dot>slash))? (size_t)(dot-fileName) : strlen(fileName);
+
+    snprintf(out,outSize,"%.*s%s",(int)stem,fileName,suffix);
+}
+
+static const char *baseName(const char *fileName)
+{
+    const char *slash = strrchr(fileName,'/');
+    const char *bslash = strrchr(fileName,'\\');
+    if(!slash || (bslash && bslash>slash)) slash = bslash;
+    return slash? slash+1 : fileName;
+}
+
+// area average, every destination texel covers a whole number of source texels or more
+static void shrink(const unsigned char *src, int w, int h, int channels, unsigned char *dst, int dw, int dh)
+{
+    for(int y=0; y<dh; y++)
+    {
+        int y0 = (int)((long long)y*h/dh), y1 = (int)((long long)(y+1)*h/dh);
+        if(y1<=y0) y1 = y0+1;
+
+        for(int x=0; x<dw; x++)
+        {
+            int x0 = (int)((long long)x*w/dw), x1 = (int)((long long)(x+1)*w/dw);
+            if(x1<=x0) x1 = x0+1;
+
+            for(int c=0; c<channels; c++)
+            {
+                unsigned int sum = 0;
+                for(int sy=y0; sy<y1; sy++)
+                    for(int sx=x0; sx<x1; sx++)
+                        sum += src[((size_t)sy*w+sx)*channels+c];
+                unsigned int n = (unsigned int)((x1-x0)*(y1-y0));
+                dst[((size_t)y*dw+x)*channels+c] = (unsigned char)((sum+n/2)/n);
+            }
+        }
+    }
+}
+
+static bool makeVariants(const char *fileName, const std::vector<float> &scales)
+{
+    int w, h, channels;
+    unsigned char *px = SOIL_load_image(fileName,&w,&h,&channels,SOIL_LOAD_AUTO);
+    if(!px)
+    {
+        printf("%s: can't load (%s)\n",fileName,SOIL_last_result());
+        return false;
+    }
+
+    char manifest[1024];
+    siblingName(fileName,".variants",manifest,sizeof(manifest));
+    FILE *fp = fopen(manifest,"w");
+    if(!fp)
+    {
+        printf("%s: can't write\n",manifest);
+        SOIL_free_image_data(px);
+        return false;
+    }
+    fprintf(fp,"# width height file, written by assetbake -variants\n");
+
+    bool ok = true;
+    for(float s : scales)
+    {
+        int dw = (int)(w*s+0.5f), dh = (int)(h*s+0.5f);
+        if(s<=0 || s>=1 || dw<1 || dh<1) continue;
+
+        std::vector<unsigned char> small((size_t)dw*dh*channels);
+        shrink(px,w,h,channels,&small[0],dw,dh);
+
+        char suffix[32], out[1024];
+        snprintf(suffix,sizeof(suffix),"_%dx%d.tga",dw,dh);
+        siblingName(fileName,suffix,out,sizeof(out));
+
+        // tga keeps it lossless and SOIL reads it back without any extra code
+        if(!SOIL_save_image(out,SOIL_SAVE_TYPE_TGA,dw,dh,channels,&small[0]))
+        {
+            printf("%s: can't write\n",out);
+            ok = false;
+            continue;
+        }
+        fprintf(fp,"%d %d %s\n",dw,dh,baseName(out));
+        printf("%s: %dx%d\n",out,dw,dh);
+    }
+    fprintf(fp,"%d %d %s\n",w,h,baseName(fileName));
+    fclose(fp);
+
+    SOIL_free_image_data(px);
+    printf("%s: written\n",manifest);
+    return ok;
+}
+
+static bool makeTiles(const char *fileName, int tile)
+{
+    int w, h, channels;
+    unsigned char *px = SOIL_load_image(fileName,&w,&h,&channels,SOIL_LOAD_AUTO);
+    if(!px)
+    {
+        printf("%s: can't load (%s)\n",fileName,SOIL_last_result());
+        return false;
+    }
+    std::vector<unsigned char> cur(px,px+(size_t)w*h*channels), next, out;
+    SOIL_free_image_data(px);
+
+    bool ok = true;
+    int lw = w, lh = h, levels = 0;
+    for(int l=0; ; l++)
+    {
+        // level sizes are the source's shifted down, the game works them out the same way
+        if(l)
+        {
+            int nw = w>>l, nh = h>>l;
+            if(nw<1) nw = 1;
+            if(nh<1) nh = 1;
+            next.resize((size_t)nw*nh*channels);
+            shrink(&cur[0],lw,lh,channels,&next[0],nw,nh);
+            cur.swap(next);
+            lw = nw;
+            lh = nh;
+        }
+
+        int cols = (lw+tile-1)/tile, rows = (lh+tile-1)/tile;
+        for(int r=0; r<rows; r++)
+            for(int c=0; c<cols; c++)
+            {
+                int x0 = c*tile, y0 = r*tile;
+                int ow = (lw-x0<tile? lw-x0 : tile)+2, oh = (lh-y0<tile? lh-y0 : tile)+2;
+                out.resize((size_t)ow*oh*channels);
+                for(int y=0; y<oh; y++)
+                {
+                    int sy = y0+y-1;
+                    if(sy<0) sy = 0;
+                    if(sy>=lh) sy = lh-1;
+                    for(int x=0; x<ow; x++)
+                    {
+                        int sx = (x0+x-1+lw)%lw;
+                        memcpy(&out[((size_t)y*ow+x)*channels],&cur[((size_t)sy*lw+sx)*channels],channels);
+                    }
+                }
+
+                char suffix[48], name[1024];
+                snprintf(suffix,sizeof(suffix),"_t%d_%d_%d.tga",l,c,r);
+                siblingName(fileName,suffix,name,sizeof(name));
+                if(!SOIL_save_image(name,SOIL_SAVE_TYPE_TGA,ow,oh,channels,&out[0]))
+                {
+                    printf("%s: can't write\n",name);
+                    ok = false;
+                }
+            }
+        printf("%s: level %d, %dx%d in %d tiles\n",fileName,l,lw,lh,cols*rows);
+
+        if(cols==1 && rows==1)
+        {
+            levels = l+1;
+            break;
+        }
+    }
+
+    char manifest[1024];
+    siblingName(fileName,".tiles",manifest,sizeof(manifest));
+    FILE *fp = fopen(manifest,"w");
+    if(!fp)
+    {
+        printf("%s: can't write\n",manifest);
+        return false;
+    }
+    fprintf(fp,"# width height tile levels, written by assetbake -tiles\n");
+    fprintf(fp,"%d %d %d %d\n",w,h,tile,levels);
+    fclose(fp);
+
+    printf("%s: written\n",manifest);
+    return ok;
+}
+
+static bool bake(const char *fileName, int forced, bool mips, int framesX, int framesY)
+{
+    int w, h, channels;
+    unsigned char *px = SOIL_load_image(fileName,&w,&h,&channels,SOIL_LOAD_RGBA);
+    if(!px)
+    {
+        printf("%s: can't load (%s)\n",fileName,SOIL_last_result());
+        return false;
+    }
+
+    int format = forced;
+    if(format==_dxt::NONE)
+    {
+        format = _dxt::BC1;
+        for(size_t i=0; i<(size_t)w*h; i++)
+            if(px[i*4+3]<255) { format = _dxt::BC3; break; }
+    }
+
+    _dxt::image img;
+    img.format = format;
+    img.width = w;
+    img.height = h;
+
+    // level 0 from the image, the rest from the chain
+    _mipChain chain(4,3,framesX,framesY);
+    if(mips) chain.build(px,w,h);
+
+    for(size_t i=0; i<=chain.levels.size(); i++)
+    {
+        int lw = i? chain.widths[i-1] : w;
+        int lh = i? chain.heights[i-1] : h;
+        const unsigned char *src = i? &chain.levels[i-1][0] : px;
+
+        _dxt::level lv = {lw, lh, img.data.size(), _dxt::levelSize(format,lw,lh)};
+        img.levels.push_back(lv);
+        img.data.resize(lv.offset+lv.size);
+
+        if(format==_dxt::BC1) _dxt::encodeBC1(src,lw,lh,&img.data[lv.offset]);
+        else _dxt::encodeBC3(src,lw,lh,&img.data[lv.offset]);
+    }
+
+    // how far off the blocks are, so a bad candidate shows up before it ships
+    std::vector<unsigned char> back((size_t)w*h*4);
+    _dxt::decode(img,0,&back[0]);
+    double err = 0;
+    for(size_t i=0; i<back.size(); i++)
+    {
+        int d = (int)back[i]-px[i];
+        err += d*d;
+    }
+    double rms = sqrt(err/back.size());
+
+    SOIL_free_image_data(px);
+
+    char out[1024];
+    siblingName(fileName,".dds",out,sizeof(out));
+    if(!_dxt::saveDDS(out,img))
+    {
+        printf("%s: can't write\n",out);
+        return false;
+    }
+
+    printf("%s: %dx%d %s, %d levels, %u KB, rms error %.2f\n",out,w,h,format==_dxt::BC1? "bc1" : "bc3",
+           (int)img.levels.size(),(unsigned)(img.data.size()/1024),rms);
+    return true;
+}
+
+struct packItem
+{
+    std::string file;
+    int requested;
+    bool mips;
+    int framesX, framesY; // 0 without a trim
+};
+
+static bool isImage(const char *fileName)
+{
+    static const char *exts[] = {".png", ".jpg", ".jpeg", ".tga", ".bmp", ".dds"};
+    const char *dot = strrchr(fileName,'.');
+    if(!dot) return false;
+    for(const char *e : exts)
+    {
+        size_t i = 0;
+        while(e[i] && dot[i] && tolower((unsigned char)dot[i])==e[i]) i++;
+        if(!e[i] && !dot[i]) return true;
+    }
+    return false;
+}
+
+// zeros up to the next PACK_ALIGN boundary, returns the aligned offset
+static uint64_t padTo(FILE *fp)
+{
+    static const unsigned char zeros[PACK_ALIGN] = {0};
+    long at = ftell(fp);
+    long pad = (PACK_ALIGN-at%PACK_ALIGN)%PACK_ALIGN;
+    if(pad) fwrite(zeros,1,(size_t)pad,fp);
+    return (uint64_t)(at+pad);
+}
+
+static bool packTexture(FILE *fp, const packItem &item, packEntry &e)
+{
+    decodedTexture dec;
+    packedTexture packed;
+    _textureLoader loader;
+    _spriteTrim trim(item.framesX? item.framesX : 1, item.framesY? item.framesY : 1);
+    bool ok = _textureLoader::decode(item.file.c_str(),dec) &&
+              loader.pack(dec,packed,item.framesX? &trim : nullptr,item.requested,item.mips);
+    fputs((packed.log.empty()? dec.log : packed.log).c_str(),stdout); // pack carries decode's lines on
+    if(!ok || packed.data.empty())
+    {
+        printf("%s: can't load\n",item.file.c_str());
+        return false;
+    }
+    if(packed.offsets.size()>PACK_LEVELS)
+    {
+        printf("%s: more than %d levels\n",item.file.c_str(),PACK_LEVELS);
+        return false;
+    }
+
+    e.kind = _assetPack::TEXTURE;
+    e.requested = item.requested;
+    e.mipmaps = item.mips;
+    e.framesX = item.framesX;
+    e.framesY = item.framesY;
+    e.format = packed.format;
+    e.width = packed.width;
+    e.height = packed.height;
+    e.levels = (int32_t)packed.offsets.size();
+    e.rgbaBytes = packed.rgbaBytes;
+    for(size_t i=0; i<packed.offsets.size(); i++)
+    {
+        e.levelOffset[i] = packed.offsets[i];
+        e.levelSize[i] = packed.sizes[i];
+        e.levelW[i] = packed.widths[i];
+        e.levelH[i] = packed.heights[i];
+    }
+
+    e.offset = padTo(fp);
+    e.size = packed.data.size();
+    fwrite(&packed.data[0],1,packed.data.size(),fp);
+
+    if(!packed.palette.empty())
+    {
+        e.paletteOffset = padTo(fp);
+        fwrite(&packed.palette[0],1,packed.palette.size(),fp);
+    }
+    if(item.framesX && !trim.rects.empty())
+    {
+        e.trimOffset = padTo(fp);
+        fwrite(&trim.rects[0],sizeof(trimRect),trim.rects.size(),fp);
+        e.fullArea = trim.fullArea;
+        e.trimmedArea = trim.trimmedArea;
+    }
+
+    printf("%s: %dx%d %s, %d levels, %u KB\n",item.file.c_str(),e.width,e.height,
+           _textureLoader::formatNames[e.format],e.levels,(unsigned)(e.size/1024));
+    return true;
+}
+
+static bool packRaw(FILE *fp, const packItem &item, packEntry &e)
+{
+    FILE *in = fopen(item.file.c_str(),"rb");
+    if(!in)
+    {
+        printf("%s: can't open\n",item.file.c_str());
+        return false;
+    }
+    std::vector<unsigned char> bytes;
+    unsigned char buf[4096];
+    size_t n;
+    while((n = fread(buf,1,sizeof(buf),in))>0) bytes.insert(bytes.end(),buf,buf+n);
+    fclose(in);
+
+    e.kind = _assetPack::RAW;
+    e.offset = padTo(fp);
+    e.size = bytes.size();
+    if(!bytes.empty()) fwrite(&bytes[0],1,bytes.size(),fp);
+
+    printf("%s: %u bytes\n",item.file.c_str(),(unsigned)e.size);
+    return true;
+}
+
+static bool writePack(const char *packName, const std::vector<packItem> &items)
+{
+    // keep baked .dds blocks, the game checks the driver for them when it opens the pack
+    _glCaps::paths[_glCaps::TEXTURES] = _glCaps::PATH_BPTC;
+
+    FILE *fp = fopen(packName,"wb");
+    if(!fp)
+    {
+        printf("%s: can't write\n",packName);
+        return false;
+    }
+
+    packHeader header;
+    memset(&header,0,sizeof(header));
+    fwrite(&header,sizeof(header),1,fp); // rewritten once the index is known
+
+    std::vector<packEntry> index;
+    bool ok = true;
+    for(const packItem &item : items)
+    {
+        packEntry e;
+        memset(&e,0,sizeof(e));
+        std::string name = _textureRegistry::normalize(item.file.c_str());
+        if(name.size()>=PACK_NAME)
+        {
+            printf("%s: name longer than %d characters\n",item.file.c_str(),PACK_NAME-1);
+            ok = false;
+            continue;
+        }
+        strcpy(e.name,name.c_str());
+
+        if(isImage(item.file.c_str())? packTexture(fp,item,e) : packRaw(fp,item,e)) index.push_back(e);
+        else ok = false;
+    }
+
+    header.magic = PACK_MAGIC;
+    header.version = PACK_VERSION;
+    header.count = (uint32_t)index.size();
+    header.indexOffset = padTo(fp);
+    if(!index.empty()) fwrite(&index[0],sizeof(packEntry),index.size(),fp);
+    long total = ftell(fp);
+    fseek(fp,0,SEEK_SET);
+    fwrite(&header,sizeof(header),1,fp);
+    fclose(fp);
+
+    printf("%s: %u assets, %ld KB\n",packName,header.count,total/1024);
+    return ok;
+}
+
+static int formatByName(const char *name)
+{
+    for(int f=0; f<_textureLoader::TEX_BC1; f++)
+        if(!strcmp(name,_textureLoader::formatNames[f])) return f;
+    printf("unknown format %s, using auto\n",name);
+    return _textureLoader::TEX_AUTO;
+}
+
+int main(int argc, char **argv)
+{
+    int forced = _dxt::NONE;
+    bool mips = false;
+    int framesX = 1, framesY = 1;
+    std::vector<float> scales;
+    int tile = 0;
+    int failed = 0, files = 0;
+    const char *packName = nullptr;
+    std::vector<packItem> packItems;
+    int requested = _textureLoader::TEX_AUTO;
+    bool framesSet = false;
+    bool fonts = false;
+
+    for(int i=1; i<argc; i++)
+    {
+        if(!strcmp(argv[i],"-bc1")) { forced = _dxt::BC1; continue; }
+        if(!strcmp(argv[i],"-bc3")) { forced = _dxt::BC3; continue; }
+        if(!strcmp(argv[i],"-mips")) { mips = true; continue; }
+        if(!strcmp(argv[i],"-variants") && i+1<argc)
+        {
+            scales.clear();
+            for(char *tok = strtok(argv[++i],","); tok; tok = strtok(nullptr,","))
+                scales.push_back((float)atof(tok));
+            continue;
+        }
+        if(!strcmp(argv[i],"-tiles") && i+1<argc)
+        {
+            tile = atoi(argv[++i]);
+            if(tile<1) tile = 0;
+            continue;
+        }
+        if(!strcmp(argv[i],"-frames") && i+1<argc)
+        {
+            if(sscanf(argv[++i],"%dx%d",&framesX,&framesY)!=2 || framesX<1 || framesY<1) framesX = framesY = 1;
+            framesSet = true;
+            continue;
+        }
+        if(!strcmp(argv[i],"-noframes")) { framesX = framesY = 1; framesSet = false; continue; }
+        if(!strcmp(argv[i],"-nomips")) { mips = false; continue; }
+        if(!strcmp(argv[i],"-format") && i+1<argc) { requested = formatByName(argv[++i]); continue; }
+        if(!strcmp(argv[i],"-pack") && i+1<argc) { packName = argv[++i]; continue; }
+        if(!strcmp(argv[i],"-font")) { fonts = true; continue; }
+
+        files++;
+        if(fonts)
+        {
+            // a current .fntb is left alone, a stale or missing one gets written
+            _fontTable table;
+            if(!table.load(argv[i]) || !table.count) { printf("%s: no glyphs\n",argv[i]); failed++; }
+            else printf("%s: %d glyphs, %s up to date\n",argv[i],table.count,_fontTable::binaryName(argv[i]).c_str());
+            continue;
+        }
+        if(packName)
+        {
+            packItem item = {argv[i], requested, mips, framesSet? framesX : 0, framesSet? framesY : 0};
+            packItems.push_back(item);
+            continue;
+        }
+        bool ok;
+        if(tile) ok = makeTiles(argv[i],tile);
+        else ok = scales.empty()? bake(argv[i],forced,mips,framesX,framesY) : makeVariants(argv[i],scales);
+        if(!ok) failed++;
+    }
+
+    if(!files)
+    {
+        printf("usage: assetbake [-bc1|-bc3] [-mips] [-frames CxR] image...\n");
+        printf("       assetbake -variants 0.25,0.5,0.75 image...\n");
+        printf("       assetbake -tiles 256 image...\n");
+        printf("       assetbake -pack out.pak [-format F] [-mips|-nomips] [-frames CxR|-noframes] file...\n");
+        printf("       assetbake -font font.fnt...\n");
+        return 1;
+    }
+    if(packName && !writePack(packName,packItems)) failed++;
+    return failed? 1 : 0;
+}
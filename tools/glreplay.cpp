@@ -0,0 +1,782 @@
+// glreplay - runs a gl trace without the game
+//
+//   glreplay trace.gltrace
+//
+// the game writes trace.gltrace when started with -gltrace, f12 starts and
+// stops the frames that go in it. objects are created the way the game made
+// them, the frames are drawn into an offscreen framebuffer the size of the
+// game's window, and each profiler pass is a call group. the table at the end
+// has calls, cpu submit time and gpu time per group averaged over the frames,
+// so a driver-side cost can be bisected on any machine without the game.
+
+#define GLTRACE_NO_MACROS
+#include <_glext.h>
+#include <_gltrace.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <map>
+#include <string>
+
+struct reader
+{
+    const unsigned char *p, *end;
+    bool ok;
+
+    template<class T> T get()
+    {
+        T v;
+        if((size_t)(end-p)<sizeof(T)) { ok = false; memset(&v,0,sizeof(T)); return v; }
+        memcpy(&v,p,sizeof(T));
+        p += sizeof(T);
+        return v;
+    }
+
+    void get(void *dst, size_t n)
+    {
+        if((size_t)(end-p)<n) { ok = false; memset(dst,0,n); return; }
+        memcpy(dst,p,n);
+        p += n;
+    }
+
+    // nullptr for an empty blob, which is how the trace writes a null pointer
+    const unsigned char *blob(unsigned int &n)
+    {
+        n = get<unsigned int>();
+        if((size_t)(end-p)<n) { ok = false; n = 0; return nullptr; }
+        const unsigned char *b = n? p : nullptr;
+        p += n;
+        return b;
+    }
+};
+
+struct groupStats
+{
+    std::string name;
+    long long calls;
+    double cpuMs, gpuMs;
+};
+
+// trace names -> replay names
+static std::map<GLuint, GLuint> textures, buffers, framebuffers, renderbuffers, lists;
+
+static GLuint mapName(std::map<GLuint, GLuint> &m, GLuint id)
+{
+    if(!id) return 0;
+    std::map<GLuint, GLuint>::iterator it = m.find(id);
+    return it==m.end()? 0 : it->second;
+}
+
+// replay side bindings, so object calls can put them back
+static GLuint curTexture = 0, curArrayBuffer = 0, curPack = 0, curUnpack = 0;
+static GLuint curFramebuffer = 0, curRenderbuffer = 0;
+static std::vector<GLuint> arrayBufferStack;
+static GLuint offscreen = 0;
+static std::vector<unsigned char> scratch[3];
+static std::vector<unsigned char> readback; // glReadPixels and glGetTexImage land here without a pack buffer
+
+static std::vector<groupStats> groups;
+static int group = 0;
+static bool inFrame = false;
+static double segStart = 0, frameStart = 0;
+static std::vector<GLuint> queryPool;
+static std::vector<std::pair<int, GLuint> > frameQueries;
+static int frames = 0;
+static double frameMs = 0;
+static long long draws = 0;
+
+static double nowMs()
+{
+    static LARGE_INTEGER freq = {};
+    if(!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    return t.QuadPart*1000.0/freq.QuadPart;
+}
+
+static GLuint *bufferBinding(GLenum target)
+{
+    if(target==GL_ARRAY_BUFFER) return &curArrayBuffer;
+    if(target==GL_PIXEL_PACK_BUFFER) return &curPack;
+    if(target==GL_PIXEL_UNPACK_BUFFER) return &curUnpack;
+    return nullptr;
+}
+
+static void bindBuffer(GLenum target, GLuint id)
+{
+    if(_glext::BindBuffer) _glext::BindBuffer(target,id);
+}
+
+static void restoreBuffer(GLenum target)
+{
+    GLuint *b = bufferBinding(target);
+    bindBuffer(target,b? *b : 0);
+}
+
+// framebuffer 0 of the game is the offscreen target here
+static GLuint mapFramebuffer(GLuint id)
+{
+    return id? mapName(framebuffers,id) : offscreen;
+}
+
+static void genNames(std::map<GLuint, GLuint> &m, const unsigned char *ids, unsigned int n, void (*gen)(GLsizei, GLuint *))
+{
+    for(unsigned int i=0; i+sizeof(GLuint)<=n; i+=sizeof(GLuint))
+    {
+        GLuint traced, made = 0;
+        memcpy(&traced,ids+i,sizeof(GLuint));
+        gen(1,&made);
+        m[traced] = made;
+    }
+}
+
+static void deleteNames(std::map<GLuint, GLuint> &m, const unsigned char *ids, unsigned int n, void (*del)(GLsizei, const GLuint *))
+{
+    for(unsigned int i=0; i+sizeof(GLuint)<=n; i+=sizeof(GLuint))
+    {
+        GLuint traced;
+        memcpy(&traced,ids+i,sizeof(GLuint));
+        std::map<GLuint, GLuint>::iterator it = m.find(traced);
+        if(it==m.end()) continue;
+        del(1,&it->second);
+        m.erase(it);
+    }
+}
+
+// plain functions for genNames/deleteNames, the extension ones are pointers with their own calling convention
+static void genTextures(GLsizei n, GLuint *ids) { glGenTextures(n,ids); }
+static void deleteTextures(GLsizei n, const GLuint *ids) { glDeleteTextures(n,ids); }
+static void genBuffers(GLsizei n, GLuint *ids) { if(_glext::GenBuffers) _glext::GenBuffers(n,ids); }
+static void deleteBuffers(GLsizei n, const GLuint *ids) { if(_glext::DeleteBuffers) _glext::DeleteBuffers(n,ids); }
+static void genFramebuffers(GLsizei n, GLuint *ids) { if(_glext::GenFramebuffers) _glext::GenFramebuffers(n,ids); }
+static void deleteFramebuffers(GLsizei n, const GLuint *ids) { if(_glext::DeleteFramebuffers) _glext::DeleteFramebuffers(n,ids); }
+static void genRenderbuffers(GLsizei n, GLuint *ids) { if(_glext::GenRenderbuffers) _glext::GenRenderbuffers(n,ids); }
+static void deleteRenderbuffers(GLsizei n, const GLuint *ids) { if(_glext::DeleteRenderbuffers) _glext::DeleteRenderbuffers(n,ids); }
+
+static bool createContext()
+{
+    WNDCLASS wc;
+    memset(&wc,0,sizeof(wc));
+    wc.style = CS_OWNDC;
+    wc.lpfnWndProc = DefWindowProc;
+    wc.hInstance = GetModuleHandle(NULL);
+    wc.lpszClassName = "glreplay";
+    RegisterClass(&wc);
+
+    // never shown, it only holds the context
+    HWND wnd = CreateWindowEx(0,"glreplay","glreplay",WS_OVERLAPPEDWINDOW,0,0,64,64,NULL,NULL,wc.hInstance,NULL);
+    if(!wnd) return false;
+    HDC dc = GetDC(wnd);
+
+    PIXELFORMATDESCRIPTOR pfd;
+    memset(&pfd,0,sizeof(pfd));
+    pfd.nSize = sizeof(pfd);
+    pfd.nVersion = 1;
+    pfd.dwFlags = PFD_DRAW_TO_WINDOW | PFD_SUPPORT_OPENGL | PFD_DOUBLEBUFFER;
+    pfd.iPixelType = PFD_TYPE_RGBA;
+    pfd.cColorBits = 32;
+    pfd.cDepthBits = 24;
+    pfd.cStencilBits = 8;
+    int pf = ChoosePixelFormat(dc,&pfd);
+    if(!pf || !SetPixelFormat(dc,pf,&pfd)) return false;
+
+    HGLRC rc = wglCreateContext(dc);
+    return rc && wglMakeCurrent(dc,rc);
+}
+
+static void makeOffscreen(int w, int h)
+{
+    if(!_glext::hasFBO)
+    {
+        printf("no framebuffer objects, drawing into the hidden window instead\n");
+        return;
+    }
+
+    GLuint rb[2];
+    _glext::GenFramebuffers(1,&offscreen);
+    _glext::GenRenderbuffers(2,rb);
+    _glext::BindFramebuffer(GL_FRAMEBUFFER_EXT,offscreen);
+
+    _glext::BindRenderbuffer(GL_RENDERBUFFER_EXT,rb[0]);
+    _glext::RenderbufferStorage(GL_RENDERBUFFER_EXT,GL_RGBA8,w,h);
+    _glext::FramebufferRenderbuffer(GL_FRAMEBUFFER_EXT,GL_COLOR_ATTACHMENT0_EXT,GL_RENDERBUFFER_EXT,rb[0]);
+
+    // the game's window has depth and stencil, packed if the driver can
+    _glext::BindRenderbuffer(GL_RENDERBUFFER_EXT,rb[1]);
+    _glext::RenderbufferStorage(GL_RENDERBUFFER_EXT,GL_DEPTH24_STENCIL8,w,h);
+    _glext::FramebufferRenderbuffer(GL_FRAMEBUFFER_EXT,GL_DEPTH_ATTACHMENT_EXT,GL_RENDERBUFFER_EXT,rb[1]);
+    _glext::FramebufferRenderbuffer(GL_FRAMEBUFFER_EXT,GL_STENCIL_ATTACHMENT_EXT,GL_RENDERBUFFER_EXT,rb[1]);
+    if(_glext::CheckFramebufferStatus(GL_FRAMEBUFFER_EXT)!=GL_FRAMEBUFFER_COMPLETE_EXT)
+    {
+        _glext::FramebufferRenderbuffer(GL_FRAMEBUFFER_EXT,GL_STENCIL_ATTACHMENT_EXT,GL_RENDERBUFFER_EXT,0);
+        _glext::RenderbufferStorage(GL_RENDERBUFFER_EXT,GL_DEPTH_COMPONENT24,w,h);
+        _glext::FramebufferRenderbuffer(GL_FRAMEBUFFER_EXT,GL_DEPTH_ATTACHMENT_EXT,GL_RENDERBUFFER_EXT,rb[1]);
+    }
+    _glext::BindRenderbuffer(GL_RENDERBUFFER_EXT,curRenderbuffer);
+    printf("offscreen target %dx%d\n",w,h);
+}
+
+// timing, one segment per group run, gpu time from an elapsed query per segment
+static void beginSegment(int g)
+{
+    group = g;
+    segStart = nowMs();
+    if(!_glext::hasTimeElapsed) return;
+
+    if(frameQueries.size()>=queryPool.size())
+    {
+        GLuint q;
+        _glext::GenQueries(1,&q);
+        queryPool.push_back(q);
+    }
+    GLuint q = queryPool[frameQueries.size()];
+    _glext::BeginQuery(GL_TIME_ELAPSED,q);
+    frameQueries.push_back(std::make_pair(g,q));
+}
+
+static void endSegment()
+{
+    groups[group].cpuMs += nowMs()-segStart;
+    if(_glext::hasTimeElapsed) _glext::EndQuery(GL_TIME_ELAPSED);
+}
+
+static void switchGroup(int g)
+{
+    if(!inFrame) return;
+    endSegment();
+    beginSegment(g);
+}
+
+static void beginFrame()
+{
+    inFrame = true;
+    frameQueries.clear();
+    frameStart = nowMs();
+    beginSegment(0);
+}
+
+static void endFrame()
+{
+    endSegment();
+    glFinish();
+    for(size_t i=0; i<frameQueries.size(); i++)
+    {
+        GLuint64 ns = 0;
+        _glext::GetQueryObjectui64v(frameQueries[i].second,GL_QUERY_RESULT,&ns);
+        groups[frameQueries[i].first].gpuMs += ns/1000000.0;
+    }
+    frameMs += nowMs()-frameStart;
+    frames++;
+}
+
+static void clientPointer(int kind, GLint size, GLenum type, GLsizei stride, const GLvoid *ptr)
+{
+    if(kind==0)      glVertexPointer(size,type,stride,ptr);
+    else if(kind==1) glTexCoordPointer(size,type,stride,ptr);
+    else             glColorPointer(size,type,stride,ptr);
+}
+
+static void frameState(reader &r)
+{
+    GLint viewport[4], mode, blend[2], depthFunc;
+    GLfloat projection[16], modelview[16], clearColor[4], color[4], light[4][4];
+    r.get(viewport,sizeof(viewport));
+    mode = r.get<GLint>();
+    r.get(projection,sizeof(projection));
+    r.get(modelview,sizeof(modelview));
+    r.get(clearColor,sizeof(clearColor));
+    r.get(color,sizeof(color));
+    r.get(blend,sizeof(blend));
+    depthFunc = r.get<GLint>();
+    GLboolean depthMask = r.get<GLboolean>();
+    r.get(light,sizeof(light));
+
+    if(!offscreen) makeOffscreen(viewport[0]+viewport[2],viewport[1]+viewport[3]);
+
+    int caps = r.get<unsigned char>();
+    for(int i=0; i<caps; i++)
+    {
+        GLenum cap = r.get<GLenum>();
+        if(r.get<GLboolean>()) glEnable(cap);
+        else                   glDisable(cap);
+    }
+
+    GLuint tex = r.get<GLuint>();
+    GLuint array = r.get<GLuint>();
+    curFramebuffer = r.get<GLuint>();
+    curTexture = mapName(textures,tex);
+    curArrayBuffer = mapName(buffers,array);
+    glBindTexture(GL_TEXTURE_2D,curTexture);
+    bindBuffer(GL_ARRAY_BUFFER,curArrayBuffer);
+    if(_glext::BindFramebuffer) _glext::BindFramebuffer(GL_FRAMEBUFFER_EXT,mapFramebuffer(curFramebuffer));
+
+    glViewport(viewport[0],viewport[1],viewport[2],viewport[3]);
+    glMatrixMode(GL_PROJECTION);
+    glLoadMatrixf(projection);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+    glLightfv(GL_LIGHT0,GL_AMBIENT,light[0]);
+    glLightfv(GL_LIGHT0,GL_DIFFUSE,light[1]);
+    glLightfv(GL_LIGHT0,GL_SPECULAR,light[2]);
+    glLightfv(GL_LIGHT0,GL_POSITION,light[3]); // already in eye space
+    glLoadMatrixf(modelview);
+    glMatrixMode(mode);
+    glClearColor(clearColor[0],clearColor[1],clearColor[2],clearColor[3]);
+    glColor4fv(color);
+    glBlendFunc(blend[0],blend[1]);
+    glDepthFunc(depthFunc);
+    glDepthMask(depthMask);
+
+    // a second f12 take starts a new frame, drop whatever was open
+    if(inFrame)
+    {
+        endSegment();
+        glFinish();
+    }
+    beginFrame();
+}
+
+static bool replay(reader &r, const unsigned char *start)
+{
+    static bool warned[_glTrace::OP_COUNT];
+
+    while(r.p<r.end && r.ok)
+    {
+        const unsigned char *at = r.p;
+        int op = r.get<unsigned char>();
+        unsigned int n;
+        const unsigned char *b;
+
+        if(inFrame && op>_glTrace::GROUP_END) groups[group].calls++;
+
+        switch(op)
+        {
+            case _glTrace::GEN_TEXTURES:    b = r.blob(n); genNames(textures,b,n,genTextures); break;
+            case _glTrace::DELETE_TEXTURES: b = r.blob(n); deleteNames(textures,b,n,deleteTextures); break;
+
+            case _glTrace::TEX_IMAGE_2D:
+            case _glTrace::TEX_SUB_IMAGE_2D:
+            {
+                GLuint tex = mapName(textures,r.get<GLuint>());
+                GLenum target = r.get<GLenum>();
+                GLint level = r.get<GLint>();
+                GLint internal = 0, x = 0, y = 0, border = 0;
+                if(op==_glTrace::TEX_IMAGE_2D) internal = r.get<GLint>();
+                else { x = r.get<GLint>(); y = r.get<GLint>(); }
+                GLsizei w = r.get<GLsizei>(), h = r.get<GLsizei>();
+                if(op==_glTrace::TEX_IMAGE_2D) border = r.get<GLint>();
+                GLenum format = r.get<GLenum>(), type = r.get<GLenum>();
+                GLuint unpack = mapName(buffers,r.get<GLuint>());
+                const GLvoid *pixels;
+                if(unpack)
+                {
+                    pixels = (const GLvoid*)(size_t)r.get<unsigned long long>();
+                    bindBuffer(GL_PIXEL_UNPACK_BUFFER,unpack);
+                }
+                else pixels = r.blob(n);
+
+                glBindTexture(target,tex);
+                if(op==_glTrace::TEX_IMAGE_2D) glTexImage2D(target,level,internal,w,h,border,format,type,pixels);
+                else                           glTexSubImage2D(target,level,x,y,w,h,format,type,pixels);
+                glBindTexture(target,curTexture);
+                if(unpack) restoreBuffer(GL_PIXEL_UNPACK_BUFFER);
+                break;
+            }
+
+            case _glTrace::TEX_PARAMETER_I:
+            {
+                GLuint tex = mapName(textures,r.get<GLuint>());
+                GLenum target = r.get<GLenum>(), pname = r.get<GLenum>();
+                GLint param = r.get<GLint>();
+                glBindTexture(target,tex);
+                glTexParameteri(target,pname,param);
+                glBindTexture(target,curTexture);
+                break;
+            }
+
+            case _glTrace::COMPRESSED_TEX_IMAGE_2D:
+            {
+                GLuint tex = mapName(textures,r.get<GLuint>());
+                GLenum target = r.get<GLenum>();
+                GLint level = r.get<GLint>();
+                GLenum internal = r.get<GLenum>();
+                GLsizei w = r.get<GLsizei>(), h = r.get<GLsizei>();
+                GLint border = r.get<GLint>();
+                b = r.blob(n);
+                if(!_glext::CompressedTexImage2D) break;
+                glBindTexture(target,tex);
+                _glext::CompressedTexImage2D(target,level,internal,w,h,border,n,b);
+                glBindTexture(target,curTexture);
+                break;
+            }
+
+            case _glTrace::COLOR_TABLE:
+            {
+                GLuint tex = mapName(textures,r.get<GLuint>());
+                GLenum target = r.get<GLenum>(), internal = r.get<GLenum>();
+                GLsizei width = r.get<GLsizei>();
+                GLenum format = r.get<GLenum>(), type = r.get<GLenum>();
+                b = r.blob(n);
+                if(!_glext::ColorTable)
+                {
+                    if(!warned[op]) printf("no paletted textures here, those stay blank\n");
+                    warned[op] = true;
+                    break;
+                }
+                glBindTexture(target,tex);
+                _glext::ColorTable(target,internal,width,format,type,b);
+                glBindTexture(target,curTexture);
+                break;
+            }
+
+            case _glTrace::PIXEL_STORE_I: { GLenum p = r.get<GLenum>(); glPixelStorei(p,r.get<GLint>()); break; }
+
+            case _glTrace::GEN_BUFFERS:    b = r.blob(n); genNames(buffers,b,n,genBuffers); break;
+            case _glTrace::DELETE_BUFFERS: b = r.blob(n); deleteNames(buffers,b,n,deleteBuffers); break;
+
+            case _glTrace::BUFFER_DATA:
+            case _glTrace::BUFFER_STORAGE:
+            {
+                GLuint id = mapName(buffers,r.get<GLuint>());
+                GLenum target = r.get<GLenum>();
+                GLsizeiptr size = (GLsizeiptr)r.get<unsigned long long>();
+                r.get<GLenum>(); // usage or storage flags
+                b = r.blob(n);
+                if(!_glext::BufferData) break;
+
+                // storage becomes a plain buffer, the replay fills it with glBufferSubData instead of a mapping
+                bindBuffer(target,id);
+                _glext::BufferData(target,size,b,op==_glTrace::BUFFER_STORAGE? GL_STREAM_DRAW : GL_STATIC_DRAW);
+                restoreBuffer(target);
+                break;
+            }
+
+            case _glTrace::BUFFER_SUB_DATA:
+            {
+                GLuint id = mapName(buffers,r.get<GLuint>());
+                GLenum target = r.get<GLenum>();
+                GLintptr offset = (GLintptr)r.get<unsigned long long>();
+                b = r.blob(n);
+                if(!_glext::BufferSubData || !n) break;
+                bindBuffer(target,id);
+                _glext::BufferSubData(target,offset,n,b);
+                restoreBuffer(target);
+                break;
+            }
+
+            case _glTrace::GEN_FRAMEBUFFERS:     b = r.blob(n); genNames(framebuffers,b,n,genFramebuffers); break;
+            case _glTrace::DELETE_FRAMEBUFFERS:  b = r.blob(n); deleteNames(framebuffers,b,n,deleteFramebuffers); break;
+            case _glTrace::GEN_RENDERBUFFERS:    b = r.blob(n); genNames(renderbuffers,b,n,genRenderbuffers); break;
+            case _glTrace::DELETE_RENDERBUFFERS: b = r.blob(n); deleteNames(renderbuffers,b,n,deleteRenderbuffers); break;
+
+            case _glTrace::FRAMEBUFFER_TEXTURE_2D:
+            {
+                GLuint fbo = mapName(framebuffers,r.get<GLuint>());
+                GLenum target = r.get<GLenum>(), attachment = r.get<GLenum>(), textarget = r.get<GLenum>();
+                GLuint tex = mapName(textures,r.get<GLuint>());
+                GLint level = r.get<GLint>();
+                if(!_glext::hasFBO) break;
+                _glext::BindFramebuffer(target,fbo);
+                _glext::FramebufferTexture2D(target,attachment,textarget,tex,level);
+                _glext::BindFramebuffer(target,mapFramebuffer(curFramebuffer));
+                break;
+            }
+
+            case _glTrace::RENDERBUFFER_STORAGE:
+            {
+                GLuint rb = mapName(renderbuffers,r.get<GLuint>());
+                GLenum target = r.get<GLenum>(), internal = r.get<GLenum>();
+                GLsizei w = r.get<GLsizei>(), h = r.get<GLsizei>();
+                if(!_glext::hasFBO) break;
+                _glext::BindRenderbuffer(target,rb);
+                _glext::RenderbufferStorage(target,internal,w,h);
+                _glext::BindRenderbuffer(target,curRenderbuffer);
+                break;
+            }
+
+            case _glTrace::FRAMEBUFFER_RENDERBUFFER:
+            {
+                GLuint fbo = mapName(framebuffers,r.get<GLuint>());
+                GLenum target = r.get<GLenum>(), attachment = r.get<GLenum>(), rbTarget = r.get<GLenum>();
+                GLuint rb = mapName(renderbuffers,r.get<GLuint>());
+                if(!_glext::hasFBO) break;
+                _glext::BindFramebuffer(target,fbo);
+                _glext::FramebufferRenderbuffer(target,attachment,rbTarget,rb);
+                _glext::BindFramebuffer(target,mapFramebuffer(curFramebuffer));
+                break;
+            }
+
+            case _glTrace::GEN_LISTS:
+            {
+                GLsizei range = r.get<GLsizei>();
+                GLuint base = r.get<GLuint>(), made = glGenLists(range);
+                for(GLsizei i=0; i<range; i++) lists[base+i] = made+i;
+                break;
+            }
+
+            case _glTrace::DELETE_LISTS:
+            {
+                GLuint list = r.get<GLuint>();
+                GLsizei range = r.get<GLsizei>();
+                for(GLsizei i=0; i<range; i++)
+                {
+                    GLuint id = mapName(lists,list+i);
+                    if(id) glDeleteLists(id,1);
+                    lists.erase(list+i);
+                }
+                break;
+            }
+
+            case _glTrace::NEW_LIST: { GLuint list = mapName(lists,r.get<GLuint>()); glNewList(list,r.get<GLenum>()); break; }
+            case _glTrace::END_LIST: glEndList(); break;
+
+            case _glTrace::FRAME_STATE: frameState(r); break;
+            case _glTrace::FRAME_END:
+                if(!inFrame) break;
+                endFrame();
+                beginFrame(); // closed again by the next frame end, dropped if the take stops here
+                break;
+
+            case _glTrace::GROUP_BEGIN:
+            {
+                b = r.blob(n);
+                std::string name((const char*)b,n);
+                int g = 0;
+                while(g<(int)groups.size() && groups[g].name!=name) g++;
+                if(g==(int)groups.size())
+                {
+                    groupStats s = {name,0,0,0};
+                    groups.push_back(s);
+                }
+                switchGroup(g);
+                break;
+            }
+            case _glTrace::GROUP_END: switchGroup(0); break;
+
+            case _glTrace::ENABLE:  glEnable(r.get<GLenum>()); break;
+            case _glTrace::DISABLE: glDisable(r.get<GLenum>()); break;
+            case _glTrace::BLEND_FUNC: { GLenum s = r.get<GLenum>(); glBlendFunc(s,r.get<GLenum>()); break; }
+            case _glTrace::DEPTH_FUNC: glDepthFunc(r.get<GLenum>()); break;
+            case _glTrace::DEPTH_MASK: glDepthMask(r.get<GLboolean>()); break;
+            case _glTrace::STENCIL_FUNC: { GLenum f = r.get<GLenum>(); GLint ref = r.get<GLint>(); glStencilFunc(f,ref,r.get<GLuint>()); break; }
+            case _glTrace::STENCIL_OP: { GLenum f = r.get<GLenum>(), z = r.get<GLenum>(); glStencilOp(f,z,r.get<GLenum>()); break; }
+            case _glTrace::CLEAR: glClear(r.get<GLbitfield>()); break;
+            case _glTrace::CLEAR_COLOR: { GLfloat c[4]; r.get(c,sizeof(c)); glClearColor(c[0],c[1],c[2],c[3]); break; }
+            case _glTrace::CLEAR_DEPTH: glClearDepth(r.get<GLclampd>()); break;
+            case _glTrace::CLEAR_STENCIL: glClearStencil(r.get<GLint>()); break;
+            case _glTrace::VIEWPORT: { GLint v[4]; r.get(v,sizeof(v)); glViewport(v[0],v[1],v[2],v[3]); break; }
+
+            case _glTrace::MATRIX_MODE: glMatrixMode(r.get<GLenum>()); break;
+            case _glTrace::LOAD_IDENTITY: glLoadIdentity(); break;
+            case _glTrace::PUSH_MATRIX: glPushMatrix(); break;
+            case _glTrace::POP_MATRIX: glPopMatrix(); break;
+            case _glTrace::TRANSLATE_F: { GLfloat v[3]; r.get(v,sizeof(v)); glTranslatef(v[0],v[1],v[2]); break; }
+            case _glTrace::ROTATE_F: { GLfloat v[4]; r.get(v,sizeof(v)); glRotatef(v[0],v[1],v[2],v[3]); break; }
+            case _glTrace::SCALE_F: { GLfloat v[3]; r.get(v,sizeof(v)); glScalef(v[0],v[1],v[2]); break; }
+            case _glTrace::MULT_MATRIX_F: { GLfloat m[16]; r.get(m,sizeof(m)); glMultMatrixf(m); break; }
+            case _glTrace::PERSPECTIVE: { GLdouble v[4]; r.get(v,sizeof(v)); gluPerspective(v[0],v[1],v[2],v[3]); break; }
+            case _glTrace::ORTHO_2D: { GLdouble v[4]; r.get(v,sizeof(v)); gluOrtho2D(v[0],v[1],v[2],v[3]); break; }
+
+            case _glTrace::PUSH_ATTRIB: glPushAttrib(r.get<GLbitfield>()); break;
+            case _glTrace::POP_ATTRIB: glPopAttrib(); break;
+            case _glTrace::PUSH_CLIENT_ATTRIB:
+                arrayBufferStack.push_back(curArrayBuffer);
+                glPushClientAttrib(r.get<GLbitfield>());
+                break;
+            case _glTrace::POP_CLIENT_ATTRIB:
+                if(!arrayBufferStack.empty()) { curArrayBuffer = arrayBufferStack.back(); arrayBufferStack.pop_back(); }
+                glPopClientAttrib();
+                break;
+
+            case _glTrace::MATERIAL_FV:
+            case _glTrace::LIGHT_FV:
+            {
+                GLenum which = r.get<GLenum>(), pname = r.get<GLenum>();
+                GLfloat v[4] = {0,0,0,0};
+                b = r.blob(n);
+                if(b) memcpy(v,b,n<sizeof(v)? n : sizeof(v));
+                if(op==_glTrace::MATERIAL_FV) glMaterialfv(which,pname,v);
+                else                          glLightfv(which,pname,v);
+                break;
+            }
+
+            case _glTrace::BIND_TEXTURE:
+            {
+                GLenum target = r.get<GLenum>();
+                GLuint tex = mapName(textures,r.get<GLuint>());
+                if(target==GL_TEXTURE_2D) curTexture = tex;
+                glBindTexture(target,tex);
+                break;
+            }
+
+            case _glTrace::BIND_BUFFER:
+            {
+                GLenum target = r.get<GLenum>();
+                GLuint id = mapName(buffers,r.get<GLuint>());
+                GLuint *bound = bufferBinding(target);
+                if(bound) *bound = id;
+                bindBuffer(target,id);
+                break;
+            }
+
+            case _glTrace::BIND_FRAMEBUFFER:
+            {
+                GLenum target = r.get<GLenum>();
+                curFramebuffer = r.get<GLuint>();
+                if(_glext::BindFramebuffer) _glext::BindFramebuffer(target,mapFramebuffer(curFramebuffer));
+                break;
+            }
+
+            case _glTrace::BIND_RENDERBUFFER:
+            {
+                GLenum target = r.get<GLenum>();
+                curRenderbuffer = mapName(renderbuffers,r.get<GLuint>());
+                if(_glext::BindRenderbuffer) _glext::BindRenderbuffer(target,curRenderbuffer);
+                break;
+            }
+
+            case _glTrace::ENABLE_CLIENT_STATE: glEnableClientState(r.get<GLenum>()); break;
+
+            case _glTrace::VERTEX_POINTER:
+            case _glTrace::TEX_COORD_POINTER:
+            case _glTrace::COLOR_POINTER:
+            {
+                GLint size = r.get<GLint>();
+                GLenum type = r.get<GLenum>();
+                GLsizei stride = r.get<GLsizei>();
+                GLuint buffer = r.get<GLuint>();
+                unsigned long long offset = r.get<unsigned long long>();
+                // client memory pointers arrive with the draw as CLIENT_ARRAY
+                if(buffer) clientPointer(op-_glTrace::VERTEX_POINTER,size,type,stride,(const GLvoid*)(size_t)offset);
+                break;
+            }
+
+            case _glTrace::CLIENT_ARRAY:
+            {
+                int kind = r.get<unsigned char>();
+                GLint size = r.get<GLint>();
+                GLenum type = r.get<GLenum>();
+                GLsizei stride = r.get<GLsizei>();
+                b = r.blob(n);
+                if(kind>2 || !b) break;
+                scratch[kind].assign(b,b+n);
+                bindBuffer(GL_ARRAY_BUFFER,0);
+                clientPointer(kind,size,type,stride,&scratch[kind][0]);
+                bindBuffer(GL_ARRAY_BUFFER,curArrayBuffer);
+                break;
+            }
+
+            case _glTrace::DRAW_ARRAYS:
+            {
+                GLenum mode = r.get<GLenum>();
+                GLint first = r.get<GLint>();
+                GLsizei count = r.get<GLsizei>();
+                glDrawArrays(mode,first,count);
+                draws++;
+                break;
+            }
+
+            case _glTrace::CALL_LIST: glCallList(mapName(lists,r.get<GLuint>())); draws++; break;
+            case _glTrace::BEGIN: glBegin(r.get<GLenum>()); draws++; break;
+            case _glTrace::END: glEnd(); break;
+            case _glTrace::VERTEX_2F: { GLfloat v[2]; r.get(v,sizeof(v)); glVertex2f(v[0],v[1]); break; }
+            case _glTrace::VERTEX_3F: { GLfloat v[3]; r.get(v,sizeof(v)); glVertex3f(v[0],v[1],v[2]); break; }
+            case _glTrace::TEX_COORD_2F: { GLfloat v[2]; r.get(v,sizeof(v)); glTexCoord2f(v[0],v[1]); break; }
+            case _glTrace::COLOR_3F: { GLfloat v[3]; r.get(v,sizeof(v)); glColor3f(v[0],v[1],v[2]); break; }
+            case _glTrace::COLOR_4F: { GLfloat v[4]; r.get(v,sizeof(v)); glColor4f(v[0],v[1],v[2],v[3]); break; }
+
+            case _glTrace::SCISSOR: { GLint v[4]; r.get(v,sizeof(v)); glScissor(v[0],v[1],v[2],v[3]); break; }
+            case _glTrace::READ_PIXELS:
+            {
+                GLint v[4];
+                r.get(v,sizeof(v));
+                GLenum format = r.get<GLenum>(), type = r.get<GLenum>();
+                unsigned long long offset = r.get<unsigned long long>();
+                if(curPack) { glReadPixels(v[0],v[1],v[2],v[3],format,type,(GLvoid*)(uintptr_t)offset); break; }
+
+                // room for four floats a pixel whatever was asked for, and for any pack alignment
+                readback.resize((size_t)(v[2]>0? v[2] : 0)*(v[3]>0? v[3] : 0)*16+16);
+                glReadPixels(v[0],v[1],v[2],v[3],format,type,&readback[0]);
+                break;
+            }
+            case _glTrace::GET_TEX_IMAGE:
+            {
+                GLenum target = r.get<GLenum>();
+                GLint level = r.get<GLint>();
+                GLenum format = r.get<GLenum>(), type = r.get<GLenum>();
+                GLint w = 0, h = 0;
+                glGetTexLevelParameteriv(target,level,GL_TEXTURE_WIDTH,&w);
+                glGetTexLevelParameteriv(target,level,GL_TEXTURE_HEIGHT,&h);
+                if(w<=0 || h<=0) break;
+                readback.resize((size_t)w*h*16+16);
+                glGetTexImage(target,level,format,type,&readback[0]);
+                break;
+            }
+            case _glTrace::FINISH: glFinish(); break;
+
+            default:
+                printf("unknown op %d at byte %ld, stopping\n",op,(long)(at-start));
+                return false;
+        }
+    }
+
+    if(!r.ok) printf("trace ends in the middle of a call, it was probably cut off\n");
+    if(inFrame) endSegment(); // the frame after the last frame end never finished
+    return r.ok;
+}
+
+int main(int argc, char **argv)
+{
+    if(argc<2)
+    {
+        printf("usage: glreplay trace.gltrace\n");
+        return 1;
+    }
+
+    FILE *fp = fopen(argv[1],"rb");
+    if(!fp)
+    {
+        printf("%s: can't open\n",argv[1]);
+        return 1;
+    }
+    std::vector<unsigned char> data;
+    unsigned char chunk[65536];
+    for(size_t got; (got = fread(chunk,1,sizeof(chunk),fp))>0; ) data.insert(data.end(),chunk,chunk+got);
+    fclose(fp);
+
+    reader r = {data.empty()? nullptr : &data[0], data.empty()? nullptr : &data[0]+data.size(), true};
+    unsigned int magic = r.get<unsigned int>(), version = r.get<unsigned int>();
+    if(magic!=GLTRACE_MAGIC || version<1 || version>GLTRACE_VERSION)
+    {
+        printf("%s: not a version 1 to %d gl trace\n",argv[1],GLTRACE_VERSION);
+        return 1;
+    }
+
+    if(!createContext() || !_glext::init())
+    {
+        printf("can't create a gl context\n");
+        return 1;
+    }
+    printf("%s, %s\n",(const char*)glGetString(GL_RENDERER),(const char*)glGetString(GL_VERSION));
+
+    groupStats other = {"(outside passes)",0,0,0};
+    groups.push_back(other);
+
+    double start = nowMs();
+    bool ok = replay(r,&data[0]);
+    printf("%s: %u KB, replayed in %.0f ms\n",argv[1],(unsigned)(data.size()/1024),nowMs()-start);
+
+    if(!frames)
+    {
+        printf("no frames in the trace, press f12 in game to record some\n");
+        return ok? 0 : 1;
+    }
+
+    double f = frames;
+    printf("%d frames, %.3f ms per frame, %.1f draws per frame%s\n",frames,frameMs/f,draws/f,
+           _glext::hasTimeElapsed? "" : ", no timer queries so gpu time is 0");
+    printf("%-20s %12s %10s %10s\n","group","calls/frame","cpu ms","gpu ms");
+    for(const groupStats &g : groups)
+        printf("%-20s %12.1f %10.3f %10.3f\n",g.name.c_str(),g.calls/f,g.cpuMs/f,g.gpuMs/f);
+    return ok? 0 : 1;
+}
@@ -0,0 +1,197 @@
+// softbench - the cpu renderer without the game
+//
+//   softbench [-size WxH] [-frames N] [-threads N] [-out soft.tga]
+//
+// draws a fixed scene (a tiled background, alpha blended sprites, additive
+// particles and a block of hud glyphs, all from the same seed) through
+// _softRaster::drawQuads into a buffer, with no window and no gl context. the
+// frames are drawn on one thread and then on -threads threads (one per core
+// without it); the table has the best and average frame time of each with the
+// speedup, and a checksum of the image. the checksums have to match, the
+// output doesn't depend on the thread count, so a mismatch exits with 1.
+// -out writes the last frame as a tga.
+//
+// nothing in it needs GL or windows, a build host without a gpu builds it with
+//   g++ -O2 -std=c++11 -pthread -Iinclude tools/softbench.cpp src/_softraster.cpp -o softbench
+
+#include <_softraster.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+#define SPRITES 600
+#define PARTICLES 400
+#define GLYPHS 240
+
+// same numbers every run
+struct lcg
+{
+    unsigned int state;
+    float next() { state = state*1664525u+1013904223u; return (state>>8)*(1.0f/16777216.0f); }
+};
+
+static void makeTextures(softTexture &stone, softTexture &disc)
+{
+    stone.width = stone.height = 256;
+    stone.clamp = false;
+    stone.texels.resize(256*256);
+    for(int y=0; y<256; y++)
+        for(int x=0; x<256; x++)
+        {
+            unsigned int c = ((x>>5)^(y>>5))&1? 0x50 : 0x30;
+            c += (x*7+y*13)&0x0F;
+            stone.texels[y*256+x] = 0xFF000000 | c<<16 | c<<8 | c; // bgra
+        }
+
+    // white with a soft round alpha edge, like the particle and sprite sheets
+    disc.width = disc.height = 64;
+    disc.clamp = true;
+    disc.texels.resize(64*64);
+    for(int y=0; y<64; y++)
+        for(int x=0; x<64; x++)
+        {
+            float dx = (x+0.5f)/32.0f-1.0f, dy = (y+0.5f)/32.0f-1.0f;
+            float a = 1.0f-sqrtf(dx*dx+dy*dy);
+            unsigned int alpha = a<=0? 0 : (a>=0.25f? 255 : (unsigned int)(a*4.0f*255.0f));
+            disc.texels[y*64+x] = alpha<<24 | 0x00FFFFFF;
+        }
+}
+
+static void quad(streamColorVertex *v, float cx, float cy, float half, float angle, float u1, float v1,
+                 float r, float g, float b, float a)
+{
+    float c = cosf(angle)*half, s = sinf(angle)*half;
+    const float corner[4][2] = {{-1,-1},{1,-1},{1,1},{-1,1}};
+    for(int k=0; k<4; k++)
+    {
+        v[k].x = cx+corner[k][0]*c-corner[k][1]*s;
+        v[k].y = cy+corner[k][0]*s+corner[k][1]*c;
+        v[k].z = 0;
+        v[k].u = corner[k][0]>0? u1 : 0;
+        v[k].v = corner[k][1]>0? v1 : 0;
+        v[k].r = r; v[k].g = g; v[k].b = b; v[k].a = a;
+    }
+}
+
+static void drawScene(_softRaster &soft, int w, int h, const softTexture &stone, const softTexture &disc)
+{
+    // glOrtho(0,w,0,h,-1,1)
+    float m[16] = {2.0f/w,0,0,0, 0,2.0f/h,0,0, 0,0,-1,0, -1,-1,0,1};
+    float white[4] = {1,1,1,1};
+    lcg rng = {12345};
+
+    streamVertex bg[4];
+    streamPut(&bg[0],0,0,0,0,0);
+    streamPut(&bg[1],w,0,0,w/256.0f,0);
+    streamPut(&bg[2],w,h,0,w/256.0f,h/256.0f);
+    streamPut(&bg[3],0,h,0,0,h/256.0f);
+    soft.drawQuads(bg,sizeof(streamVertex),4,m,white,&stone,_softRaster::BLEND_NONE);
+
+    static streamColorVertex v[(SPRITES+PARTICLES+GLYPHS)*4];
+    streamColorVertex *p = v;
+    for(int i=0; i<SPRITES; i++, p+=4)
+        quad(p,rng.next()*w,rng.next()*h,16+rng.next()*32,rng.next()*6.283f,1,1,1,1,1,1);
+    soft.drawQuads(v,sizeof(streamColorVertex),SPRITES*4,m,white,&disc,_softRaster::BLEND_ALPHA);
+
+    streamColorVertex *particles = p;
+    for(int i=0; i<PARTICLES; i++, p+=4)
+        quad(p,w*0.5f+(rng.next()-0.5f)*w*0.4f,h*0.5f+(rng.next()-0.5f)*h*0.4f,4+rng.next()*12,0,1,1,1.0f,0.6f,0.2f,rng.next());
+    soft.drawQuads(particles,sizeof(streamColorVertex),PARTICLES*4,m,white,&disc,_softRaster::BLEND_ADD);
+
+    // untextured glyph sized boxes along the top, like the hud text
+    streamColorVertex *glyphs = p;
+    for(int i=0; i<GLYPHS; i++, p+=4)
+        quad(p,12+(i%60)*14.0f,h-14-(i/60)*18.0f,6,0,0,0,0.9f,0.9f,0.3f,0.8f);
+    soft.drawQuads(glyphs,sizeof(streamColorVertex),GLYPHS*4,m,white,nullptr,_softRaster::BLEND_ALPHA);
+}
+
+static unsigned int checksum(const std::vector<unsigned int> &pixels)
+{
+    unsigned int h = 2166136261u; // fnv-1a
+    const unsigned char *b = (const unsigned char*)&pixels[0];
+    for(size_t i=0; i<pixels.size()*4; i++) h = (h^b[i])*16777619u;
+    return h;
+}
+
+static bool writeTGA(const char *fileName, int w, int h, const unsigned char *bgra)
+{
+    unsigned char header[18] = {0};
+    header[2] = 2;
+    header[12] = w & 0xFF; header[13] = (w>>8) & 0xFF;
+    header[14] = h & 0xFF; header[15] = (h>>8) & 0xFF;
+    header[16] = 32;
+
+    FILE *f = fopen(fileName,"wb");
+    if(!f) return false;
+    bool ok = fwrite(header,1,sizeof(header),f)==sizeof(header)
+           && fwrite(bgra,4,(size_t)w*h,f)==(size_t)w*h;
+    fclose(f);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    int w = 1280, h = 720, frames = 50, threads = 0;
+    const char *outName = nullptr;
+
+    for(int i=1; i<argc; i++)
+    {
+        if(!strcmp(argv[i],"-size") && i+1<argc && sscanf(argv[++i],"%dx%d",&w,&h)==2 && w>0 && h>0) continue;
+        if(!strcmp(argv[i],"-frames") && i+1<argc) { frames = atoi(argv[++i]); continue; }
+        if(!strcmp(argv[i],"-threads") && i+1<argc) { threads = atoi(argv[++i]); continue; }
+        if(!strcmp(argv[i],"-out") && i+1<argc) { outName = argv[++i]; continue; }
+
+        printf("usage: softbench [-size WxH] [-frames N] [-threads N] [-out soft.tga]\n");
+        return 1;
+    }
+    if(frames<1) frames = 1;
+    if(threads<1) threads = (int)std::thread::hardware_concurrency(); // one per core, as the game picks
+    if(threads<1) threads = 1;
+
+    softTexture stone, disc;
+    makeTextures(stone,disc);
+
+    int counts[2] = {1, threads};
+    unsigned int sums[2] = {0, 0};
+    double best[2] = {0, 0};
+    printf("%dx%d, %d quads a frame, %d frames\n",w,h,1+SPRITES+PARTICLES+GLYPHS,frames);
+    printf("threads   best ms    avg ms   bin ms  speedup  overdraw  checksum\n");
+
+    for(int run=0; run<2; run++)
+    {
+        if(run==1 && threads==1) { sums[1] = sums[0]; best[1] = best[0]; break; }
+
+        _softRaster soft(counts[run]);
+        double total = 0, bin = 0;
+        best[run] = 1e30;
+        for(int f=0; f<=frames; f++) // frame 0 warms the caches and sizes the bins
+        {
+            double start = _softRaster::nowMs();
+            soft.begin(w,h,0.1f,0.1f,0.15f);
+            drawScene(soft,w,h,stone,disc);
+            soft.finish();
+            double ms = _softRaster::nowMs()-start;
+            if(!f) continue;
+
+            total += ms;
+            bin += soft.binMs;
+            if(ms<best[run]) best[run] = ms;
+        }
+        sums[run] = checksum(soft.color);
+
+        printf("%7d %9.2f %9.2f %8.2f %7.2fx %9.2f  %08x\n",counts[run],best[run],total/frames,bin/frames,
+               best[0]/best[run],soft.avgOverdraw,sums[run]);
+
+        if(outName && (run==1 || threads==1) && !writeTGA(outName,w,h,(const unsigned char*)&soft.color[0]))
+            printf("%s: can't write it\n",outName);
+    }
+
+    if(sums[0]!=sums[1])
+    {
+        printf("checksums differ, the output depends on the thread count\n");
+        return 1;
+    }
+    return 0;
+}